@@ -0,0 +1,86 @@
+/*============================================================================*/
+/* Liczba alokacji na jedno wstawienie: PriorityQueue (z domyślnym alokatorem */
+/* i z PoolAllocator) kontra poprzedni układ na map<shared_ptr<K>, ...>.      */
+/*                                                                            */
+/*    g++ -O2 -std=c++11 -I.. allocations.cc -o allocations                   */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <set>
+
+#include "../priorityqueue.hh"
+#include "../poolallocator.hh"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+   ++allocations;
+   if (void* p = std::malloc(size))
+      return p;
+   throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+   std::free(p);
+}
+
+// Wstawianie w układzie sprzed zmiany (dwa make_shared i cztery drzewa).
+template<typename K, typename V>
+class LegacyQueue {
+
+public:
+
+   void insert(const K& key, const V& value) {
+      std::shared_ptr<K> k = std::make_shared<K>(key);
+      std::shared_ptr<V> v = std::make_shared<V>(value);
+      map_key[k].insert(v);
+      map_value[v].insert(k);
+   }
+
+private:
+
+   template<typename T>
+   struct LessPtr {
+      bool operator() (const T& lhs, const T& rhs) const {
+         return *lhs < *rhs;
+      }
+   };
+
+   using ptr_key_t = std::shared_ptr<K>;
+   using ptr_value_t = std::shared_ptr<V>;
+   using set_key_t = std::multiset<ptr_key_t, LessPtr<ptr_key_t>>;
+   using set_value_t = std::multiset<ptr_value_t, LessPtr<ptr_value_t>>;
+
+   std::map<ptr_key_t, set_value_t, LessPtr<ptr_key_t>> map_key;
+   std::map<ptr_value_t, set_key_t, LessPtr<ptr_value_t>> map_value;
+};
+
+template<typename Queue>
+void run(const char* name, int n) {
+   Queue q;
+   size_t before = allocations;
+   auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < n; ++i)
+      q.insert(static_cast<int>((i * 2654435761u) % n), i % 1000);
+   auto stop = std::chrono::steady_clock::now();
+   double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+   std::printf("%-14s n=%-8d allocs/insert=%.2f ns/insert=%.1f\n", name, n,
+               double(allocations - before) / n, ns / n);
+}
+
+int main(int argc, char** argv) {
+   int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+   run<LegacyQueue<int, int>>("legacy", n);
+   run<PriorityQueue<int, int>>("PriorityQueue", n);
+   run<PriorityQueue<int, int, PoolAllocator<int>>>("PoolAllocator", n);
+   return 0;
+}
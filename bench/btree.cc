@@ -0,0 +1,93 @@
+/*============================================================================*/
+/* Porównanie BTreeBackend z domyślną strategią (drzewa AVL na węzłach        */
+/* intruzyjnych) dla 10^6 i więcej par int, gdy kolejka nie mieści się        */
+/* w pamięci podręcznej: losowe wstawianie, changeValue, contains, deleteMin  */
+/* do opróżnienia, extractMin po 1000 par i kopiowanie. Wynik w ns na         */
+/* element.                                                                   */
+/*                                                                            */
+/*    g++ -O2 -DNDEBUG -std=c++17 -I.. btree.cc -o btree                      */
+/*    ./btree [maksymalny rozmiar, domyślnie 10000000]                        */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../btreequeue.hh"
+
+using clock_type = std::chrono::steady_clock;
+
+static volatile size_t sink;
+
+template<typename Fn>
+double measure(size_t n, Fn fn) {
+   auto start = clock_type::now();
+   fn();
+   std::chrono::duration<double, std::nano> time = clock_type::now() - start;
+   return time.count() / double(n);
+}
+
+template<typename Q>
+void run(const char* name, size_t n) {
+   std::mt19937 rng(n);
+   std::vector<std::pair<int, int>> pairs, changes;
+   pairs.reserve(n);
+   changes.reserve(n);
+   for (size_t i = 0; i < n; ++i)
+      pairs.emplace_back(static_cast<int>(rng() % n), static_cast<int>(rng()));
+   for (size_t i = 0; i < n; ++i)
+      changes.emplace_back(pairs[rng() % n].first, static_cast<int>(rng()));
+
+   Q q;
+   double insert = measure(n, [&] {
+      for (auto& p : pairs)
+         q.insert(p.first, p.second);
+   });
+   double change = measure(n, [&] {
+      for (auto& c : changes)
+         q.changeValue(c.first, c.second);
+   });
+   double contains = measure(n, [&] {
+      size_t found = 0;
+      for (auto& c : changes)
+         found += q.contains(c.first + 1);
+      sink = found;
+   });
+   double copy = measure(n, [&] {
+      Q c(q);
+      sink = c.size();
+   });
+   double extract = measure(n, [&] {
+      Q c(q);
+      std::vector<std::pair<int, int>> out;
+      out.reserve(1000);
+      while (!c.empty()) {
+         out.clear();
+         c.extractMin(1000, std::back_inserter(out));
+      }
+      sink = out.size();
+   }) - copy;
+   double deletion = measure(n, [&] {
+      while (!q.empty())
+         q.deleteMin();
+   });
+   std::printf("%-14s %10zu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name, n,
+               insert, change, contains, deletion, extract, copy);
+}
+
+int main(int argc, char** argv) {
+   size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                              : 10000000;
+   std::printf("%-14s %10s %9s %9s %9s %9s %9s %9s\n", "structure", "size",
+               "insert", "change", "contains", "deleteMin", "extract", "copy");
+   for (size_t n = 1000000; n <= max_size; n *= 10) {
+      run<PriorityQueue<int, int>>("PriorityQueue", n);
+      run<PriorityQueue<int, int, std::allocator<std::pair<const int, int>>,
+                        BTreeBackend>>("BTreeBackend", n);
+   }
+   return 0;
+}
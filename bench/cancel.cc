@@ -0,0 +1,75 @@
+/*============================================================================*/
+/* Burza anulowań: do kolejki trafia N zadań (klucz - numer zadania,          */
+/* wartość - priorytet), po czym losowo wybrana część z nich jest anulowana   */
+/* przez erase (uchwyt) albo eraseKey, a pozostałe są pobierane popMin.       */
+/* Porównanie usuwania od razu z trybem leniwym (setLazyErase). Wynik to      */
+/* czas w ns na anulowanie i na pobranie.                                     */
+/*                                                                            */
+/*    g++ -O2 -DNDEBUG -std=c++17 -I.. cancel.cc -o cancel                    */
+/*    ./cancel [liczba zadań, domyślnie 1000000]                              */
+/*============================================================================*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../priorityqueue.hh"
+
+using clock_type = std::chrono::steady_clock;
+using Queue = PriorityQueue<int, int>;
+
+static volatile long sink;
+
+void run(const char* name, int n, double cancelled, bool lazy,
+         bool by_key) {
+   std::mt19937 rng(11);
+   Queue q;
+   q.setLazyErase(lazy);
+   std::vector<Queue::handle_type> handles;
+   handles.reserve(n);
+   for (int i = 0; i < n; ++i)
+      handles.push_back(q.insert(i, static_cast<int>(rng() % 1000000)));
+
+   std::vector<int> victims(n);
+   for (int i = 0; i < n; ++i)
+      victims[i] = i;
+   std::shuffle(victims.begin(), victims.end(), rng);
+   victims.resize(static_cast<size_t>(n * cancelled));
+
+   auto start = clock_type::now();
+   for (int i : victims) {
+      if (by_key)
+         q.eraseKey(i);
+      else
+         q.erase(handles[i]);
+   }
+   std::chrono::duration<double, std::nano> cancel = clock_type::now() - start;
+
+   long sum = 0;
+   size_t popped = q.size();
+   start = clock_type::now();
+   while (!q.empty())
+      sum += q.popMin().first;
+   std::chrono::duration<double, std::nano> drain = clock_type::now() - start;
+   sink = sum;
+
+   std::printf("%-18s %10d %9.0f%% %12.1f %12.1f\n", name, n, 100 * cancelled,
+               cancel.count() / double(victims.size()),
+               drain.count() / double(popped ? popped : 1));
+}
+
+int main(int argc, char** argv) {
+   int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+   std::printf("%-18s %10s %10s %12s %12s\n", "mode", "jobs", "cancelled",
+               "cancel ns", "popMin ns");
+   for (double cancelled : {0.1, 0.5, 0.9}) {
+      run("erase", n, cancelled, false, false);
+      run("erase (lazy)", n, cancelled, true, false);
+      run("eraseKey", n, cancelled, false, true);
+      run("eraseKey (lazy)", n, cancelled, true, true);
+   }
+   return 0;
+}
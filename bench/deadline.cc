@@ -0,0 +1,141 @@
+/*============================================================================*/
+/* Zegary z rotacją: N operacji na zestawie zegarów (klucz - numer zegara,    */
+/* wartość - termin w taktach), typowym dla limitów czasu połączeń: większość */
+/* zegarów jest anulowana przed terminem, a co pewien czas czas przesuwa się  */
+/* do przodu i wywoływane są zegary, które doszły do terminu. Część terminów  */
+/* leży poza horyzontem koła. Porównanie DeadlineQueue z PriorityQueue        */
+/* (erase uchwytem, popMin do chwili bieżącej). Wynik to czas w ns            */
+/* na operację.                                                               */
+/*                                                                            */
+/*    g++ -O2 -DNDEBUG -std=c++17 -I.. deadline.cc -o deadline                */
+/*    ./deadline [liczba operacji, domyślnie 10000000]                        */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../deadlinequeue.hh"
+#include "../priorityqueue.hh"
+
+using clock_type = std::chrono::steady_clock;
+
+// Zestaw żywych zegarów z usuwaniem losowego elementu w O(1).
+template<typename Handle>
+struct Live {
+   std::vector<int> ids;
+   std::vector<size_t> position;
+   std::vector<Handle> handles;
+
+   int add(Handle handle) {
+      int id = handles.size();
+      handles.push_back(handle);
+      position.push_back(ids.size());
+      ids.push_back(id);
+      return id;
+   }
+
+   void remove(int id) {
+      position[ids.back()] = position[id];
+      ids[position[id]] = ids.back();
+      ids.pop_back();
+   }
+};
+
+struct Result {
+   double ns;
+   size_t fired;
+};
+
+// Wspólny przebieg: op < 6 wstawia, op < 9 anuluje, reszta przesuwa czas.
+template<typename Q>
+Result run(int n, unsigned seed, Q& q) {
+   std::mt19937_64 rng(seed);
+   uint64_t now = 0;
+   size_t fired = 0;
+   auto start = clock_type::now();
+   for (int i = 0; i < n; ++i) {
+      unsigned op = rng() % 10;
+      if (op < 6) {
+         // Limity czasu do ~65 tys. taktów, co setny zegar poza horyzontem.
+         uint64_t delay = rng() % 100 == 0 ? (uint64_t(1) << 33) + rng() % 1000
+                                           : 1 + rng() % 65536;
+         q.insert(now + delay);
+      } else if (op < 9) {
+         q.cancel(rng());
+      } else {
+         now += 1 + rng() % 64;
+         fired += q.advance(now);
+      }
+   }
+   std::chrono::duration<double, std::nano> time = clock_type::now() - start;
+   return {time.count() / n, fired};
+}
+
+struct Wheel {
+   DeadlineQueue<int> q;
+   Live<DeadlineQueue<int>::handle_type> live;
+
+   void insert(uint64_t deadline) {
+      int id = live.add({});
+      live.handles[id] = q.insert(id, deadline);
+   }
+
+   void cancel(uint64_t r) {
+      if (live.ids.empty())
+         return;
+      int id = live.ids[r % live.ids.size()];
+      q.cancel(live.handles[id]);
+      live.remove(id);
+   }
+
+   size_t advance(uint64_t now) {
+      return q.advanceTo(now, [this](int id, uint64_t) { live.remove(id); });
+   }
+};
+
+struct Heap {
+   PriorityQueue<int, uint64_t> q;
+   Live<PriorityQueue<int, uint64_t>::handle_type> live;
+
+   void insert(uint64_t deadline) {
+      int id = live.add({});
+      live.handles[id] = q.insert(id, deadline);
+   }
+
+   void cancel(uint64_t r) {
+      if (live.ids.empty())
+         return;
+      int id = live.ids[r % live.ids.size()];
+      q.erase(live.handles[id]);
+      live.remove(id);
+   }
+
+   size_t advance(uint64_t now) {
+      size_t fired = 0;
+      while (!q.empty() && q.minValue() <= now) {
+         live.remove(q.popMin().first);
+         ++fired;
+      }
+      return fired;
+   }
+};
+
+int main(int argc, char** argv) {
+   int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+   Wheel wheel;
+   Heap heap;
+   Result w = run(n, 17, wheel);
+   Result h = run(n, 17, heap);
+   if (w.fired != h.fired || wheel.q.size() != heap.q.size()) {
+      std::fprintf(stderr, "różne wyniki: %zu / %zu\n", w.fired, h.fired);
+      return 1;
+   }
+   std::printf("%-14s %10s %10s %10s\n", "queue", "ops", "fired", "ns/op");
+   std::printf("%-14s %10d %10zu %10.1f\n", "DeadlineQueue", n, w.fired, w.ns);
+   std::printf("%-14s %10d %10zu %10.1f\n", "PriorityQueue", n, h.fired, h.ns);
+   return 0;
+}
@@ -0,0 +1,191 @@
+/*============================================================================*/
+/* PriorityExecutor względem wykonawcy z jedną kolejką PriorityQueue pod      */
+/* globalnym muteksem, dla 1-16 wątków roboczych.                             */
+/*  - przepustowość: zadania rozgałęziające się (każde zleca 4 kolejne do     */
+/*    zadanej głębokości) z krótką pracą; wynik w milionach zadań na sekundę; */
+/*  - opóźnienie: wątki robocze są zajęte zadaniami o niskim priorytecie,     */
+/*    które zlecają się ponownie, a osobny wątek co 50 us zleca zadanie       */
+/*    pilne; wynik to percentyle czasu od zlecenia do startu w us.            */
+/*                                                                            */
+/*    g++ -O2 -DNDEBUG -std=c++17 -pthread -I.. executor.cc -o executor       */
+/*    ./executor [głębokość drzewa zadań, domyślnie 9]                        */
+/*               [liczba pomiarów opóźnienia, domyślnie 5000]                 */
+/*============================================================================*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../priorityexecutor.hh"
+#include "../priorityqueue.hh"
+
+using clock_type = std::chrono::steady_clock;
+
+// Punkt odniesienia: PriorityQueue<numer zadania, priorytet> i zadania
+// pod jednym muteksem.
+class GlobalExecutor {
+
+public:
+
+   explicit GlobalExecutor(unsigned threads) {
+      for (unsigned i = 0; i < threads; ++i)
+         pool.emplace_back([this] { run(); });
+   }
+
+   ~GlobalExecutor() {
+      wait();
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         stopping = true;
+      }
+      ready.notify_all();
+      for (auto& thread : pool)
+         thread.join();
+   }
+
+   template<typename F>
+   void submit(int priority, F&& function) {
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         uint64_t id = next_id++;
+         tasks.emplace(id, std::forward<F>(function));
+         queue.insert(id, priority);
+         ++unfinished;
+      }
+      ready.notify_one();
+   }
+
+   void wait() {
+      std::unique_lock<std::mutex> guard(lock);
+      done.wait(guard, [this] { return unfinished == 0; });
+   }
+
+private:
+
+   void run() {
+      std::unique_lock<std::mutex> guard(lock);
+      for (;;) {
+         ready.wait(guard, [this] { return stopping || !queue.empty(); });
+         if (queue.empty())
+            return;
+         uint64_t id = queue.popMin().first;
+         std::function<void()> function = std::move(tasks[id]);
+         tasks.erase(id);
+         guard.unlock();
+         function();
+         guard.lock();
+         if (--unfinished == 0)
+            done.notify_all();
+      }
+   }
+
+   std::mutex lock;
+   std::condition_variable ready, done;
+   PriorityQueue<uint64_t, int> queue;
+   std::unordered_map<uint64_t, std::function<void()>> tasks;
+   uint64_t next_id = 0;
+   size_t unfinished = 0;
+   bool stopping = false;
+   std::vector<std::thread> pool;
+};
+
+static void work(int n) {
+   volatile int x = 0;
+   for (int i = 0; i < n; ++i)
+      x = x + i;
+}
+
+template<typename E>
+void spawn(E& executor, int depth, std::atomic<long>& count) {
+   count.fetch_add(1, std::memory_order_relaxed);
+   work(50);
+   if (depth == 0)
+      return;
+   for (int i = 0; i < 4; ++i)
+      executor.submit(depth, [&executor, depth, &count] {
+         spawn(executor, depth - 1, count);
+      });
+}
+
+template<typename E>
+double throughput(unsigned threads, int depth) {
+   std::atomic<long> count{0};
+   auto start = clock_type::now();
+   {
+      E executor(threads);
+      executor.submit(0, [&executor, depth, &count] {
+         spawn(executor, depth, count);
+      });
+      executor.wait();
+   }
+   std::chrono::duration<double> time = clock_type::now() - start;
+   return count.load() / time.count() / 1e6;
+}
+
+template<typename E>
+struct Background {
+   E& executor;
+   std::atomic<bool>& stop;
+
+   void operator()() const {
+      work(500);
+      if (!stop.load(std::memory_order_relaxed))
+         executor.submit(100, *this);
+   }
+};
+
+// Percentyle opóźnienia zadań pilnych (us): p50, p99, p99.9.
+template<typename E>
+std::vector<double> latency(unsigned threads, int samples) {
+   std::vector<double> delays(samples);
+   std::atomic<bool> stop{false};
+   std::atomic<int> finished{0};
+   {
+      E executor(threads);
+      for (unsigned i = 0; i < 4 * threads; ++i)
+         executor.submit(100, Background<E>{executor, stop});
+      for (int i = 0; i < samples; ++i) {
+         auto submitted = clock_type::now();
+         executor.submit(0, [&delays, &finished, submitted, i] {
+            std::chrono::duration<double, std::micro> delay =
+               clock_type::now() - submitted;
+            delays[i] = delay.count();
+            finished.fetch_add(1);
+         });
+         std::this_thread::sleep_until(submitted +
+                                       std::chrono::microseconds(50));
+      }
+      while (finished.load() < samples)
+         std::this_thread::yield();
+      stop = true;
+   }
+   std::sort(delays.begin(), delays.end());
+   return {delays[samples / 2], delays[samples * 99 / 100],
+           delays[samples * 999 / 1000]};
+}
+
+int main(int argc, char** argv) {
+   int depth = argc > 1 ? std::atoi(argv[1]) : 9;
+   int samples = argc > 2 ? std::atoi(argv[2]) : 5000;
+   std::printf("%8s %12s %12s %28s %28s\n", "threads", "global Mt/s",
+               "priority Mt/s", "global p50/p99/p99.9 us",
+               "priority p50/p99/p99.9 us");
+   for (unsigned threads = 1; threads <= 16; threads *= 2) {
+      double global = throughput<GlobalExecutor>(threads, depth);
+      double priority = throughput<PriorityExecutor<int>>(threads, depth);
+      std::vector<double> g = latency<GlobalExecutor>(threads, samples);
+      std::vector<double> p = latency<PriorityExecutor<int>>(threads, samples);
+      std::printf("%8u %12.2f %12.2f %10.1f/%7.1f/%8.1f %10.1f/%7.1f/%8.1f\n",
+                  threads, global, priority, g[0], g[1], g[2], p[0], p[1],
+                  p[2]);
+   }
+   return 0;
+}
@@ -0,0 +1,73 @@
+/*============================================================================*/
+/* extractMin(n) i extractMax(n) względem n wywołań popMin/popMax na kolejce  */
+/* N par int o losowych kluczach i wartościach, dla n od 0,1% do 100% N,      */
+/* w strategii domyślnej i BTreeBackend. Wynik to czas w ns na wyjętą parę.   */
+/*                                                                            */
+/*    g++ -O2 -DNDEBUG -std=c++17 -I.. extract.cc -o extract                  */
+/*    ./extract [liczba par, domyślnie 1000000]                               */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../btreequeue.hh"
+#include "../priorityqueue.hh"
+
+using clock_type = std::chrono::steady_clock;
+
+static volatile long sink;
+
+template<typename Queue, typename Fn>
+double measure(const Queue& filled, size_t n, Fn fn) {
+   Queue q(filled);
+   std::vector<std::pair<int, int>> out;
+   out.reserve(n);
+   auto start = clock_type::now();
+   fn(q, out);
+   std::chrono::duration<double, std::nano> time = clock_type::now() - start;
+   sink = out.empty() ? 0 : out.back().first;
+   return time.count() / double(n);
+}
+
+template<typename Queue>
+void run(const char* name, size_t size) {
+   std::mt19937 rng(7);
+   Queue filled;
+   for (size_t i = 0; i < size; ++i)
+      filled.insert(static_cast<int>(rng()), static_cast<int>(rng()));
+
+   std::printf("%s\n%10s %8s %12s %14s %12s %14s\n", name, "n", "share",
+               "popMin ns", "extractMin ns", "popMax ns", "extractMax ns");
+   for (double share : {0.001, 0.01, 0.1, 0.5, 0.7, 1.0}) {
+      size_t n = std::max<size_t>(1, static_cast<size_t>(share * size));
+      double pop_min = measure(filled, n, [n](Queue& q, auto& out) {
+         for (size_t i = 0; i < n; ++i)
+            out.push_back(q.popMin());
+      });
+      double extract_min = measure(filled, n, [n](Queue& q, auto& out) {
+         q.extractMin(n, std::back_inserter(out));
+      });
+      double pop_max = measure(filled, n, [n](Queue& q, auto& out) {
+         for (size_t i = 0; i < n; ++i)
+            out.push_back(q.popMax());
+      });
+      double extract_max = measure(filled, n, [n](Queue& q, auto& out) {
+         q.extractMax(n, std::back_inserter(out));
+      });
+      std::printf("%10zu %7.1f%% %12.1f %14.1f %12.1f %14.1f\n", n,
+                  100 * share, pop_min, extract_min, pop_max, extract_max);
+   }
+}
+
+int main(int argc, char** argv) {
+   size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+   run<PriorityQueue<int, int>>("domyślna", size);
+   run<PriorityQueue<int, int, std::allocator<std::pair<const int, int>>,
+                     BTreeBackend>>("BTreeBackend", size);
+   return 0;
+}
@@ -0,0 +1,94 @@
+/*============================================================================*/
+/* Skalowanie MultiQueue i kolejki bez blokad (LockFreeSkipListBackend)       */
+/* względem PriorityQueue pod jednym muteksem, dla 1-64 wątków. Każdy wątek   */
+/* na przemian wstawia losową parę i usuwa minimum; wynik to przepustowość   */
+/* w milionach operacji na sekundę.                                           */
+/*                                                                            */
+/*    g++ -O2 -std=c++17 -pthread -I.. multiqueue.cc -o multiqueue            */
+/*    ./multiqueue [operacje na wątek]                                        */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../multiqueue.hh"
+#include "../skiplistqueue.hh"
+
+// Punkt odniesienia: cała kolejka pod jednym muteksem.
+template<typename K, typename V>
+class LockedQueue {
+
+public:
+
+   explicit LockedQueue(unsigned) {}
+
+   void insert(const K& key, const V& value) {
+      std::lock_guard<std::mutex> guard(lock);
+      queue.insert(key, value);
+   }
+
+   void deleteMin() {
+      std::lock_guard<std::mutex> guard(lock);
+      queue.deleteMin();
+   }
+
+private:
+
+   std::mutex lock;
+   PriorityQueue<K, V> queue;
+};
+
+// Kolejka bez blokad z konstruktorem przyjmującym liczbę wątków.
+template<typename K, typename V>
+class SkipListQueue: public PriorityQueue<K, V,
+   std::allocator<std::pair<const K, V>>, LockFreeSkipListBackend> {
+
+public:
+
+   explicit SkipListQueue(unsigned) {}
+};
+
+template<typename Q>
+double run(unsigned threads, int ops) {
+   const int prefill = 100000;
+   Q queue(threads);
+   std::mt19937 rng(1);
+   for (int i = 0; i < prefill; ++i)
+      queue.insert(i, static_cast<int>(rng() % 1000000));
+
+   auto start = std::chrono::steady_clock::now();
+   std::vector<std::thread> workers;
+   for (unsigned t = 0; t < threads; ++t)
+      workers.emplace_back([&queue, ops, t] {
+         std::mt19937 rng(t + 2);
+         for (int i = 0; i < ops; ++i) {
+            if (i % 2 == 0)
+               queue.insert(i, static_cast<int>(rng() % 1000000));
+            else
+               queue.deleteMin();
+         }
+      });
+   for (auto& w : workers)
+      w.join();
+   std::chrono::duration<double> time =
+      std::chrono::steady_clock::now() - start;
+   return double(threads) * ops / time.count() / 1e6;
+}
+
+int main(int argc, char** argv) {
+   int ops = argc > 1 ? std::atoi(argv[1]) : 200000;
+   std::printf("%8s %14s %14s %14s\n", "threads", "mutex Mops/s",
+               "multi Mops/s", "skip Mops/s");
+   for (unsigned threads = 1; threads <= 64; threads *= 2) {
+      double locked = run<LockedQueue<int, int>>(threads, ops);
+      double multi = run<MultiQueue<int, int>>(threads, ops);
+      double skip = run<SkipListQueue<int, int>>(threads, ops);
+      std::printf("%8u %14.2f %14.2f %14.2f\n", threads, locked, multi, skip);
+   }
+   return 0;
+}
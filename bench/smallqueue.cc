@@ -0,0 +1,70 @@
+/*============================================================================*/
+/* Wiele małych kolejek: SmallFlatBackend<64> względem domyślnej strategii.   */
+/* Każda z Q kolejek dostaje od 8 do 48 par int, po czym na losowych          */
+/* kolejkach wykonywane są na przemian insert + popMin oraz changeValue +     */
+/* minValue. Wynik to czas w ns na operację (opóźnienie pojedynczego          */
+/* wywołania, gdy dane kolejki nie są w pamięci podręcznej).                  */
+/*                                                                            */
+/*    g++ -O2 -DNDEBUG -std=c++17 [-mavx2] -I.. smallqueue.cc -o smallqueue   */
+/*    ./smallqueue [liczba kolejek, domyślnie 100000]                         */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../smallqueue.hh"
+
+using clock_type = std::chrono::steady_clock;
+
+static volatile long sink;
+
+template<typename Q>
+void run(const char* name, size_t queues) {
+   std::mt19937 rng(7);
+   std::vector<Q> q(queues);
+   std::vector<int> sizes(queues);
+
+   auto start = clock_type::now();
+   size_t pairs = 0;
+   for (size_t i = 0; i < queues; ++i) {
+      sizes[i] = 8 + rng() % 41;
+      for (int k = 0; k < sizes[i]; ++k)
+         q[i].insert(k, static_cast<int>(rng() % 1000000));
+      pairs += sizes[i];
+   }
+   std::chrono::duration<double, std::nano> fill = clock_type::now() - start;
+
+   const size_t ops = 4 * queues;
+   long sum = 0;
+   start = clock_type::now();
+   for (size_t i = 0; i < ops; ++i) {
+      Q& x = q[rng() % queues];
+      int value = static_cast<int>(rng() % 1000000);
+      if (i % 2 == 0) {
+         sum += x.popMin().first;
+         x.insert(static_cast<int>(rng() % 48), value);
+      } else {
+         if (x.contains(3))
+            x.changeValue(3, value);
+         sum += x.minValue();
+      }
+   }
+   std::chrono::duration<double, std::nano> mixed = clock_type::now() - start;
+   sink = sum;
+
+   std::printf("%-22s %10zu %12.1f %12.1f\n", name, queues,
+               fill.count() / double(pairs), mixed.count() / double(ops));
+}
+
+int main(int argc, char** argv) {
+   size_t queues = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+   std::printf("%-22s %10s %12s %12s\n", "structure", "queues", "insert ns",
+               "mixed ns");
+   run<PriorityQueue<int, int>>("PriorityQueue", queues);
+   run<PriorityQueue<int, int, std::allocator<std::pair<const int, int>>,
+                     SmallFlatBackend<64>>>("SmallFlatBackend<64>", queues);
+   return 0;
+}
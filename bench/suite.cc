@@ -0,0 +1,302 @@
+/*============================================================================*/
+/* Zestaw mikrobenchmarków PriorityQueue z punktami odniesienia               */
+/* std::priority_queue i std::multimap. Mierzy insert, deleteMin, deleteMax,  */
+/* changeValue, merge, konstruktor kopiujący oraz operatory == i < dla        */
+/* rozmiarów 10^2 ... 10^k i typów int, std::string (poza SSO) oraz 64-       */
+/* bajtowej struktury. Wynik (czas w ns na element) trafia na standardowe     */
+/* wyjście jako CSV lub JSON, do porównywania między wersjami.                */
+/*                                                                            */
+/*    make bench                     (z katalogu głównego, BENCH_ARGS=...)    */
+/*    ./suite [--format=csv|json] [--max-size=N] [--filter=operacja]          */
+/*                                                                            */
+/* Domyślnie --max-size=1000000; 10^7 par std::string zajmuje kilka GB.       */
+/* Operacje niedostępne w danej strukturze są pomijane.                       */
+/*============================================================================*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../priorityqueue.hh"
+
+// 64-bajtowy ładunek porównywany po pierwszym słowie.
+struct Payload64 {
+   uint64_t words[8];
+};
+
+bool operator<(const Payload64& a, const Payload64& b) {
+   return a.words[0] < b.words[0];
+}
+
+bool operator==(const Payload64& a, const Payload64& b) {
+   return std::memcmp(a.words, b.words, sizeof(a.words)) == 0;
+}
+
+template<typename T>
+T make(uint64_t x);
+
+template<>
+int make<int>(uint64_t x) {
+   return static_cast<int>(x);
+}
+
+template<>
+std::string make<std::string>(uint64_t x) {
+   char buffer[24];
+   std::snprintf(buffer, sizeof(buffer), "key-%016llx",
+                 static_cast<unsigned long long>(x));
+   return buffer;
+}
+
+template<>
+Payload64 make<Payload64>(uint64_t x) {
+   Payload64 p;
+   for (int i = 0; i < 8; ++i)
+      p.words[i] = x + i;
+   return p;
+}
+
+/*============================================================================*/
+/* Adaptery struktur. Każdy udostępnia te same statyczne operacje, a flagi    */
+/* mówią, które z nich struktura obsługuje.                                   */
+/*============================================================================*/
+
+template<typename T>
+struct PriorityQueueAdapter {
+   using queue_t = PriorityQueue<T, T>;
+   static constexpr const char* name = "PriorityQueue";
+   static constexpr bool has_max = true, has_change = true, has_compare = true;
+
+   static void insert(queue_t& q, const T& key, const T& value) {
+      q.insert(key, value);
+   }
+   static void deleteMin(queue_t& q) { q.deleteMin(); }
+   static void deleteMax(queue_t& q) { q.deleteMax(); }
+   static void changeValue(queue_t& q, const T& key, const T& value) {
+      q.changeValue(key, value);
+   }
+   static void merge(queue_t& q, queue_t& other) { q.merge(other); }
+   static bool equal(const queue_t& a, const queue_t& b) { return a == b; }
+   static bool less(const queue_t& a, const queue_t& b) { return a < b; }
+};
+
+// Kopiec binarny; porządek odwrócony, aby na szczycie było minimum.
+template<typename T>
+struct HeapAdapter {
+   using queue_t = std::priority_queue<std::pair<T, T>,
+                                       std::vector<std::pair<T, T>>,
+                                       std::greater<std::pair<T, T>>>;
+   static constexpr const char* name = "std::priority_queue";
+   static constexpr bool has_max = false, has_change = false,
+                         has_compare = false;
+
+   static void insert(queue_t& q, const T& key, const T& value) {
+      q.emplace(value, key);
+   }
+   static void deleteMin(queue_t& q) { q.pop(); }
+   static void deleteMax(queue_t&) {}
+   static void changeValue(queue_t&, const T&, const T&) {}
+   static void merge(queue_t& q, queue_t& other) {
+      for (; !other.empty(); other.pop())
+         q.push(other.top());
+   }
+   static bool equal(const queue_t&, const queue_t&) { return false; }
+   static bool less(const queue_t&, const queue_t&) { return false; }
+};
+
+// Drzewo uporządkowane po wartościach; bez indeksu kluczy, więc bez
+// changeValue.
+template<typename T>
+struct MultimapAdapter {
+   using queue_t = std::multimap<T, T>;
+   static constexpr const char* name = "std::multimap";
+   static constexpr bool has_max = true, has_change = false,
+                         has_compare = true;
+
+   static void insert(queue_t& q, const T& key, const T& value) {
+      q.emplace(value, key);
+   }
+   static void deleteMin(queue_t& q) { q.erase(q.begin()); }
+   static void deleteMax(queue_t& q) { q.erase(std::prev(q.end())); }
+   static void changeValue(queue_t&, const T&, const T&) {}
+   static void merge(queue_t& q, queue_t& other) {
+      q.insert(other.begin(), other.end());
+      other.clear();
+   }
+   static bool equal(const queue_t& a, const queue_t& b) { return a == b; }
+   static bool less(const queue_t& a, const queue_t& b) { return a < b; }
+};
+
+/*============================================================================*/
+/* Pomiary.                                                                   */
+/*============================================================================*/
+
+struct Options {
+   bool json = false;
+   size_t max_size = 1000000;
+   std::string filter;
+};
+
+struct Result {
+   std::string structure, type, operation;
+   size_t size;
+   double ns_per_element;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+static volatile bool sink;
+
+// Pomiar fn na świeżych danych z setup (poza pomiarem), powtarzany tak, by
+// łącznie przetworzyć co najmniej 10^6 elementów.
+template<typename Setup, typename Fn>
+double measure(size_t n, Setup setup, Fn fn) {
+   size_t repeats = std::max<size_t>(1, 1000000 / n);
+   std::chrono::duration<double, std::nano> total(0);
+   for (size_t r = 0; r < repeats; ++r) {
+      auto state = setup();
+      auto start = clock_type::now();
+      fn(state);
+      total += clock_type::now() - start;
+   }
+   return total.count() / (double(repeats) * n);
+}
+
+template<typename Adapter, typename T>
+void run(const char* type, size_t n, const Options& options,
+         std::vector<Result>& results) {
+   using queue_t = typename Adapter::queue_t;
+   std::mt19937_64 rng(n);
+   std::vector<std::pair<T, T>> pairs;
+   pairs.reserve(n);
+   for (size_t i = 0; i < n; ++i)
+      pairs.emplace_back(make<T>(i), make<T>(rng()));
+   std::vector<std::pair<T, T>> changes;
+   changes.reserve(n);
+   for (size_t i = 0; i < n; ++i)
+      changes.emplace_back(pairs[rng() % n].first, make<T>(rng()));
+
+   auto filled = [&] {
+      queue_t q;
+      for (auto& p : pairs)
+         Adapter::insert(q, p.first, p.second);
+      return q;
+   };
+   auto record = [&](const char* operation, auto setup, auto fn) {
+      if (!options.filter.empty() && options.filter != operation)
+         return;
+      results.push_back(Result{Adapter::name, type, operation, n,
+                               measure(n, setup, fn)});
+   };
+
+   record("insert", [] { return queue_t(); }, [&](queue_t& q) {
+      for (auto& p : pairs)
+         Adapter::insert(q, p.first, p.second);
+   });
+   record("deleteMin", filled, [n](queue_t& q) {
+      for (size_t i = 0; i < n; ++i)
+         Adapter::deleteMin(q);
+   });
+   if (Adapter::has_max)
+      record("deleteMax", filled, [n](queue_t& q) {
+         for (size_t i = 0; i < n; ++i)
+            Adapter::deleteMax(q);
+      });
+   if (Adapter::has_change)
+      record("changeValue", filled, [&](queue_t& q) {
+         for (auto& c : changes)
+            Adapter::changeValue(q, c.first, c.second);
+      });
+   record("merge", [&] {
+      std::pair<queue_t, queue_t> halves;
+      for (size_t i = 0; i < n; ++i)
+         Adapter::insert(i % 2 ? halves.first : halves.second,
+                         pairs[i].first, pairs[i].second);
+      return halves;
+   }, [](std::pair<queue_t, queue_t>& halves) {
+      Adapter::merge(halves.first, halves.second);
+   });
+   record("copy", filled, [](queue_t& q) {
+      queue_t copy(q);
+      sink = copy.empty();
+   });
+   if (Adapter::has_compare) {
+      auto twins = [&] {
+         queue_t q = filled();
+         return std::make_pair(q, q);
+      };
+      record("operator==", twins, [](std::pair<queue_t, queue_t>& q) {
+         sink = Adapter::equal(q.first, q.second);
+      });
+      record("operator<", twins, [](std::pair<queue_t, queue_t>& q) {
+         sink = Adapter::less(q.first, q.second);
+      });
+   }
+}
+
+template<typename T>
+void run_type(const char* type, const Options& options,
+              std::vector<Result>& results) {
+   for (size_t n = 100; n <= options.max_size; n *= 10) {
+      run<PriorityQueueAdapter<T>, T>(type, n, options, results);
+      run<HeapAdapter<T>, T>(type, n, options, results);
+      run<MultimapAdapter<T>, T>(type, n, options, results);
+   }
+}
+
+void print(const std::vector<Result>& results, bool json) {
+   if (json) {
+      std::printf("[\n");
+      for (size_t i = 0; i < results.size(); ++i) {
+         const Result& r = results[i];
+         std::printf("  {\"structure\": \"%s\", \"type\": \"%s\", "
+                     "\"operation\": \"%s\", \"size\": %zu, "
+                     "\"ns_per_element\": %.2f}%s\n",
+                     r.structure.c_str(), r.type.c_str(), r.operation.c_str(),
+                     r.size, r.ns_per_element,
+                     i + 1 < results.size() ? "," : "");
+      }
+      std::printf("]\n");
+   } else {
+      std::printf("structure,type,operation,size,ns_per_element\n");
+      for (const Result& r : results)
+         std::printf("%s,%s,%s,%zu,%.2f\n", r.structure.c_str(),
+                     r.type.c_str(), r.operation.c_str(), r.size,
+                     r.ns_per_element);
+   }
+}
+
+int main(int argc, char** argv) {
+   Options options;
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--format=json") == 0) {
+         options.json = true;
+      } else if (std::strcmp(argv[i], "--format=csv") == 0) {
+         options.json = false;
+      } else if (std::strncmp(argv[i], "--max-size=", 11) == 0) {
+         options.max_size = std::strtoull(argv[i] + 11, nullptr, 10);
+      } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+         options.filter = argv[i] + 9;
+      } else {
+         std::fprintf(stderr, "usage: %s [--format=csv|json] [--max-size=N] "
+                      "[--filter=operation]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   std::vector<Result> results;
+   run_type<int>("int", options, results);
+   run_type<std::string>("string", options, results);
+   run_type<Payload64>("payload64", options, results);
+   print(results, options.json);
+   return 0;
+}
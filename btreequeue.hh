@@ -0,0 +1,1410 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* Strategia BTreeBackend: oba indeksy kolejki są B+-drzewami o szerokich     */
+/* węzłach (node_bytes bajtów, 16 linii pamięci podręcznej), które            */
+/* przechowują pary bezpośrednio w liściach, bez osobnych węzłów na element.  */
+/* Wyszukiwanie odwiedza O(log_B n) węzłów zamiast O(log n), a liście są      */
+/* połączone w listę, więc przejście w porządku (minimum, maksimum,           */
+/* extractMin/extractMax, zliczanie par o kluczu) czyta pamięć ciągłą.        */
+/*                                                                            */
+/* Indeks kluczy i indeks wartości trzymają osobne kopie pary (klucz,         */
+/* wartość) z numerem wstawienia, który rozstrzyga remisy tak jak             */
+/* w domyślnej strategii (równe wartości w kolejności wstawiania). Elementy   */
+/* są przesuwane między węzłami przy podziałach i scaleniach, dlatego         */
+/* strategia nie udostępnia uchwytów.                                         */
+/*                                                                            */
+/* Dostępne są insert, emplace, minValue, maxValue, minKey, maxKey,           */
+/* deleteMin, deleteMax, popMin, popMax, tryPopMin, tryPopMax, extractMin,    */
+/* extractMax, changeValue, contains, count, eraseKey, eraseAll, merge, swap, */
+/* kopiowanie oraz operatory porównania kolejek. K i V muszą być kopiowane    */
+/* i przenoszone bez wyjątków, a ich porównania nie mogą zgłaszać wyjątków    */
+/* (np. typy arytmetyczne i małe struktury) - jedynym źródłem wyjątków jest   */
+/* wtedy alokacja węzłów, która następuje przed jakąkolwiek zmianą, więc      */
+/* operacje dają silną gwarancję.                                             */
+/*============================================================================*/
+
+#ifndef __BTREEQUEUE_HH__
+#define __BTREEQUEUE_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+namespace pq_detail {
+
+// B+-drzewo elementów typu T w porządku wyznaczanym przez predykaty
+// wyszukiwania (drzewo nie porównuje elementów samo). Liście trzymają
+// elementy, węzły wewnętrzne - kopie separatorów: separator i jest nie
+// większy od każdego elementu dziecka i + 1 i większy od każdego elementu
+// dziecka i. Węzeł ma jedno wolne miejsce ponad pojemność, dzięki czemu
+// wstawienie najpierw umieszcza element, a dopiero potem dzieli węzeł.
+template<typename T, typename Allocator>
+class BPlusTree {
+
+   static_assert(std::is_nothrow_copy_constructible<T>::value &&
+                 std::is_nothrow_move_constructible<T>::value &&
+                 std::is_nothrow_move_assignable<T>::value,
+                 "BPlusTree: elementy muszą być kopiowane i przenoszone "
+                 "no-throw");
+
+   struct Node {
+      explicit Node(bool leaf) : count(0), leaf(leaf) {}
+
+      uint32_t count; // liczba elementów (liść) lub dzieci (węzeł wewnętrzny)
+      bool leaf;
+   };
+
+   // Rozmiar węzła: 16 linii pamięci podręcznej. W pomiarach (10^6 par
+   // int, bench/btree.cc) węzły 256-bajtowe były o 30-50% wolniejsze,
+   // a większe niż 1024 bajty - nie szybsze: zysk z niższego drzewa
+   // zjada przesuwanie elementów w węźle.
+   static constexpr size_t node_bytes = 1024;
+
+   // Liczba elementów o rozmiarze slot mieszczących się w węźle
+   // z nagłówkiem header, z jednym miejscem zapasowym (co najmniej 4).
+   static constexpr size_t fit(size_t header, size_t slot) {
+      return node_bytes >= header + 5 * slot ? (node_bytes - header) / slot - 1
+                                             : 4;
+   }
+
+public:
+
+   static constexpr size_t leaf_capacity =
+      fit(sizeof(Node) + 2 * sizeof(void*), sizeof(T));
+   static constexpr size_t inner_capacity =
+      fit(sizeof(Node), sizeof(T) + sizeof(void*));
+
+private:
+
+   struct Leaf: Node {
+      Leaf() : Node(true), prev(nullptr), next(nullptr) {}
+
+      T* items() noexcept {
+         return reinterpret_cast<T*>(storage);
+      }
+
+      const T* items() const noexcept {
+         return reinterpret_cast<const T*>(storage);
+      }
+
+      Leaf* prev;
+      Leaf* next;
+      alignas(T) unsigned char storage[(leaf_capacity + 1) * sizeof(T)];
+   };
+
+   struct Inner: Node {
+      Inner() : Node(false) {}
+
+      T* keys() noexcept {
+         return reinterpret_cast<T*>(storage);
+      }
+
+      const T* keys() const noexcept {
+         return reinterpret_cast<const T*>(storage);
+      }
+
+      Node* children[inner_capacity + 1];
+      alignas(T) unsigned char storage[inner_capacity * sizeof(T)];
+   };
+
+   // Minimalne zapełnienie węzłów innych niż korzeń.
+   static constexpr uint32_t leaf_min = leaf_capacity / 2;
+   static constexpr uint32_t inner_min = inner_capacity / 2;
+
+   // Ścieżka od korzenia do liścia: w węźle wewnętrznym indeks dziecka,
+   // w liściu - pozycja elementu. Przy zapełnieniu co najmniej
+   // inner_capacity / 2 >= 2 wysokość nie przekracza 64.
+   static constexpr int max_depth = 64;
+
+   struct Path {
+      Node* nodes[max_depth];
+      uint32_t index[max_depth];
+      int depth = 0;
+   };
+
+   using leaf_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<Leaf>;
+   using leaf_traits_t = std::allocator_traits<leaf_allocator_t>;
+   using inner_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<Inner>;
+   using inner_traits_t = std::allocator_traits<inner_allocator_t>;
+
+public:
+
+   // Pozycja elementu w liściu; przesuwa się po liściach w porządku drzewa.
+   // Traci ważność przy każdej zmianie drzewa.
+   class Cursor {
+
+   public:
+
+      Cursor() {}
+
+      explicit operator bool() const {
+         return leaf != nullptr;
+      }
+
+      const T& operator*() const {
+         return leaf->items()[pos];
+      }
+
+      const T* operator->() const {
+         return leaf->items() + pos;
+      }
+
+      Cursor& operator++() {
+         if (++pos == leaf->count) {
+            leaf = leaf->next;
+            pos = 0;
+         }
+         return *this;
+      }
+
+      Cursor& operator--() {
+         if (pos == 0) {
+            leaf = leaf->prev;
+            pos = leaf ? leaf->count : 0;
+         }
+         if (leaf)
+            --pos;
+         return *this;
+      }
+
+   private:
+
+      friend class BPlusTree;
+
+      Cursor(const Leaf* leaf, uint32_t pos) : leaf(leaf), pos(pos) {}
+
+      const Leaf* leaf = nullptr;
+      uint32_t pos = 0;
+   };
+
+   // Przygotowanie wstawienia: wyszukanie miejsca i alokacja wszystkich
+   // węzłów, których może wymagać podział. Konstruktor może zgłosić wyjątek
+   // (alokacja, predykat), ale nie zmienia drzewa; niewykorzystane węzły
+   // zwalnia destruktor. Ścieżka traci ważność przy zmianie drzewa.
+   class Insertion {
+
+   public:
+
+      // goes_before(e) mówi, czy nowy element ma leżeć przed e; przy
+      // remisach nowy element trafia za elementy równe.
+      template<typename GoesBefore>
+      Insertion(BPlusTree& tree, GoesBefore goes_before) : tree(tree) {
+         if (!tree.root_) {
+            leaf = tree.create_leaf();
+            return;
+         }
+         tree.descend(goes_before, path);
+         int d = path.depth - 1;
+         if (path.nodes[d]->count < leaf_capacity)
+            return;
+         leaf = tree.create_leaf();
+         try {
+            // Po jednym węźle na pełnego przodka i nowy korzeń, gdy pełne
+            // są wszystkie węzły ścieżki.
+            for (--d; ; --d) {
+               if (d >= 0 && path.nodes[d]->count < inner_capacity)
+                  break;
+               inners[allocated++] = tree.create_inner();
+               if (d < 0)
+                  break;
+            }
+         } catch (...) {
+            release();
+            throw;
+         }
+      }
+
+      Insertion(const Insertion&) = delete;
+
+      Insertion& operator=(const Insertion&) = delete;
+
+      ~Insertion() {
+         release();
+      }
+
+   private:
+
+      friend class BPlusTree;
+
+      Leaf* take_leaf() noexcept {
+         Leaf* l = leaf;
+         leaf = nullptr;
+         return l;
+      }
+
+      Inner* take_inner() noexcept {
+         return inners[used++];
+      }
+
+      void release() noexcept {
+         if (leaf)
+            tree.deallocate(leaf);
+         while (used < allocated)
+            tree.deallocate(inners[used++]);
+      }
+
+      BPlusTree& tree;
+      Path path;
+      Leaf* leaf = nullptr;
+      Inner* inners[max_depth + 1];
+      int allocated = 0;
+      int used = 0;
+   };
+
+   explicit BPlusTree(const Allocator& alloc = Allocator())
+      : leaf_alloc(alloc), inner_alloc(alloc) {}
+
+   // Kopia struktury węzeł po węźle, bez porównań. [O(tree.size())]
+   BPlusTree(const BPlusTree& tree)
+      : leaf_alloc(leaf_traits_t::select_on_container_copy_construction(
+           tree.leaf_alloc)),
+        inner_alloc(inner_traits_t::select_on_container_copy_construction(
+           tree.inner_alloc)) {
+      if (!tree.root_)
+         return;
+      Leaf* last = nullptr;
+      root_ = clone(tree.root_, last);
+      last_ = last;
+      size_ = tree.size_;
+   }
+
+   BPlusTree& operator=(const BPlusTree&) = delete;
+
+   ~BPlusTree() {
+      clear();
+   }
+
+   Allocator get_allocator() const {
+      return Allocator(leaf_alloc);
+   }
+
+   bool empty() const noexcept {
+      return size_ == 0;
+   }
+
+   size_t size() const noexcept {
+      return size_;
+   }
+
+   // Skrajne elementy. [O(1)]
+   const T& first() const noexcept {
+      return first_->items()[0];
+   }
+
+   const T& last() const noexcept {
+      return last_->items()[last_->count - 1];
+   }
+
+   Cursor begin() const noexcept {
+      return Cursor(first_, 0);
+   }
+
+   // Kursor na ostatni element (pusty dla pustego drzewa); operator--
+   // przesuwa go w stronę początku.
+   Cursor before_end() const noexcept {
+      return last_ ? Cursor(last_, last_->count - 1) : Cursor();
+   }
+
+   // Pierwszy element e, dla którego precedes(e) == false (predykat musi
+   // być monotoniczny w porządku drzewa). [O(log size())]
+   template<typename Precedes>
+   Cursor lower_bound(Precedes precedes) const {
+      const Node* n = root_;
+      if (!n)
+         return Cursor();
+      while (!n->leaf) {
+         const Inner* in = static_cast<const Inner*>(n);
+         n = in->children[std::partition_point(in->keys(),
+                                               in->keys() + in->count - 1,
+                                               precedes) - in->keys()];
+      }
+      const Leaf* l = static_cast<const Leaf*>(n);
+      uint32_t pos = static_cast<uint32_t>(
+         std::partition_point(l->items(), l->items() + l->count, precedes) -
+         l->items());
+      // Wszystkie elementy liścia poprzedzają szukany - jest nim pierwszy
+      // element następnego liścia.
+      if (pos == l->count)
+         return Cursor(l->next, 0);
+      return Cursor(l, pos);
+   }
+
+   // Wstawienie elementu w miejscu przygotowanym przez insertion.
+   // [O(log size())]
+   void insert(Insertion& insertion, T&& x) noexcept {
+      ++size_;
+      if (!root_) {
+         Leaf* l = insertion.take_leaf();
+         new (l->items()) T(std::move(x));
+         l->count = 1;
+         root_ = first_ = last_ = l;
+         return;
+      }
+
+      Path& path = insertion.path;
+      int d = path.depth - 1;
+      Leaf* l = static_cast<Leaf*>(path.nodes[d]);
+      insert_at(l->items(), l->count, path.index[d], std::move(x));
+      if (++l->count <= leaf_capacity)
+         return;
+
+      // Podział przepełnionego liścia; separatorem jest kopia pierwszego
+      // elementu prawej połowy.
+      Leaf* right = insertion.take_leaf();
+      uint32_t keep = l->count / 2;
+      relocate(l->items() + keep, l->count - keep, right->items());
+      right->count = l->count - keep;
+      l->count = keep;
+      right->prev = l;
+      right->next = l->next;
+      if (l->next)
+         l->next->prev = right;
+      else
+         last_ = right;
+      l->next = right;
+      T separator(right->items()[0]);
+      Node* child = right;
+
+      for (--d; d >= 0; --d) {
+         Inner* in = static_cast<Inner*>(path.nodes[d]);
+         uint32_t i = path.index[d];
+         insert_at(in->keys(), in->count - 1, i, std::move(separator));
+         std::copy_backward(in->children + i + 1, in->children + in->count,
+                            in->children + in->count + 1);
+         in->children[i + 1] = child;
+         if (++in->count <= inner_capacity)
+            return;
+
+         // Podział węzła wewnętrznego: środkowy separator idzie w górę.
+         Inner* r = insertion.take_inner();
+         keep = in->count / 2;
+         relocate(in->keys() + keep, in->count - 1 - keep, r->keys());
+         std::copy(in->children + keep, in->children + in->count,
+                   r->children);
+         r->count = in->count - keep;
+         separator = std::move(in->keys()[keep - 1]);
+         in->keys()[keep - 1].~T();
+         in->count = keep;
+         child = r;
+      }
+
+      Inner* root = insertion.take_inner();
+      root->children[0] = root_;
+      root->children[1] = child;
+      new (root->keys()) T(std::move(separator));
+      root->count = 2;
+      root_ = root;
+   }
+
+   // Usunięcie elementu, który jest w drzewie; goes_before jak przy
+   // wstawianiu: dla usuwanego elementu x goes_before(x) == false.
+   // [O(log size())]
+   template<typename GoesBefore>
+   void erase(GoesBefore goes_before) noexcept {
+      Path path;
+      descend(goes_before, path);
+      assert(path.index[path.depth - 1] > 0);
+      --path.index[path.depth - 1];
+      erase(path);
+   }
+
+   // Usunięcie skrajnego elementu, bez porównań. [O(log size())]
+   void erase_first() noexcept {
+      Path path;
+      for (Node* n = root_; ; n = static_cast<Inner*>(n)->children[0]) {
+         path.nodes[path.depth] = n;
+         path.index[path.depth++] = 0;
+         if (n->leaf)
+            break;
+      }
+      erase(path);
+   }
+
+   void erase_last() noexcept {
+      Path path;
+      for (Node* n = root_; ;
+           n = static_cast<Inner*>(n)->children[n->count - 1]) {
+         path.nodes[path.depth] = n;
+         path.index[path.depth++] = n->count - 1;
+         if (n->leaf)
+            break;
+      }
+      erase(path);
+   }
+
+   // Usunięcie wszystkich elementów leżących przed miejscem wstawienia
+   // wyznaczonym przez goes_before (cut_front: e, dla których
+   // goes_before(e) == false) lub za nim (cut_back: pozostałe). Całe
+   // poddrzewa po odciętej stronie ścieżki są zwalniane bez przesuwania
+   // elementów, a zapełnienie węzłów na skraju ścieżki jest przywracane
+   // od korzenia w dół. [O(log size() + liczba usuniętych)]
+   template<typename GoesBefore>
+   void cut_front(GoesBefore goes_before) noexcept {
+      if (!root_)
+         return;
+      Path path;
+      descend(goes_before, path);
+      int d = 0;
+      for (; d < path.depth - 1; ++d) {
+         Inner* in = static_cast<Inner*>(path.nodes[d]);
+         uint32_t i = path.index[d];
+         for (uint32_t j = 0; j < i; ++j) {
+            size_ -= destroy(in->children[j]);
+            in->keys()[j].~T();
+         }
+         relocate(in->keys() + i, in->count - 1 - i, in->keys());
+         std::copy(in->children + i, in->children + in->count, in->children);
+         in->count -= i;
+      }
+      Leaf* l = static_cast<Leaf*>(path.nodes[d]);
+      uint32_t i = path.index[d];
+      std::for_each(l->items(), l->items() + i, [](T& e) { e.~T(); });
+      relocate(l->items() + i, l->count - i, l->items());
+      l->count -= i;
+      size_ -= i;
+      l->prev = nullptr;
+      first_ = l;
+      if (size_ == 0)
+         clear();
+      else
+         mend(false);
+   }
+
+   template<typename GoesBefore>
+   void cut_back(GoesBefore goes_before) noexcept {
+      if (!root_)
+         return;
+      Path path;
+      descend(goes_before, path);
+      int d = 0;
+      for (; d < path.depth - 1; ++d) {
+         Inner* in = static_cast<Inner*>(path.nodes[d]);
+         uint32_t i = path.index[d];
+         for (uint32_t j = i + 1; j < in->count; ++j) {
+            size_ -= destroy(in->children[j]);
+            in->keys()[j - 1].~T();
+         }
+         in->count = i + 1;
+      }
+      Leaf* l = static_cast<Leaf*>(path.nodes[d]);
+      uint32_t i = path.index[d];
+      std::for_each(l->items() + i, l->items() + l->count,
+                    [](T& e) { e.~T(); });
+      size_ -= l->count - i;
+      l->count = i;
+      l->next = nullptr;
+      last_ = l;
+      if (size_ == 0)
+         clear();
+      else
+         mend(true);
+   }
+
+   // Zastąpienie zawartości drzewa tymi m elementami e, dla których
+   // keep(e) == true, w tym samym porządku, w węzłach wypełnianych
+   // równomiernie (bez porównań). Przy wyjątku (alokacja) drzewo się nie
+   // zmienia. [O(size())]
+   template<typename Keep>
+   void rebuild(Keep keep, size_t m) {
+      if (m == 0) {
+         clear();
+         return;
+      }
+      std::vector<Node*> level, upper;
+      std::vector<const T*> firsts, upper_firsts;
+      size_t adopted = 0;
+      Leaf* head = nullptr;
+      Leaf* prev = nullptr;
+      try {
+         size_t count = (m + leaf_capacity - 1) / leaf_capacity;
+         level.reserve(count);
+         firsts.reserve(count);
+         Cursor c = begin();
+         for (size_t i = 0; i < count; ++i) {
+            Leaf* l = create_leaf();
+            size_t fill = m / count + (i < m % count);
+            for (; l->count < fill; ++c)
+               if (keep(*c))
+                  new (l->items() + l->count++) T(*c);
+            l->prev = prev;
+            if (prev)
+               prev->next = l;
+            else
+               head = l;
+            prev = l;
+            level.push_back(l);
+            firsts.push_back(l->items());
+         }
+
+         // Kolejne poziomy węzłów wewnętrznych; separatorem dziecka jest
+         // kopia pierwszego elementu jego poddrzewa.
+         while (level.size() > 1) {
+            count = (level.size() + inner_capacity - 1) / inner_capacity;
+            upper.reserve(count);
+            upper_firsts.reserve(count);
+            adopted = 0;
+            for (size_t i = 0; i < count; ++i) {
+               Inner* in = create_inner();
+               size_t fill = level.size() / count + (i < level.size() % count);
+               upper_firsts.push_back(firsts[adopted]);
+               for (size_t j = 0; j < fill; ++j, ++adopted) {
+                  if (j > 0)
+                     new (in->keys() + j - 1) T(*firsts[adopted]);
+                  in->children[j] = level[adopted];
+               }
+               in->count = static_cast<uint32_t>(fill);
+               upper.push_back(in);
+            }
+            level.swap(upper);
+            firsts.swap(upper_firsts);
+            upper.clear();
+            upper_firsts.clear();
+            adopted = 0;
+         }
+      } catch (...) {
+         for (Node* n : upper)
+            destroy(n);
+         for (size_t i = adopted; i < level.size(); ++i)
+            destroy(level[i]);
+         throw;
+      }
+
+      clear();
+      root_ = level[0];
+      first_ = head;
+      last_ = prev;
+      size_ = m;
+   }
+
+   void clear() noexcept {
+      if (root_)
+         destroy(root_);
+      root_ = nullptr;
+      first_ = last_ = nullptr;
+      size_ = 0;
+   }
+
+   void swap(BPlusTree& tree) noexcept {
+      using std::swap;
+      swap(leaf_alloc, tree.leaf_alloc);
+      swap(inner_alloc, tree.inner_alloc);
+      swap(root_, tree.root_);
+      swap(first_, tree.first_);
+      swap(last_, tree.last_);
+      swap(size_, tree.size_);
+   }
+
+private:
+
+   // Przeniesienie elementów [from, from + n) do niezainicjowanej pamięci
+   // to (obszary mogą nachodzić na siebie, jeśli to < from).
+   static void relocate(T* from, size_t n, T* to) noexcept {
+      for (size_t i = 0; i < n; ++i) {
+         new (to + i) T(std::move(from[i]));
+         from[i].~T();
+      }
+   }
+
+   // Wstawienie x na pozycję pos tablicy n elementów (jest miejsce na n + 1).
+   static void insert_at(T* a, size_t n, size_t pos, T&& x) noexcept {
+      for (size_t i = n; i > pos; --i) {
+         new (a + i) T(std::move(a[i - 1]));
+         a[i - 1].~T();
+      }
+      new (a + pos) T(std::move(x));
+   }
+
+   static void erase_at(T* a, size_t n, size_t pos) noexcept {
+      a[pos].~T();
+      relocate(a + pos + 1, n - pos - 1, a + pos);
+   }
+
+   // Zejście od korzenia (niepustego drzewa) do pozycji za elementami,
+   // przed którymi nie leży szukany. [O(log size())]
+   template<typename GoesBefore>
+   void descend(GoesBefore goes_before, Path& path) const {
+      auto not_before = [&goes_before](const T& e) { return !goes_before(e); };
+      path.depth = 0;
+      Node* n = root_;
+      while (!n->leaf) {
+         Inner* in = static_cast<Inner*>(n);
+         uint32_t i = static_cast<uint32_t>(
+            std::partition_point(in->keys(), in->keys() + in->count - 1,
+                                 not_before) - in->keys());
+         path.nodes[path.depth] = n;
+         path.index[path.depth++] = i;
+         n = in->children[i];
+      }
+      Leaf* l = static_cast<Leaf*>(n);
+      path.nodes[path.depth] = n;
+      path.index[path.depth++] = static_cast<uint32_t>(
+         std::partition_point(l->items(), l->items() + l->count, not_before) -
+         l->items());
+   }
+
+   // Usunięcie elementu wskazanego ścieżką i przywrócenie zapełnienia
+   // węzłów: pożyczenie elementu od sąsiada albo scalenie z nim.
+   void erase(Path& path) noexcept {
+      int d = path.depth - 1;
+      Leaf* l = static_cast<Leaf*>(path.nodes[d]);
+      erase_at(l->items(), l->count, path.index[d]);
+      --l->count;
+      --size_;
+
+      Node* n = l;
+      for (; d > 0; --d) {
+         if (n->count >= (n->leaf ? leaf_min : inner_min))
+            break;
+         Inner* parent = static_cast<Inner*>(path.nodes[d - 1]);
+         uint32_t i = path.index[d - 1];
+         uint32_t min = n->leaf ? leaf_min : inner_min;
+         if (i > 0 && parent->children[i - 1]->count > min) {
+            borrow_left(parent, i);
+            break;
+         }
+         if (i + 1 < parent->count && parent->children[i + 1]->count > min) {
+            borrow_right(parent, i);
+            break;
+         }
+         merge_children(parent, i > 0 ? i - 1 : i);
+         n = parent;
+      }
+
+      if (root_->leaf) {
+         if (root_->count == 0) {
+            deallocate(static_cast<Leaf*>(root_));
+            root_ = nullptr;
+            first_ = last_ = nullptr;
+         }
+      } else if (root_->count == 1) {
+         Inner* old = static_cast<Inner*>(root_);
+         root_ = old->children[0];
+         deallocate(old);
+      }
+   }
+
+   // Przywrócenie zapełnienia węzłów na lewym (back == false) lub prawym
+   // skraju drzewa po cut_front/cut_back, od korzenia w dół: skrajne
+   // dziecko pożycza elementy od sąsiada albo jest z nim scalane. Węzeł
+   // wewnętrzny dostaje przy tym co najmniej inner_min + 1 dzieci, więc
+   // scalenie jego dziecka nie sprawi, że sam będzie niedopełniony.
+   void mend(bool back) noexcept {
+      Node* n = collapse_root();
+      while (!n->leaf) {
+         Inner* in = static_cast<Inner*>(n);
+         uint32_t i = back ? in->count - 1 : 0;
+         Node* c = in->children[i];
+         Node* s = in->children[back ? i - 1 : 1];
+         uint32_t min = c->leaf ? leaf_min : inner_min;
+         uint32_t target = c->leaf ? leaf_min : inner_min + 1;
+         while (c->count < target && s->count > min) {
+            if (back)
+               borrow_left(in, i);
+            else
+               borrow_right(in, i);
+         }
+         if (c->count < target) {
+            merge_children(in, back ? i - 1 : 0);
+            c = in->children[back ? in->count - 1 : 0];
+         }
+         n = c;
+      }
+      collapse_root();
+   }
+
+   // Zastąpienie korzenia o jednym dziecku tym dzieckiem; zwraca korzeń.
+   Node* collapse_root() noexcept {
+      while (!root_->leaf && root_->count == 1) {
+         Inner* old = static_cast<Inner*>(root_);
+         root_ = old->children[0];
+         deallocate(old);
+      }
+      return root_;
+   }
+
+   // Przeniesienie ostatniego elementu lewego sąsiada do dziecka i.
+   void borrow_left(Inner* parent, uint32_t i) noexcept {
+      Node* n = parent->children[i];
+      Node* s = parent->children[i - 1];
+      if (n->leaf) {
+         Leaf* l = static_cast<Leaf*>(n);
+         Leaf* left = static_cast<Leaf*>(s);
+         insert_at(l->items(), l->count, 0,
+                   std::move(left->items()[left->count - 1]));
+         left->items()[left->count - 1].~T();
+         parent->keys()[i - 1] = T(l->items()[0]);
+      } else {
+         Inner* in = static_cast<Inner*>(n);
+         Inner* left = static_cast<Inner*>(s);
+         insert_at(in->keys(), in->count - 1, 0,
+                   std::move(parent->keys()[i - 1]));
+         std::copy_backward(in->children, in->children + in->count,
+                            in->children + in->count + 1);
+         in->children[0] = left->children[left->count - 1];
+         parent->keys()[i - 1] = std::move(left->keys()[left->count - 2]);
+         left->keys()[left->count - 2].~T();
+      }
+      ++n->count;
+      --s->count;
+   }
+
+   // Przeniesienie pierwszego elementu prawego sąsiada do dziecka i.
+   void borrow_right(Inner* parent, uint32_t i) noexcept {
+      Node* n = parent->children[i];
+      Node* s = parent->children[i + 1];
+      if (n->leaf) {
+         Leaf* l = static_cast<Leaf*>(n);
+         Leaf* right = static_cast<Leaf*>(s);
+         new (l->items() + l->count) T(std::move(right->items()[0]));
+         erase_at(right->items(), right->count, 0);
+         parent->keys()[i] = T(right->items()[0]);
+      } else {
+         Inner* in = static_cast<Inner*>(n);
+         Inner* right = static_cast<Inner*>(s);
+         new (in->keys() + in->count - 1) T(std::move(parent->keys()[i]));
+         in->children[in->count] = right->children[0];
+         parent->keys()[i] = std::move(right->keys()[0]);
+         erase_at(right->keys(), right->count - 1, 0);
+         std::copy(right->children + 1, right->children + right->count,
+                   right->children);
+      }
+      ++n->count;
+      --s->count;
+   }
+
+   // Scalenie dzieci j i j + 1 rodzica parent w dziecku j.
+   void merge_children(Inner* parent, uint32_t j) noexcept {
+      Node* left = parent->children[j];
+      Node* right = parent->children[j + 1];
+      if (left->leaf) {
+         Leaf* l = static_cast<Leaf*>(left);
+         Leaf* r = static_cast<Leaf*>(right);
+         relocate(r->items(), r->count, l->items() + l->count);
+         l->next = r->next;
+         if (r->next)
+            r->next->prev = l;
+         else
+            last_ = l;
+         l->count += r->count;
+         deallocate(r);
+      } else {
+         Inner* l = static_cast<Inner*>(left);
+         Inner* r = static_cast<Inner*>(right);
+         new (l->keys() + l->count - 1) T(std::move(parent->keys()[j]));
+         relocate(r->keys(), r->count - 1, l->keys() + l->count);
+         std::copy(r->children, r->children + r->count,
+                   l->children + l->count);
+         l->count += r->count;
+         deallocate(r);
+      }
+      erase_at(parent->keys(), parent->count - 1, j);
+      std::copy(parent->children + j + 2, parent->children + parent->count,
+                parent->children + j + 1);
+      --parent->count;
+   }
+
+   Leaf* create_leaf() {
+      Leaf* l = leaf_traits_t::allocate(leaf_alloc, 1);
+      return new (l) Leaf;
+   }
+
+   Inner* create_inner() {
+      Inner* in = inner_traits_t::allocate(inner_alloc, 1);
+      return new (in) Inner;
+   }
+
+   // Zwolnienie pamięci węzła, którego elementy zostały już zniszczone
+   // lub przeniesione.
+   void deallocate(Leaf* l) noexcept {
+      leaf_traits_t::deallocate(leaf_alloc, l, 1);
+   }
+
+   void deallocate(Inner* in) noexcept {
+      inner_traits_t::deallocate(inner_alloc, in, 1);
+   }
+
+   // Zniszczenie poddrzewa razem z elementami; zwraca liczbę elementów
+   // w jego liściach. [O(rozmiar poddrzewa)]
+   size_t destroy(Node* n) noexcept {
+      if (n->leaf) {
+         Leaf* l = static_cast<Leaf*>(n);
+         size_t result = l->count;
+         std::for_each(l->items(), l->items() + l->count, [](T& e) {
+            e.~T();
+         });
+         deallocate(l);
+         return result;
+      }
+      Inner* in = static_cast<Inner*>(n);
+      size_t result = 0;
+      for (uint32_t i = 0; i < in->count; ++i)
+         result += destroy(in->children[i]);
+      std::for_each(in->keys(), in->keys() + in->count - 1, [](T& e) {
+         e.~T();
+      });
+      deallocate(in);
+      return result;
+   }
+
+   // Kopia poddrzewa n; liście kopii są dopinane za last. Przy wyjątku
+   // (alokacja) utworzona część poddrzewa jest niszczona.
+   Node* clone(const Node* n, Leaf*& last) {
+      if (n->leaf) {
+         const Leaf* source = static_cast<const Leaf*>(n);
+         Leaf* l = create_leaf();
+         std::uninitialized_copy(source->items(),
+                                 source->items() + source->count, l->items());
+         l->count = source->count;
+         l->prev = last;
+         if (last)
+            last->next = l;
+         else
+            first_ = l;
+         last = l;
+         return l;
+      }
+      const Inner* source = static_cast<const Inner*>(n);
+      Inner* in = create_inner();
+      try {
+         for (uint32_t i = 0; i < source->count; ++i) {
+            Node* child = clone(source->children[i], last);
+            if (i > 0)
+               new (in->keys() + i - 1) T(source->keys()[i - 1]);
+            in->children[i] = child;
+            ++in->count;
+         }
+      } catch (...) {
+         destroy(in);
+         throw;
+      }
+      return in;
+   }
+
+   leaf_allocator_t leaf_alloc;
+   inner_allocator_t inner_alloc;
+   Node* root_ = nullptr;
+   Leaf* first_ = nullptr;
+   Leaf* last_ = nullptr;
+   size_t size_ = 0;
+};
+
+} // namespace pq_detail
+
+struct BTreeBackend {};
+
+template<typename K, typename V, typename Allocator>
+class PriorityQueue<K, V, Allocator, BTreeBackend> {
+
+   static_assert(std::is_nothrow_copy_constructible<K>::value &&
+                 std::is_nothrow_move_constructible<K>::value &&
+                 std::is_nothrow_move_assignable<K>::value &&
+                 std::is_nothrow_copy_constructible<V>::value &&
+                 std::is_nothrow_move_constructible<V>::value &&
+                 std::is_nothrow_move_assignable<V>::value,
+                 "BTreeBackend: K i V muszą być kopiowane i przenoszone "
+                 "no-throw");
+
+   static_assert(pq_detail::is_nothrow_less<K>::value &&
+                 pq_detail::is_nothrow_less<V>::value,
+                 "BTreeBackend: porównania K i V muszą być no-throw");
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using allocator_type = Allocator;
+
+   /**
+    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
+    */
+   PriorityQueue() {}
+
+   explicit PriorityQueue(const Allocator& alloc)
+      : by_key(alloc), by_value(alloc) {}
+
+   /**
+    * Konstruktor kopiujący - kopiuje węzły obu drzew bez porównań
+    * [O(queue.size())], przenoszący [O(1)] i operator przypisania
+    * (kopiowanie i zamiana).
+    */
+   PriorityQueue(const PriorityQueue& queue)
+      : by_key(queue.by_key), by_value(queue.by_value),
+        next_seq(queue.next_seq) {}
+
+   PriorityQueue(PriorityQueue&& queue)
+      : by_key(queue.by_key.get_allocator()),
+        by_value(queue.by_value.get_allocator()) {
+      swap(queue);
+   }
+
+   PriorityQueue& operator=(PriorityQueue queue) {
+      queue.swap(*this);
+      return *this;
+   }
+
+   allocator_type get_allocator() const {
+      return by_key.get_allocator();
+   }
+
+   bool empty() const {
+      return by_value.empty();
+   }
+
+   size_type size() const {
+      return by_value.size();
+   }
+
+   /**
+    * Metody wstawiające parę do kolejki. [O(log size())]
+    */
+   void insert(const K& key, const V& value) {
+      insert_pair(key, value);
+   }
+
+   void insert(K&& key, V&& value) {
+      insert_pair(std::move(key), std::move(value));
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      // Konstrukcja K i V może zgłosić wyjątek - przed zmianą kolejki.
+      K k(std::forward<KK>(key));
+      V v(std::forward<VV>(value));
+      insert_pair(std::move(k), std::move(v));
+   }
+
+   /**
+    * Najmniejsza i największa wartość oraz ich klucze [O(1)]; dla pustej
+    * kolejki zgłaszają wyjątek PriorityQueueEmptyException.
+    */
+   const V& minValue() const {
+      return min_entry().value;
+   }
+
+   const V& maxValue() const {
+      return max_entry().value;
+   }
+
+   const K& minKey() const {
+      return min_entry().key;
+   }
+
+   const K& maxKey() const {
+      return max_entry().key;
+   }
+
+   /**
+    * Usunięcie pary o najmniejszej lub największej wartości. [O(log size())]
+    */
+   void deleteMin() {
+      if (!empty())
+         erase_min();
+   }
+
+   void deleteMax() {
+      if (!empty())
+         erase_max();
+   }
+
+   /**
+    * Usunięcie i zwrócenie pary o najmniejszej lub największej wartości
+    * [O(log size())]; wersje try zwracają std::nullopt dla pustej kolejki.
+    */
+   std::pair<K, V> popMin() {
+      const Entry& e = min_entry();
+      std::pair<K, V> result(e.key, e.value);
+      erase_min();
+      return result;
+   }
+
+   std::pair<K, V> popMax() {
+      const Entry& e = max_entry();
+      std::pair<K, V> result(e.key, e.value);
+      erase_max();
+      return result;
+   }
+
+   std::optional<std::pair<K, V>> tryPopMin() {
+      if (empty())
+         return std::nullopt;
+      return popMin();
+   }
+
+   std::optional<std::pair<K, V>> tryPopMax() {
+      if (empty())
+         return std::nullopt;
+      return popMax();
+   }
+
+   /**
+    * Usunięcie (co najwyżej) n par o najmniejszych lub największych
+    * wartościach i zapisanie ich do out w kolejności usuwania; zwraca
+    * iterator za ostatnią zapisaną parą. Pary są czytane kolejno z liści
+    * indeksu wartości, które potem są odcinane w całości; z indeksu kluczy
+    * pary są usuwane pojedynczo albo - gdy wyjmowane pary to większość
+    * kolejki - indeks jest budowany od nowa z pozostałych. Jeśli zapis do
+    * out zgłosi wyjątek, para zapisywana i dalsze zostają w kolejce.
+    * [O(n + log size() + min(n log size(), size()))]
+    */
+   template<typename OutputIt>
+   OutputIt extractMin(size_type n, OutputIt out) {
+      return extract_range(n, std::move(out), false);
+   }
+
+   template<typename OutputIt>
+   OutputIt extractMax(size_type n, OutputIt out) {
+      return extract_range(n, std::move(out), true);
+   }
+
+   /**
+    * Zmiana wartości pary o kluczu key (przy kilku takich parach - pary
+    * o najmniejszej wartości) na value [O(log size())]; gdy klucza nie ma
+    * w kolejce, zgłasza wyjątek PriorityQueueNotFoundException.
+    */
+   void changeValue(const K& key, const V& value) {
+      typename key_tree_t::Cursor c = find_key(key);
+      if (!c)
+         throw PriorityQueueNotFoundException();
+      Entry old = *c;
+      // Nowa para jest wstawiana (alokacje przed zmianą), a stara usuwana
+      // dopiero potem; usuwanie nie zgłasza wyjątków.
+      insert_pair(key, value);
+      by_key.erase(key_before(old));
+      by_value.erase(value_before(old));
+   }
+
+   /**
+    * Czy w kolejce jest para o kluczu key i liczba takich par (czytanych
+    * kolejno z liści indeksu kluczy). [O(log size()), O(log size() + wynik)]
+    */
+   bool contains(const K& key) const {
+      return static_cast<bool>(find_key(key));
+   }
+
+   size_type count(const K& key) const {
+      size_type result = 0;
+      for (typename key_tree_t::Cursor c = find_key(key);
+           c && !(key < c->key); ++c)
+         ++result;
+      return result;
+   }
+
+   /**
+    * Usunięcie pary o kluczu key (spośród kilku - tej o najmniejszej
+    * wartości, jak changeValue); zwraca false, jeśli takiej pary nie ma.
+    * [O(log size())]
+    */
+   bool eraseKey(const K& key) {
+      typename key_tree_t::Cursor c = find_key(key);
+      if (!c)
+         return false;
+      erase_entry(*c);
+      return true;
+   }
+
+   /**
+    * Usunięcie wszystkich par o kluczu key; zwraca ich liczbę.
+    * [O(log size() + wynik * log size())]
+    */
+   size_type eraseAll(const K& key) {
+      size_type result = 0;
+      for (typename key_tree_t::Cursor c = find_key(key); c;
+           c = find_key(key), ++result)
+         erase_entry(*c);
+      return result;
+   }
+
+   /**
+    * Scalenie z kolejką queue, która zostaje opróżniona; pary queue są
+    * wstawiane w porządku wartości, a przy wyjątku (alokacja) wstawione
+    * już pary są usuwane. [O(queue.size() * log (queue.size() + size()))]
+    */
+   void merge(PriorityQueue& queue) {
+      if (this == &queue)
+         return;
+      uint64_t first_seq = next_seq;
+      size_type inserted = 0;
+      try {
+         for (auto c = queue.by_value.begin(); c; ++c, ++inserted)
+            insert_pair(c->key, c->value);
+      } catch (...) {
+         auto c = queue.by_value.begin();
+         for (size_type i = 0; i < inserted; ++i, ++c) {
+            Entry e{c->key, c->value, first_seq + i};
+            by_key.erase(key_before(e));
+            by_value.erase(value_before(e));
+         }
+         throw;
+      }
+      queue.by_key.clear();
+      queue.by_value.clear();
+   }
+
+   /**
+    * Zamiana zawartości z kolejką queue. [O(1)]
+    */
+   void swap(PriorityQueue& queue) noexcept {
+      by_key.swap(queue.by_key);
+      by_value.swap(queue.by_value);
+      std::swap(next_seq, queue.next_seq);
+   }
+
+   /**
+    * Równość zbiorów par (klucz, wartość): jedno przejście po liściach obu
+    * indeksów kluczy. [O(size())]
+    */
+   bool operator==(const PriorityQueue& queue) const {
+      if (size() != queue.size())
+         return false;
+      for (auto lhs = by_key.begin(), rhs = queue.by_key.begin(); lhs;
+           ++lhs, ++rhs)
+         if (!(lhs->key == rhs->key) || !(lhs->value == rhs->value))
+            return false;
+      return true;
+   }
+
+   bool operator!=(const PriorityQueue& queue) const {
+      return !(*this == queue);
+   }
+
+   /**
+    * Porządek jak w domyślnej strategii: kolejne grupy par o równym kluczu
+    * porównywane najpierw po kluczu, potem po liczności (liczniejsza jest
+    * mniejsza), a na końcu po wartościach. Indeks kluczy jest uporządkowany
+    * po (klucz, wartość), więc wystarcza jedno przejście po liściach obu
+    * indeksów. [O(size())]
+    */
+   bool operator<(const PriorityQueue& queue) const {
+      auto lhs = by_key.begin(), rhs = queue.by_key.begin();
+      while (lhs && rhs) {
+         if (!(lhs->key == rhs->key))
+            return lhs->key < rhs->key;
+         // Grupy przechodzimy równolegle; pierwsza różnica wartości
+         // rozstrzyga dopiero wtedy, gdy grupy są równoliczne.
+         const K& key = lhs->key;
+         int values = 0;
+         for (;;) {
+            bool lhs_in = lhs && lhs->key == key;
+            bool rhs_in = rhs && rhs->key == key;
+            if (lhs_in != rhs_in)
+               return lhs_in;
+            if (!lhs_in)
+               break;
+            if (values == 0 && !(lhs->value == rhs->value))
+               values = lhs->value < rhs->value ? -1 : 1;
+            ++lhs;
+            ++rhs;
+         }
+         if (values != 0)
+            return values < 0;
+      }
+      return !lhs && rhs;
+   }
+
+   bool operator>(const PriorityQueue& queue) const {
+      return queue < *this;
+   }
+
+   bool operator<=(const PriorityQueue& queue) const {
+      return !(queue < *this);
+   }
+
+   bool operator>=(const PriorityQueue& queue) const {
+      return !(*this < queue);
+   }
+
+private:
+
+   // Kopia pary w jednym z indeksów; seq to numer wstawienia.
+   struct Entry {
+      K key;
+      V value;
+      uint64_t seq;
+   };
+
+   using key_tree_t = pq_detail::BPlusTree<Entry, Allocator>;
+   using value_tree_t = pq_detail::BPlusTree<Entry, Allocator>;
+
+   // Porządek indeksu kluczy: (klucz, wartość, numer wstawienia).
+   static auto key_before(const K& key, const V& value, uint64_t seq) {
+      return [&key, &value, seq](const Entry& e) {
+         return key < e.key ||
+                (!(e.key < key) &&
+                 (value < e.value || (!(e.value < value) && seq < e.seq)));
+      };
+   }
+
+   static auto key_before(const Entry& x) {
+      return key_before(x.key, x.value, x.seq);
+   }
+
+   // Porządek indeksu wartości: (wartość, numer wstawienia).
+   static auto value_before(const V& value, uint64_t seq) {
+      return [&value, seq](const Entry& e) {
+         return value < e.value || (!(e.value < value) && seq < e.seq);
+      };
+   }
+
+   static auto value_before(const Entry& x) {
+      return value_before(x.value, x.seq);
+   }
+
+   const Entry& min_entry() const {
+      if (empty())
+         throw PriorityQueueEmptyException();
+      return by_value.first();
+   }
+
+   const Entry& max_entry() const {
+      if (empty())
+         throw PriorityQueueEmptyException();
+      return by_value.last();
+   }
+
+   // Pierwsza para o kluczu key w indeksie kluczy lub pusty kursor.
+   typename key_tree_t::Cursor find_key(const K& key) const {
+      typename key_tree_t::Cursor c =
+         by_key.lower_bound([&key](const Entry& e) { return e.key < key; });
+      if (c && key < c->key)
+         return typename key_tree_t::Cursor();
+      return c;
+   }
+
+   // Wstawienie pary: przygotowanie obu indeksów (wyszukiwanie i alokacje),
+   // a potem zmiany, które nie zgłaszają wyjątków.
+   template<typename KK, typename VV>
+   void insert_pair(KK&& key, VV&& value) {
+      typename key_tree_t::Insertion key_ins(
+         by_key, key_before(key, value, next_seq));
+      typename value_tree_t::Insertion value_ins(
+         by_value, value_before(value, next_seq));
+      // Od tego miejsca nic nie zgłasza wyjątku. Obie kopie powstają przed
+      // zmianą drzew, bo key i value mogą wskazywać na element kolejki.
+      Entry key_entry{key, value, next_seq};
+      Entry value_entry{std::forward<KK>(key), std::forward<VV>(value),
+                        next_seq};
+      by_key.insert(key_ins, std::move(key_entry));
+      by_value.insert(value_ins, std::move(value_entry));
+      ++next_seq;
+   }
+
+   // Usunięcie pary z obu indeksów; e jest kopiowana, bo może wskazywać
+   // na element indeksu kluczy.
+   void erase_entry(const Entry& e) noexcept {
+      Entry old = e;
+      by_key.erase(key_before(old));
+      by_value.erase(value_before(old));
+   }
+
+   template<typename OutputIt>
+   OutputIt extract_range(size_type n, OutputIt out, bool max) {
+      n = std::min(n, size());
+      size_type written = 0;
+      try {
+         auto c = max ? by_value.before_end() : by_value.begin();
+         for (; written < n; ++written) {
+            *out = std::pair<K, V>(c->key, c->value);
+            ++out;
+            if (max)
+               --c;
+            else
+               ++c;
+         }
+      } catch (...) {
+         erase_edge(written, max);
+         throw;
+      }
+      erase_edge(n, max);
+      return out;
+   }
+
+   // Usunięcie n par o najmniejszych (max == false) lub największych
+   // wartościach.
+   void erase_edge(size_type n, bool max) noexcept {
+      if (n == 0)
+         return;
+      if (n == size()) {
+         by_key.clear();
+         by_value.clear();
+         return;
+      }
+      auto edge = [this, max] {
+         return max ? by_value.before_end() : by_value.begin();
+      };
+      auto step = [max](auto& c) {
+         if (max)
+            --c;
+         else
+            ++c;
+      };
+      // Indeks kluczy zmieniamy przed indeksem wartości, bo usuwanie
+      // pojedynczych par potrzebuje jego elementów.
+      bool rebuild = rebuild_cheaper(n, size() - n);
+      auto c = edge();
+      for (size_type i = 0; ; step(c)) {
+         if (!rebuild)
+            by_key.erase(key_before(*c));
+         if (++i == n)
+            break;
+      }
+      // Ostatnia usuwana para wyznacza granicę cięcia i rozstrzyga, które
+      // pary zostają w przebudowanym indeksie kluczy.
+      Entry bound = *c;
+      if (rebuild) {
+         auto kept = [&bound, max](const Entry& e) {
+            return max ? value_before(e)(bound) : value_before(bound)(e);
+         };
+         try {
+            by_key.rebuild(kept, size() - n);
+         } catch (...) {
+            // Brak pamięci na nowe węzły - usuwamy pary pojedynczo.
+            c = edge();
+            for (size_type i = 0; i < n; ++i, step(c))
+               by_key.erase(key_before(*c));
+         }
+      }
+      if (max)
+         by_value.cut_back([&bound](const Entry& e) {
+            return !value_before(e)(bound);
+         });
+      else
+         by_value.cut_front(value_before(bound));
+   }
+
+   // Czy przebudowa indeksu kluczy z m pozostałych par jest tańsza niż n
+   // usunięć. Przebudowa kosztowała w pomiarach (bench/extract.cc, 10^6
+   // par int) ok. 10 ns na pozostałą parę, a usunięcie klucza z drzewa
+   // spoza pamięci podręcznej - kilkaset ns.
+   static bool rebuild_cheaper(size_type n, size_type m) {
+      return 32 * n >= m;
+   }
+
+   void erase_min() noexcept {
+      by_key.erase(key_before(by_value.first()));
+      by_value.erase_first();
+   }
+
+   void erase_max() noexcept {
+      by_key.erase(key_before(by_value.last()));
+      by_value.erase_last();
+   }
+
+   key_tree_t by_key;
+   value_tree_t by_value;
+   uint64_t next_seq = 0;
+};
+
+#endif /* __BTREEQUEUE_HH__ */
@@ -0,0 +1,455 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* DeadlineQueue: kolejka zegarów (klucz - identyfikator, wartość - termin    */
+/* w taktach typu Time) dla obciążeń, w których zegary są głównie wstawiane   */
+/* i anulowane, a rzadko dochodzą do terminu. Bliskie terminy trafiają do     */
+/* hierarchicznego koła czasu: levels poziomów po 2^slot_bits szczelin,       */
+/* szczelina to lista dwukierunkowa, więc wstawienie i anulowanie działają    */
+/* w O(1). Poziom zegara to najstarsza grupa slot_bits bitów, w której jego   */
+/* termin różni się od bieżącego czasu; gdy czas dojdzie do początku          */
+/* szczeliny wyższego poziomu, jej zegary są rozkładane na niższe poziomy     */
+/* (każdy zegar najwyżej levels razy). Terminy dalsze niż horyzont koła       */
+/* (2^(levels * slot_bits) taktów) czekają w PriorityQueue<węzeł, Time>       */
+/* i przechodzą do koła, gdy czas wejdzie w ich okno.                         */
+/*                                                                            */
+/* advanceTo przesuwa czas skokami między niepustymi szczelinami (mapy        */
+/* zajętości), więc koszt nie zależy od długości skoku, i wywołuje funkcję    */
+/* zwrotną dla zegarów w kolejności terminów; kolejność zegarów o równym      */
+/* terminie jest nieokreślona.                                                */
+/*============================================================================*/
+
+#ifndef __DEADLINEQUEUE_HH__
+#define __DEADLINEQUEUE_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "priorityqueue.hh"
+
+namespace pq_detail {
+
+// Element cyklicznej listy dwukierunkowej; szczelina koła jest wartownikiem.
+struct WheelLink {
+   WheelLink* prev = this;
+   WheelLink* next = this;
+
+   bool empty() const noexcept {
+      return next == this;
+   }
+
+   // Podpięcie link na końcu listy. [O(1)]
+   void push_back(WheelLink* link) noexcept {
+      link->prev = prev;
+      link->next = this;
+      prev->next = link;
+      prev = link;
+   }
+
+   // Odpięcie elementu z jego listy. [O(1)]
+   void unlink() noexcept {
+      prev->next = next;
+      next->prev = prev;
+      prev = next = this;
+   }
+
+   // Przeniesienie wszystkich elementów listy list na koniec tej listy.
+   // [O(1)]
+   void splice(WheelLink& list) noexcept {
+      if (list.empty())
+         return;
+      list.next->prev = prev;
+      list.prev->next = this;
+      prev->next = list.next;
+      prev = list.prev;
+      list.prev = list.next = &list;
+   }
+};
+
+} // namespace pq_detail
+
+template<typename K, typename Time = uint64_t,
+         typename Allocator = std::allocator<std::pair<const K, Time>>>
+class DeadlineQueue {
+
+   static_assert(std::is_unsigned<Time>::value && sizeof(Time) <= 8,
+                 "DeadlineQueue: Time musi być typem całkowitym bez znaku");
+
+   struct Node;
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using time_type = Time;
+
+   // Parametry koła: levels poziomów po 2^slot_bits szczelin.
+   static constexpr unsigned slot_bits = 8;
+   static constexpr unsigned levels = 4;
+
+   /**
+    * Uchwyt do zegara. Pozostaje ważny, dopóki zegar nie zostanie anulowany
+    * lub nie dojdzie do terminu (od wywołania funkcji zwrotnej advanceTo dla
+    * tego zegara). Domyślnie skonstruowany uchwyt nie wskazuje zegara.
+    */
+   class handle_type {
+
+   public:
+
+      handle_type() {}
+
+      bool operator==(const handle_type& handle) const {
+         return node == handle.node;
+      }
+
+      bool operator!=(const handle_type& handle) const {
+         return node != handle.node;
+      }
+
+   private:
+
+      friend class DeadlineQueue<K, Time, Allocator>;
+
+      explicit handle_type(Node* n) : node(n) {}
+
+      Node* node = nullptr;
+   };
+
+   /**
+    * Konstruktor tworzący pustą kolejkę z bieżącym czasem now. [O(1)]
+    */
+   explicit DeadlineQueue(Time now = Time(),
+                          const Allocator& alloc = Allocator())
+      : alloc(alloc), overflow(overflow_allocator_t(alloc)), current(now) {}
+
+   DeadlineQueue(const DeadlineQueue&) = delete;
+
+   DeadlineQueue& operator=(const DeadlineQueue&) = delete;
+
+   ~DeadlineQueue() {
+      for (auto& level : wheel)
+         for (pq_detail::WheelLink& slot : level)
+            while (!slot.empty()) {
+               Node* n = static_cast<Node*>(slot.next);
+               n->unlink();
+               destroy_node(n);
+            }
+      for (auto it = overflow.begin(); it != overflow.end(); ++it)
+         destroy_node(it.key());
+   }
+
+   size_type size() const {
+      return counter;
+   }
+
+   bool empty() const {
+      return counter == 0;
+   }
+
+   /**
+    * Bieżący czas (ostatni argument advanceTo). [O(1)]
+    */
+   Time now() const {
+      return current;
+   }
+
+   /**
+    * Metody wstawiające zegar key z terminem deadline; termin nie późniejszy
+    * niż now() oznacza zegar wywoływany przy najbliższym advanceTo.
+    * [O(1), poza horyzontem koła O(log size())]
+    */
+   handle_type insert(const K& key, Time deadline) {
+      return insert_node(create_node(key, deadline));
+   }
+
+   handle_type insert(K&& key, Time deadline) {
+      return insert_node(create_node(std::move(key), deadline));
+   }
+
+   /**
+    * Metoda anulująca zegar wskazany uchwytem handle.
+    * [O(1), poza horyzontem koła O(log size())]
+    */
+   void cancel(handle_type handle) {
+      Node* n = handle.node;
+      assert(n);
+      detach(n);
+      destroy_node(n);
+      --counter;
+   }
+
+   /**
+    * Metoda zmieniająca termin zegara wskazanego uchwytem handle; uchwyt
+    * pozostaje ważny. Przy wyjątku (alokacja poza horyzontem) zegar
+    * zachowuje dawny termin. [O(1), poza horyzontem koła O(log size())]
+    */
+   void reschedule(handle_type handle, Time deadline) {
+      Node* n = handle.node;
+      assert(n);
+      if (level_of(deadline) < levels) {
+         detach(n);
+         n->deadline = deadline;
+         link(n);
+      } else if (n->level == levels) {
+         n->overflow = overflow.update(n->overflow, deadline);
+         n->deadline = deadline;
+      } else {
+         n->overflow = overflow.insert(n, deadline);
+         detach(n);
+         n->level = levels;
+         n->deadline = deadline;
+      }
+   }
+
+   /**
+    * Metody zwracające klucz i termin zegara wskazanego uchwytem. [O(1)]
+    */
+   const K& key(handle_type handle) const {
+      assert(handle.node);
+      return handle.node->key;
+   }
+
+   Time deadline(handle_type handle) const {
+      assert(handle.node);
+      return handle.node->deadline;
+   }
+
+   /**
+    * Metoda przesuwająca czas do now i wywołująca callback(key, deadline)
+    * dla każdego zegara o terminie nie późniejszym niż now, w kolejności
+    * terminów; zwraca liczbę wywołań. Funkcja zwrotna może wstawiać
+    * i anulować inne zegary (zegar z terminem nie późniejszym niż now
+    * zostanie wywołany w tym samym advanceTo). Jeśli zgłosi wyjątek, jej
+    * zegar jest usunięty, pozostałe zegary zostają w kolejce, a now()
+    * zatrzymuje się na terminie tego zegara. Czas nie cofa się: now < now()
+    * działa jak now().
+    * [O(k + s) dla k wywołań i s odwiedzonych szczelin, co najwyżej
+    * levels * 2^slot_bits między zmianami najstarszej grupy bitów]
+    */
+   template<typename F>
+   size_type advanceTo(Time now, F callback) {
+      if (now < current)
+         now = current;
+      size_type fired = 0;
+      Time next;
+      while (next_event(next) && next <= now) {
+         current = next;
+         migrate();
+         cascade();
+         fired += expire(callback);
+      }
+      current = now;
+      return fired;
+   }
+
+private:
+
+   static constexpr size_t slots = size_t(1) << slot_bits;
+   static constexpr uint64_t slot_mask = slots - 1;
+   static constexpr size_t words = (slots + 63) / 64;
+
+   using overflow_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<std::pair<Node* const, Time>>;
+   using overflow_t = PriorityQueue<Node*, Time, overflow_allocator_t>;
+
+   // Zegar: w szczelinie koła (level < levels) albo w overflow.
+   struct Node: pq_detail::WheelLink {
+      template<typename KK>
+      Node(KK&& key, Time deadline)
+         : key(std::forward<KK>(key)), deadline(deadline) {}
+
+      K key;
+      Time deadline;
+      typename overflow_t::handle_type overflow;
+      unsigned level = 0;
+      size_t slot = 0;
+   };
+
+   using node_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<Node>;
+   using node_traits_t = std::allocator_traits<node_allocator_t>;
+
+   template<typename KK>
+   Node* create_node(KK&& key, Time deadline) {
+      Node* n = node_traits_t::allocate(alloc, 1);
+      try {
+         node_traits_t::construct(alloc, n, std::forward<KK>(key), deadline);
+      } catch (...) {
+         node_traits_t::deallocate(alloc, n, 1);
+         throw;
+      }
+      return n;
+   }
+
+   void destroy_node(Node* n) {
+      node_traits_t::destroy(alloc, n);
+      node_traits_t::deallocate(alloc, n, 1);
+   }
+
+   handle_type insert_node(Node* n) {
+      if (level_of(n->deadline) < levels) {
+         link(n); // O(1)
+      } else {
+         try {
+            n->overflow = overflow.insert(n, n->deadline); // O(log size())
+         } catch (...) {
+            destroy_node(n);
+            throw;
+         }
+         n->level = levels;
+      }
+      ++counter;
+      return handle_type(n);
+   }
+
+   // Cyfra (grupa slot_bits bitów) numer level czasu t.
+   static size_t digit(uint64_t t, unsigned level) {
+      return static_cast<size_t>((t >> (level * slot_bits)) & slot_mask);
+   }
+
+   // Poziom terminu względem bieżącego czasu (levels - poza horyzontem).
+   unsigned level_of(Time deadline) const {
+      uint64_t diff = deadline < current ? 0 : uint64_t(deadline ^ current);
+      unsigned level = 0;
+      while (level < levels && (diff >> ((level + 1) * slot_bits)) != 0)
+         ++level;
+      return level;
+   }
+
+   // Podpięcie zegara z terminem w horyzoncie do jego szczeliny (no-throw).
+   void link(Node* n) {
+      Time t = n->deadline < current ? current : n->deadline;
+      n->level = level_of(t);
+      n->slot = digit(t, n->level);
+      wheel[n->level][n->slot].push_back(n);
+      occupied[n->level][n->slot / 64] |= uint64_t(1) << (n->slot % 64);
+   }
+
+   // Odpięcie zegara z koła lub z overflow.
+   void detach(Node* n) {
+      if (n->level == levels) {
+         overflow.erase(n->overflow); // O(log size())
+         return;
+      }
+      n->unlink();
+      if (wheel[n->level][n->slot].empty())
+         occupied[n->level][n->slot / 64] &= ~(uint64_t(1) << (n->slot % 64));
+   }
+
+   // Pierwsza zajęta szczelina poziomu level o numerze co najmniej from.
+   bool find_slot(unsigned level, size_t from, size_t& slot) const {
+      for (size_t w = from / 64; w < words && from < slots; ++w) {
+         uint64_t bits = occupied[level][w];
+         if (w == from / 64)
+            bits &= ~uint64_t(0) << (from % 64);
+         if (bits) {
+            slot = w * 64 + __builtin_ctzll(bits);
+            return true;
+         }
+      }
+      return false;
+   }
+
+   // Najbliższa chwila, w której coś się dzieje: zegary poziomu 0 dochodzą
+   // do terminu, szczelina wyższego poziomu jest rozkładana albo zegar
+   // z overflow wchodzi w horyzont.
+   bool next_event(Time& next) const {
+      bool found = false;
+      auto consider = [&](uint64_t t) {
+         if (!found || t < next)
+            next = static_cast<Time>(t);
+         found = true;
+      };
+      const uint64_t now = current;
+      size_t slot;
+      if (find_slot(0, digit(now, 0), slot))
+         consider((now & ~slot_mask) | slot);
+      for (unsigned level = 1; level < levels; ++level) {
+         if (!find_slot(level, digit(now, level) + 1, slot))
+            continue;
+         unsigned shift = (level + 1) * slot_bits;
+         uint64_t high = shift < 64 ? now >> shift << shift : 0;
+         consider(high | (uint64_t(slot) << (level * slot_bits)));
+      }
+      if (!overflow.empty()) {
+         const unsigned shift = levels * slot_bits;
+         uint64_t window = uint64_t(overflow.minValue()) >> shift << shift;
+         consider(window > now ? window : now);
+      }
+      return found;
+   }
+
+   // Przeniesienie zegarów z overflow, które weszły w horyzont koła.
+   void migrate() {
+      while (!overflow.empty() && level_of(overflow.minValue()) < levels) {
+         Node* n = overflow.minKey();
+         overflow.deleteMin(); // O(log size())
+         link(n);
+      }
+   }
+
+   // Rozłożenie szczelin wyższych poziomów, do których początku doszedł
+   // czas, od najwyższego poziomu (zegary mogą trafić do szczeliny
+   // bieżącej na niższym poziomie).
+   void cascade() {
+      const uint64_t now = current;
+      for (unsigned level = levels - 1; level > 0; --level) {
+         if ((now & ((uint64_t(1) << (level * slot_bits)) - 1)) != 0)
+            continue;
+         size_t slot = digit(now, level);
+         pq_detail::WheelLink pending;
+         pending.splice(wheel[level][slot]);
+         occupied[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+         while (!pending.empty()) {
+            Node* n = static_cast<Node*>(pending.next);
+            n->unlink();
+            link(n);
+         }
+      }
+   }
+
+   // Wywołanie zegarów bieżącej szczeliny poziomu 0, także wstawionych do
+   // niej przez funkcję zwrotną.
+   template<typename F>
+   size_type expire(F& callback) {
+      size_t slot = digit(current, 0);
+      pq_detail::WheelLink& list = wheel[0][slot];
+      pq_detail::WheelLink pending;
+      size_type fired = 0;
+      while (!list.empty()) {
+         pending.splice(list);
+         occupied[0][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+         while (!pending.empty()) {
+            Node* n = static_cast<Node*>(pending.next);
+            n->unlink();
+            --counter;
+            try {
+               callback(static_cast<const K&>(n->key), n->deadline);
+            } catch (...) {
+               destroy_node(n);
+               // Pozostałe zegary wracają na początek szczeliny.
+               pending.splice(list);
+               list.splice(pending);
+               if (!list.empty())
+                  occupied[0][slot / 64] |= uint64_t(1) << (slot % 64);
+               throw;
+            }
+            destroy_node(n);
+            ++fired;
+         }
+      }
+      return fired;
+   }
+
+   node_allocator_t alloc;
+   pq_detail::WheelLink wheel[levels][slots];
+   uint64_t occupied[levels][words] = {};
+   overflow_t overflow;
+   Time current;
+   size_type counter = 0;
+};
+
+#endif /* __DEADLINEQUEUE_HH__ */
@@ -0,0 +1,552 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* ExternalPriorityQueue: kolejka priorytetowa dla danych większych niż       */
+/* pamięć operacyjna. Nowe pary trafiają do bufora - zwykłej PriorityQueue    */
+/* o ograniczonym rozmiarze. Pełny bufor jest zapisywany na dysk jako         */
+/* przebieg: plik z parami w porządku wartości. Przebiegi są czytane blokami, */
+/* a kolejny blok każdego z nich jest wczytywany z wyprzedzeniem w osobnym    */
+/* wątku. Minimum kolejki to mniejsza z wartości: minimum bufora i najmniejsza*/
+/* głowa przebiegu (scalanie k-drogowe na kopcu przebiegów). Gdy na jednym    */
+/* poziomie zbierze się fan_in przebiegów, są scalane w jeden przebieg        */
+/* poziomu wyższego (jak w sequence heap), więc otwartych przebiegów jest     */
+/* O(fan_in * log_fan_in(n / rozmiar bufora)).                                */
+/*                                                                            */
+/* insert, minValue, minKey i deleteMin działają jak w PriorityQueue, łącznie */
+/* z kolejnością wstawiania przy równych wartościach; nie ma operacji na      */
+/* maksimum ani changeValue. Pary są zapisywane serializatorami jak           */
+/* w migawkach (SnapshotSerializer). Pliki przebiegów są usuwane, gdy         */
+/* przestają być potrzebne, i przy zniszczeniu kolejki.                       */
+/*============================================================================*/
+
+#ifndef __EXTERNALQUEUE_HH__
+#define __EXTERNALQUEUE_HH__
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+// Błąd zapisu lub odczytu pliku przebiegu.
+class PriorityQueueIOException: public std::exception {
+
+public:
+
+   virtual const char* what() const noexcept {
+      return "PriorityQueueIOException";
+   }
+};
+
+// Ustawienia ExternalPriorityQueue.
+struct ExternalQueueOptions {
+   // Budżet pamięci w bajtach: połowa na bufor, połowa na bloki odczytu
+   // i zapisu przebiegów.
+   size_t memory_bytes = size_t(64) << 20;
+   // Katalog plików przebiegów; pusty oznacza katalog tymczasowy systemu.
+   std::string directory;
+   // Liczba przebiegów jednego poziomu scalanych w jeden (co najmniej 2).
+   unsigned fan_in = 8;
+};
+
+namespace pq_detail {
+
+// Zapis przebiegu: rekordy (długość uint32_t, klucz, wartość). Niezamknięty
+// plik jest usuwany w destruktorze.
+template<typename KS, typename VS>
+class RunWriter {
+
+public:
+
+   RunWriter(const std::string& path, size_t block) : path(path) {
+      file = std::fopen(path.c_str(), "wb");
+      if (!file)
+         throw PriorityQueueIOException();
+      std::setvbuf(file, nullptr, _IOFBF, block);
+   }
+
+   RunWriter(const RunWriter&) = delete;
+
+   RunWriter& operator=(const RunWriter&) = delete;
+
+   ~RunWriter() {
+      if (file) {
+         std::fclose(file);
+         std::remove(path.c_str());
+      }
+   }
+
+   template<typename K, typename V>
+   void write(const K& key, const V& value) {
+      bytes.assign(sizeof(uint32_t), 0);
+      KS::write(bytes, key);
+      VS::write(bytes, value);
+      size_t length = bytes.size() - sizeof(uint32_t);
+      if (length > UINT32_MAX)
+         throw PriorityQueueIOException();
+      uint32_t prefix = static_cast<uint32_t>(length);
+      std::memcpy(bytes.data(), &prefix, sizeof(prefix));
+      if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size())
+         throw PriorityQueueIOException();
+   }
+
+   // Zamknięcie pliku; od tej chwili plik należy do wywołującego.
+   void close() {
+      int result = std::fclose(file);
+      file = nullptr;
+      if (result != 0) {
+         std::remove(path.c_str());
+         throw PriorityQueueIOException();
+      }
+   }
+
+private:
+
+   std::string path;
+   std::FILE* file = nullptr;
+   std::vector<char> bytes;
+};
+
+// Odczyt przebiegu blokami; następny blok jest wczytywany asynchronicznie,
+// zanim bieżący zostanie wyczerpany. Głowa (najmniejsza nieodczytana para)
+// jest trzymana w pamięci.
+template<typename K, typename V, typename KS, typename VS>
+class RunReader {
+
+public:
+
+   // Przebieg path z count parami, z pominięciem pierwszych skip. Czytelnik
+   // będący właścicielem pliku usuwa go w destruktorze.
+   RunReader(const std::string& path, uint64_t count, uint64_t skip,
+             uint64_t age, unsigned level, size_t block, bool owner)
+      : age(age), level(level), path(path), block(block), count(count),
+        unread(count), owner(owner) {
+      file = std::fopen(path.c_str(), "rb");
+      if (!file) {
+         if (owner)
+            std::remove(path.c_str());
+         throw PriorityQueueIOException();
+      }
+      try {
+         prefetch();
+         for (; skip > 0; --skip)
+            parse();
+         head = parse();
+      } catch (...) {
+         close();
+         throw;
+      }
+   }
+
+   RunReader(const RunReader&) = delete;
+
+   RunReader& operator=(const RunReader&) = delete;
+
+   ~RunReader() {
+      close();
+   }
+
+   bool empty() const {
+      return !head;
+   }
+
+   // Liczba nieodczytanych par łącznie z głową.
+   uint64_t remaining() const {
+      return unread + (head ? 1 : 0);
+   }
+
+   // Plik przebiegu i liczba wszystkich zapisanych w nim par.
+   const std::string& file_path() const {
+      return path;
+   }
+
+   uint64_t total() const {
+      return count;
+   }
+
+   const K& key() const {
+      return head->first;
+   }
+
+   const V& value() const {
+      return head->second;
+   }
+
+   // Wyjęcie głowy i wczytanie następnej pary; jeśli odczyt zgłosi wyjątek,
+   // głowa pozostaje bez zmian.
+   std::pair<K, V> pop() {
+      std::optional<std::pair<K, V>> next = parse();
+      std::pair<K, V> result = std::move(*head);
+      head = std::move(next);
+      return result;
+   }
+
+   // Numer najstarszego bufora zapisanego w przebiegu (porządek par
+   // o równych wartościach) i poziom scalania.
+   const uint64_t age;
+   const unsigned level;
+
+private:
+
+   // Zlecenie odczytu następnego bloku. Znacznik końca pliku jest
+   // kasowany, więc po nieudanym odczycie można spróbować ponownie.
+   void prefetch() {
+      pending = std::async(std::launch::async, [file = file, n = block] {
+         std::clearerr(file);
+         std::vector<char> data(n);
+         size_t read = std::fread(data.data(), 1, n, file);
+         if (read < n && std::ferror(file))
+            throw PriorityQueueIOException();
+         data.resize(read);
+         return data;
+      });
+   }
+
+   // Następna para z pliku lub std::nullopt po ostatniej.
+   std::optional<std::pair<K, V>> parse() {
+      if (unread == 0)
+         return std::nullopt;
+      while (true) {
+         size_t available = buffer.size() - position;
+         uint32_t length;
+         if (available >= sizeof(length)) {
+            std::memcpy(&length, buffer.data() + position, sizeof(length));
+            if (available - sizeof(length) >= length) {
+               const char* p = buffer.data() + position + sizeof(length);
+               const char* end = p + length;
+               K key = KS::read(p, end);
+               V value = VS::read(p, end);
+               if (p != end)
+                  throw PriorityQueueIOException();
+               position += sizeof(length) + length;
+               --unread;
+               return std::make_pair(std::move(key), std::move(value));
+            }
+         }
+         // Rekord nie mieści się w buforze: dołączamy wczytany blok. Blok
+         // czeka w fetched, aż trafi do bufora, a odczyt zakończony
+         // wyjątkiem jest zlecany ponownie, więc po wyjątku parse można
+         // wywołać jeszcze raz bez utraty ani powtórzenia rekordów.
+         if (!fetched) {
+            if (!pending.valid())
+               prefetch();
+            fetched = pending.get();
+         }
+         if (fetched->empty()) {
+            fetched.reset();
+            throw PriorityQueueIOException(); // Plik krótszy niż count par.
+         }
+         buffer.erase(buffer.begin(), buffer.begin() + position);
+         position = 0;
+         buffer.insert(buffer.end(), fetched->begin(), fetched->end());
+         fetched.reset();
+         prefetch();
+      }
+   }
+
+   void close() {
+      if (pending.valid())
+         pending.wait();
+      if (file)
+         std::fclose(file);
+      file = nullptr;
+      if (owner)
+         std::remove(path.c_str());
+   }
+
+   std::string path;
+   size_t block;
+   uint64_t count;
+   uint64_t unread;
+   bool owner;
+   std::FILE* file = nullptr;
+   std::future<std::vector<char>> pending;
+   std::optional<std::vector<char>> fetched;
+   std::vector<char> buffer;
+   size_t position = 0;
+   std::optional<std::pair<K, V>> head;
+};
+
+} // namespace pq_detail
+
+template<typename K, typename V,
+         typename KeySerializer = SnapshotSerializer<K>,
+         typename ValueSerializer = SnapshotSerializer<V>>
+class ExternalPriorityQueue {
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+
+   /**
+    * Konstruktor tworzący pustą kolejkę z podanymi ustawieniami. Połowa
+    * budżetu pamięci ogranicza bufor (szacunkowo: rozmiary K, V i dwóch
+    * zaczepów drzewa na parę), druga połowa jest dzielona na bloki dla
+    * przebiegów i scalania. [O(1)]
+    */
+   explicit ExternalPriorityQueue(
+      ExternalQueueOptions options = ExternalQueueOptions())
+      : options(std::move(options)) {
+      if (this->options.directory.empty())
+         this->options.directory =
+            std::filesystem::temp_directory_path().string();
+      this->options.fan_in = std::max(2u, this->options.fan_in);
+      const size_t pair_bytes =
+         sizeof(K) + sizeof(V) + 2 * sizeof(pq_detail::TreeHook);
+      capacity = std::max<size_t>(1, this->options.memory_bytes / 2 /
+                                        pair_bytes);
+      // Dwa bloki na przebieg (bieżący i wczytywany), przebiegi z 8 poziomów
+      // oraz fan_in czytelników i jeden zapis przy scalaniu.
+      size_t blocks = 2 * (9 * size_t(this->options.fan_in) + 1);
+      block = std::max<size_t>(4096, this->options.memory_bytes / 2 / blocks);
+      std::random_device random;
+      tag = std::to_string(random()) + "-" + std::to_string(random());
+   }
+
+   ExternalPriorityQueue(const ExternalPriorityQueue&) = delete;
+
+   ExternalPriorityQueue& operator=(const ExternalPriorityQueue&) = delete;
+
+   /**
+    * Liczba par w kolejce (w buforze i w przebiegach na dysku). [O(1)]
+    */
+   size_type size() const {
+      return buffer.size() + run_pairs;
+   }
+
+   bool empty() const {
+      return size() == 0;
+   }
+
+   /**
+    * Liczba przebiegów na dysku. [O(1)]
+    */
+   size_type runCount() const {
+      return runs.size();
+   }
+
+   /**
+    * Metody wstawiające parę (key, value) do bufora. Pełny bufor jest
+    * najpierw zapisywany jako przebieg; jeśli zapis się nie uda
+    * (PriorityQueueIOException), kolejka pozostaje bez zmian.
+    * [O(log capacity) + zapis bufora co capacity wstawień]
+    */
+   void insert(const K& key, const V& value) {
+      emplace(key, value);
+   }
+
+   void insert(K&& key, V&& value) {
+      emplace(std::move(key), std::move(value));
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      if (buffer.size() >= capacity)
+         spill();
+      buffer.emplace(std::forward<KK>(key), std::forward<VV>(value));
+   }
+
+   /**
+    * Metody zwracające najmniejszą wartość w kolejce i klucz pary z tą
+    * wartością; przy pustej kolejce zgłaszają PriorityQueueEmptyException.
+    * [O(1), po usunięciu z przebiegu O(liczba przebiegów)]
+    */
+   const V& minValue() const {
+      if (const Run* run = min_run())
+         return run->value();
+      return buffer.minValue();
+   }
+
+   const K& minKey() const {
+      if (const Run* run = min_run())
+         return run->key();
+      return buffer.minKey();
+   }
+
+   /**
+    * Metoda usuwająca parę o najmniejszej wartości (jeśli kolejka nie jest
+    * pusta). Błąd odczytu przebiegu (PriorityQueueIOException) pozostawia
+    * parę w kolejce. [O(log capacity + log liczby przebiegów)]
+    */
+   void deleteMin() {
+      if (Run* run = min_run())
+         pop_run(run);
+      else
+         buffer.deleteMin();
+   }
+
+   /**
+    * Metoda usuwająca i zwracająca parę o najmniejszej wartości lub
+    * std::nullopt dla pustej kolejki. [jak deleteMin]
+    */
+   std::optional<std::pair<K, V>> tryPopMin() {
+      if (Run* run = min_run())
+         return pop_run(run);
+      return buffer.tryPopMin();
+   }
+
+private:
+
+   using Run = pq_detail::RunReader<K, V, KeySerializer, ValueSerializer>;
+   using Writer = pq_detail::RunWriter<KeySerializer, ValueSerializer>;
+   using buffer_t = PriorityQueue<K, V>;
+
+   // Porządek kopca przebiegów: czy głowa a jest później niż głowa b.
+   // Przy równych wartościach wcześniej są pary ze starszych buforów.
+   static bool later(const Run* a, const Run* b) {
+      return b->value() < a->value() ||
+             (!(a->value() < b->value()) && a->age > b->age);
+   }
+
+   // Przebieg z najmniejszą głową, jeśli jest ona nie większa niż minimum
+   // bufora (bufor zawiera najnowsze pary); w przeciwnym razie nullptr.
+   Run* min_run() const {
+      if (!heap_valid) {
+         heap.clear();
+         for (auto& run : runs)
+            heap.push_back(run.get());
+         std::make_heap(heap.begin(), heap.end(), later);
+         heap_valid = true;
+      }
+      if (heap.empty())
+         return nullptr;
+      Run* run = heap.front();
+      if (!buffer.empty() && buffer.minValue() < run->value())
+         return nullptr;
+      return run;
+   }
+
+   // Wyjęcie głowy przebiegu z wierzchołka kopca.
+   std::pair<K, V> pop_run(Run* run) {
+      std::pair<K, V> result = run->pop();
+      --run_pairs;
+      // Para jest już wyjęta, więc wyjątek z porównania tylko unieważnia
+      // kopiec (zostanie zbudowany przy następnym dostępie).
+      try {
+         std::pop_heap(heap.begin(), heap.end(), later);
+         heap.pop_back();
+         if (!run->empty()) {
+            heap.push_back(run);
+            std::push_heap(heap.begin(), heap.end(), later);
+         }
+      } catch (...) {
+         heap_valid = false;
+      }
+      if (run->empty())
+         remove_runs([run](const Run* r) { return r == run; });
+      return result;
+   }
+
+   template<typename Predicate>
+   void remove_runs(Predicate predicate) {
+      runs.erase(std::remove_if(runs.begin(), runs.end(),
+                                [&](const std::unique_ptr<Run>& r) {
+                                   return predicate(r.get());
+                                }),
+                 runs.end());
+      if (heap_valid)
+         heap.erase(std::remove_if(heap.begin(), heap.end(), predicate),
+                    heap.end());
+   }
+
+   std::string run_path() {
+      return options.directory + "/pq-run-" + tag + "-" +
+             std::to_string(files++);
+   }
+
+   // Zapis bufora jako przebiegu poziomu 0. Bufor jest czytany bez usuwania
+   // par (iteratorami w porządku wartości) i opróżniany dopiero po
+   // zamknięciu pliku.
+   void spill() {
+      std::string path = run_path();
+      Writer writer(path, block);
+      for (auto it = buffer.begin(); it != buffer.end(); ++it)
+         writer.write(it.key(), it.value());
+      writer.close();
+      runs.reserve(runs.size() + 1);
+      heap.reserve(runs.size() + 1);
+      runs.push_back(std::make_unique<Run>(path, buffer.size(), 0, buffers,
+                                           0, block, true));
+      // Od tego miejsca nic nie zgłasza wyjątku.
+      run_pairs += buffer.size();
+      ++buffers;
+      buffer = buffer_t();
+      heap_valid = false;
+
+      for (unsigned level = 0; count_level(level) >= options.fan_in; ++level)
+         merge_level(level);
+   }
+
+   size_t count_level(unsigned level) const {
+      return std::count_if(runs.begin(), runs.end(),
+                           [level](const std::unique_ptr<Run>& r) {
+                              return r->level == level;
+                           });
+   }
+
+   // Scalenie przebiegów poziomu level w jeden przebieg poziomu level + 1.
+   // Scalane przebiegi są czytane przez osobnych czytelników od miejsca,
+   // do którego doszła kolejka, więc przy błędzie nic się nie zmienia.
+   void merge_level(unsigned level) {
+      std::vector<std::unique_ptr<Run>> sources;
+      std::vector<Run*> merge_heap;
+      uint64_t count = 0, age = UINT64_MAX;
+      for (auto& run : runs) {
+         if (run->level != level)
+            continue;
+         // Czytelnik od bieżącej głowy przebiegu.
+         sources.push_back(std::make_unique<Run>(
+            run->file_path(), run->total(), run->total() - run->remaining(),
+            run->age, level, block, false));
+         merge_heap.push_back(sources.back().get());
+         count += run->remaining();
+         age = std::min(age, run->age);
+      }
+
+      std::string path = run_path();
+      Writer writer(path, block);
+      std::make_heap(merge_heap.begin(), merge_heap.end(), later);
+      while (!merge_heap.empty()) {
+         std::pop_heap(merge_heap.begin(), merge_heap.end(), later);
+         Run* run = merge_heap.back();
+         std::pair<K, V> pair = run->pop();
+         writer.write(pair.first, pair.second);
+         if (run->empty())
+            merge_heap.pop_back();
+         else
+            std::push_heap(merge_heap.begin(), merge_heap.end(), later);
+      }
+      writer.close();
+      auto merged = std::make_unique<Run>(path, count, 0, age, level + 1,
+                                          block, true);
+      runs.reserve(runs.size() + 1);
+      // Od tego miejsca nic nie zgłasza wyjątku.
+      remove_runs([level](const Run* r) { return r->level == level; });
+      runs.push_back(std::move(merged));
+      heap_valid = false;
+   }
+
+   ExternalQueueOptions options;
+   size_t capacity;
+   size_t block;
+   std::string tag;
+   uint64_t files = 0;
+   uint64_t buffers = 0;
+   buffer_t buffer;
+   size_type run_pairs = 0;
+   std::vector<std::unique_ptr<Run>> runs;
+   mutable std::vector<Run*> heap;
+   mutable bool heap_valid = true;
+};
+
+#endif /* __EXTERNALQUEUE_HH__ */
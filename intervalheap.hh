@@ -0,0 +1,366 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* Strategia IntervalHeapBackend: kolejka dwustronna na kopcu przedziałowym   */
+/* (interval heap) trzymanym w jednej ciągłej tablicy par (klucz, wartość).   */
+/* Węzeł i kopca to pozycje 2i (koniec minimalny) i 2i + 1 (koniec            */
+/* maksymalny), przy czym [a[2i], a[2i + 1]] zawiera przedziały potomków.     */
+/*                                                                            */
+/* Strategia jest przeznaczona dla kolejek, które nie wyszukują kluczy:       */
+/* dostępne są insert, emplace, minValue, maxValue, minKey, maxKey,           */
+/* deleteMin, deleteMax, popMin, popMax, tryPopMin, tryPopMax, merge i swap,  */
+/* ale nie ma changeValue, uchwytów ani porównań kolejek.                     */
+/*                                                                            */
+/* Kopiec przestawia elementy wyłącznie przez swap, więc K i V muszą być      */
+/* przenoszone bez wyjątków. Każda zamiana jest zapisywana w dzienniku, a gdy */
+/* porównanie zgłosi wyjątek, zamiany są cofane - operacje dają silną         */
+/* gwarancję.                                                                 */
+/*============================================================================*/
+
+#ifndef __INTERVALHEAP_HH__
+#define __INTERVALHEAP_HH__
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+struct IntervalHeapBackend {};
+
+template<typename K, typename V, typename Allocator>
+class PriorityQueue<K, V, Allocator, IntervalHeapBackend> {
+
+   static_assert(std::is_nothrow_move_constructible<K>::value &&
+                 std::is_nothrow_move_assignable<K>::value &&
+                 std::is_nothrow_move_constructible<V>::value &&
+                 std::is_nothrow_move_assignable<V>::value,
+                 "IntervalHeapBackend: K i V muszą być przenoszone no-throw");
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using allocator_type = Allocator;
+
+   /**
+    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
+    */
+   PriorityQueue() {}
+
+   explicit PriorityQueue(const Allocator& alloc) : heap(alloc) {}
+
+   /**
+    * Konstruktor kopiujący [O(queue.size())], przenoszący [O(1)]
+    * i operator przypisania (kopiowanie i zamiana).
+    */
+   PriorityQueue(const PriorityQueue& queue) = default;
+
+   PriorityQueue(PriorityQueue&& queue) noexcept
+      : heap(std::move(queue.heap)) {
+      queue.heap.clear();
+   }
+
+   PriorityQueue& operator=(PriorityQueue queue) {
+      queue.swap(*this);
+      return *this;
+   }
+
+   allocator_type get_allocator() const {
+      return allocator_type(heap.get_allocator());
+   }
+
+   bool empty() const {
+      return heap.empty();
+   }
+
+   size_type size() const {
+      return heap.size();
+   }
+
+   /**
+    * Metody wstawiające parę do kolejki. [O(log size()) zamortyzowane]
+    */
+   void insert(const K& key, const V& value) {
+      heap.emplace_back(key, value);
+      push_last();
+   }
+
+   void insert(K&& key, V&& value) {
+      heap.emplace_back(std::move(key), std::move(value));
+      push_last();
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      heap.emplace_back(std::forward<KK>(key), std::forward<VV>(value));
+      push_last();
+   }
+
+   /**
+    * Najmniejsza i największa wartość oraz ich klucze [O(1)]; dla pustej
+    * kolejki zgłaszają wyjątek PriorityQueueEmptyException.
+    */
+   const V& minValue() const {
+      return heap[min_pos()].second;
+   }
+
+   const V& maxValue() const {
+      return heap[max_pos()].second;
+   }
+
+   const K& minKey() const {
+      return heap[min_pos()].first;
+   }
+
+   const K& maxKey() const {
+      return heap[max_pos()].first;
+   }
+
+   /**
+    * Usunięcie pary o najmniejszej lub największej wartości. [O(log size())]
+    */
+   void deleteMin() {
+      if (!empty())
+         remove(0);
+   }
+
+   void deleteMax() {
+      if (!empty())
+         remove(heap.size() > 1 ? 1 : 0);
+   }
+
+   /**
+    * Usunięcie i zwrócenie pary o najmniejszej lub największej wartości
+    * [O(log size())]; wersje try zwracają std::nullopt dla pustej kolejki.
+    */
+   std::pair<K, V> popMin() {
+      remove_to_back(min_pos());
+      return take_back();
+   }
+
+   std::pair<K, V> popMax() {
+      remove_to_back(max_pos());
+      return take_back();
+   }
+
+   std::optional<std::pair<K, V>> tryPopMin() {
+      if (empty())
+         return std::nullopt;
+      return popMin();
+   }
+
+   std::optional<std::pair<K, V>> tryPopMax() {
+      if (empty())
+         return std::nullopt;
+      return popMax();
+   }
+
+   /**
+    * Scalenie z kolejką queue, która zostaje opróżniona: pary queue są
+    * przenoszone na koniec tablicy i przesiewane w górę.
+    * [O(queue.size() * log (queue.size() + size()))] Jeśli porównanie
+    * wartości może zgłosić wyjątek, scalanie odbywa się na kopii kolejki
+    * (wcześniejszych przesiań nie da się wtedy cofnąć).
+    * [O(size() + queue.size() * log (queue.size() + size()))]
+    */
+   void merge(PriorityQueue& queue) {
+      if (this == &queue)
+         return;
+      if constexpr (pq_detail::is_nothrow_less<V>::value) {
+         // Po rezerwacji nic nie zgłasza wyjątku.
+         heap.reserve(heap.size() + queue.heap.size());
+         for (auto& p : queue.heap) {
+            heap.push_back(std::move(p));
+            SwapLog log(*this);
+            sift_up(heap.size() - 1, log);
+         }
+      } else {
+         PriorityQueue tmp(*this);
+         tmp.heap.reserve(heap.size() + queue.heap.size());
+         for (const auto& p : queue.heap)
+            tmp.insert(p.first, p.second);
+         tmp.swap(*this);
+      }
+      queue.heap.clear();
+   }
+
+   /**
+    * Zamiana zawartości z kolejką queue. [O(1)]
+    */
+   void swap(PriorityQueue& queue) noexcept {
+      heap.swap(queue.heap);
+   }
+
+private:
+
+   using pair_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<std::pair<K, V>>;
+
+   // Dziennik zamian wykonanych przez jedną operację; wysokość kopca nie
+   // przekracza 64, a na poziom przypadają co najwyżej dwie zamiany.
+   class SwapLog {
+
+   public:
+
+      explicit SwapLog(PriorityQueue& queue) : queue(queue) {}
+
+      void swap(size_t i, size_t j) noexcept {
+         using std::swap;
+         swap(queue.heap[i], queue.heap[j]);
+         entries[count++] = std::make_pair(i, j);
+      }
+
+      void undo() noexcept {
+         using std::swap;
+         while (count > 0) {
+            --count;
+            swap(queue.heap[entries[count].first],
+                 queue.heap[entries[count].second]);
+         }
+      }
+
+   private:
+
+      PriorityQueue& queue;
+      std::array<std::pair<size_t, size_t>, 2 * 64 + 4> entries;
+      size_t count = 0;
+   };
+
+   bool less(size_t i, size_t j) const {
+      return heap[i].second < heap[j].second;
+   }
+
+   size_t min_pos() const {
+      if (empty())
+         throw PriorityQueueEmptyException();
+      return 0;
+   }
+
+   size_t max_pos() const {
+      if (empty())
+         throw PriorityQueueEmptyException();
+      return heap.size() > 1 ? 1 : 0;
+   }
+
+   // Przesianie w górę elementu dopisanego na koniec; przy wyjątku element
+   // jest usuwany, a kopiec przywracany.
+   void push_last() {
+      SwapLog log(*this);
+      try {
+         sift_up(heap.size() - 1, log);
+      } catch (...) {
+         log.undo();
+         heap.pop_back();
+         throw;
+      }
+   }
+
+   void sift_up(size_t pos, SwapLog& log) {
+      size_t node = pos / 2;
+      bool min_side;
+      if (pos % 2 == 1) {
+         // Drugi element węzła - porządkujemy przedział węzła.
+         min_side = less(pos, pos - 1);
+         if (min_side) {
+            log.swap(pos, pos - 1);
+            --pos;
+         }
+      } else {
+         // Jedyny element ostatniego węzła - porównanie z przedziałem rodzica.
+         if (node == 0)
+            return;
+         size_t parent = (node - 1) / 2;
+         if (less(pos, 2 * parent))
+            min_side = true;
+         else if (less(2 * parent + 1, pos))
+            min_side = false;
+         else
+            return;
+      }
+      while (node > 0) {
+         size_t parent = (node - 1) / 2;
+         size_t target = min_side ? 2 * parent : 2 * parent + 1;
+         if (min_side ? !less(pos, target) : !less(target, pos))
+            break;
+         log.swap(pos, target);
+         pos = target;
+         node = parent;
+      }
+   }
+
+   // Przesianie w dół elementu z pozycji minimalnej pos w kopcu rozmiaru n.
+   void sift_down_min(size_t pos, size_t n, SwapLog& log) {
+      while (true) {
+         if (pos + 1 < n && less(pos + 1, pos))
+            log.swap(pos, pos + 1);
+         size_t child = 2 * (2 * (pos / 2) + 1);
+         if (child >= n)
+            break;
+         if (child + 2 < n && less(child + 2, child))
+            child += 2;
+         if (!less(child, pos))
+            break;
+         log.swap(pos, child);
+         pos = child;
+      }
+   }
+
+   // Przesianie w dół elementu z pozycji maksymalnej pos w kopcu rozmiaru n.
+   void sift_down_max(size_t pos, size_t n, SwapLog& log) {
+      while (pos % 2 == 1) {
+         if (less(pos, pos - 1))
+            log.swap(pos, pos - 1);
+         size_t node = 2 * (pos / 2) + 1;
+         size_t child = n;
+         for (size_t c = node; c <= node + 1; ++c) {
+            // Koniec maksymalny potomka; ostatni węzeł może mieć jeden element.
+            size_t max = 2 * c + 1 < n ? 2 * c + 1 : 2 * c;
+            if (max < n && (child == n || less(child, max)))
+               child = max;
+         }
+         if (child == n || !less(pos, child))
+            break;
+         log.swap(pos, child);
+         pos = child;
+      }
+   }
+
+   // Przeniesienie elementu z pozycji pos na koniec tablicy z zachowaniem
+   // kopca na pozostałych elementach (pos to 0 lub 1). [O(log size())]
+   void remove_to_back(size_t pos) {
+      size_t n = heap.size() - 1;
+      if (pos == n)
+         return;
+      SwapLog log(*this);
+      try {
+         log.swap(pos, n);
+         if (pos == 0)
+            sift_down_min(0, n, log);
+         else
+            sift_down_max(1, n, log);
+      } catch (...) {
+         log.undo();
+         throw;
+      }
+   }
+
+   void remove(size_t pos) {
+      remove_to_back(pos);
+      heap.pop_back();
+   }
+
+   std::pair<K, V> take_back() noexcept {
+      std::pair<K, V> result(std::move(heap.back()));
+      heap.pop_back();
+      return result;
+   }
+
+   std::vector<std::pair<K, V>, pair_allocator_t> heap;
+};
+
+#endif /* __INTERVALHEAP_HH__ */
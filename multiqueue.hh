@@ -0,0 +1,187 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* MultiQueue: współbieżna, zrelaksowana kolejka priorytetowa dla wielu       */
+/* producentów i konsumentów. Zawiera c * P podkolejek (shardów) typu         */
+/* PriorityQueue, każdą pod własnym muteksem. Wstawienie trafia do losowego   */
+/* sharda, a usunięcie minimum wybiera lepszy z dwóch losowych shardów.       */
+/* Zajęte shardy są pomijane (try_lock), więc wątki rzadko na siebie czekają. */
+/*                                                                            */
+/* Gwarancje porządku są osłabione:                                           */
+/*  - tryPopMin zwraca minimum jednego z shardów, niekoniecznie globalne;     */
+/*    oczekiwana pozycja zwróconej pary w porządku wszystkich wartości jest   */
+/*    rzędu liczby shardów, a żadna para nie czeka w nieskończoność, o ile    */
+/*    usuwanie trwa (wybór dwóch losowych shardów wyrównuje ich minima);      */
+/*  - nie ma porządku FIFO dla równych wartości ani między parami jednego     */
+/*    producenta;                                                             */
+/*  - std::nullopt oznacza, że podczas końcowego przeglądu wszystkie shardy   */
+/*    były puste - para wstawiana współbieżnie może zostać pominięta;         */
+/*  - size() i empty() są przybliżone, gdy trwają inne operacje.              */
+/* Każda operacja na pojedynczym shardzie zachowuje gwarancje PriorityQueue.  */
+/*                                                                            */
+/* Każdy shard ma własną kopię alokatora utworzoną konstruktorem domyślnym,   */
+/* więc np. PoolAllocator daje osobną pulę na shard (chronioną muteksem       */
+/* sharda).                                                                   */
+/*============================================================================*/
+
+#ifndef __MULTIQUEUE_HH__
+#define __MULTIQUEUE_HH__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+template<typename K, typename V,
+         typename Allocator = std::allocator<std::pair<const K, V>>>
+class MultiQueue {
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using queue_type = PriorityQueue<K, V, Allocator>;
+
+   /**
+    * Konstruktor tworzący pustą kolejkę z factor * threads shardami (co
+    * najmniej dwoma). [O(factor * threads)]
+    */
+   explicit MultiQueue(
+      unsigned threads = std::max(1u, std::thread::hardware_concurrency()),
+      unsigned factor = 2)
+      : shards(std::max<size_t>(2, size_t(factor) * threads)) {}
+
+   MultiQueue(const MultiQueue&) = delete;
+
+   MultiQueue& operator=(const MultiQueue&) = delete;
+
+   size_type shardCount() const {
+      return shards.size();
+   }
+
+   /**
+    * Liczba par w kolejce; przybliżona, gdy trwają inne operacje. [O(1)]
+    */
+   size_type size() const {
+      return counter.load(std::memory_order_relaxed);
+   }
+
+   bool empty() const {
+      return size() == 0;
+   }
+
+   /**
+    * Metody wstawiające parę do losowego sharda. [O(log size())]
+    */
+   void insert(const K& key, const V& value) {
+      emplace(key, value);
+   }
+
+   void insert(K&& key, V&& value) {
+      emplace(std::move(key), std::move(value));
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      Shard& shard = lock_any();
+      std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+      shard.queue.emplace(std::forward<KK>(key), std::forward<VV>(value));
+      counter.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   /**
+    * Usunięcie i zwrócenie pary o najmniejszej wartości w lepszym z dwóch
+    * losowych shardów [O(log size())]; std::nullopt, gdy wszystkie shardy
+    * okazały się puste.
+    */
+   std::optional<std::pair<K, V>> tryPopMin() {
+      const int attempts = 16;
+      for (int i = 0; i < attempts; ++i) {
+         Shard& a = shards[random_index()];
+         Shard& b = shards[random_index()];
+         if (&a == &b || !a.lock.try_lock())
+            continue;
+         std::lock_guard<std::mutex> guard_a(a.lock, std::adopt_lock);
+         if (!b.lock.try_lock())
+            continue;
+         std::lock_guard<std::mutex> guard_b(b.lock, std::adopt_lock);
+         if (a.queue.empty() && b.queue.empty())
+            continue;
+         Shard* best = &a;
+         if (a.queue.empty() ||
+             (!b.queue.empty() && b.queue.minValue() < a.queue.minValue()))
+            best = &b;
+         return pop(*best);
+      }
+      // Wylosowane shardy były zajęte lub puste - przeglądamy wszystkie.
+      for (Shard& shard : shards) {
+         std::lock_guard<std::mutex> guard(shard.lock);
+         if (!shard.queue.empty())
+            return pop(shard);
+      }
+      return std::nullopt;
+   }
+
+   /**
+    * Usunięcie pary jak w tryPopMin (bez zwracania jej). [O(log size())]
+    */
+   void deleteMin() {
+      tryPopMin();
+   }
+
+private:
+
+   // Shard w osobnej linii pamięci podręcznej, aby muteksy sąsiednich
+   // shardów nie współdzieliły linii.
+   struct alignas(64) Shard {
+      std::mutex lock;
+      queue_type queue;
+   };
+
+   // Losowy indeks sharda z generatora xorshift64* lokalnego dla wątku.
+   size_t random_index() const {
+      thread_local uint64_t state =
+         std::hash<std::thread::id>()(std::this_thread::get_id()) |
+         0x9E3779B97F4A7C15ull;
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      uint64_t r = (state * 0x2545F4914F6CDD1Dull) >> 32;
+      return static_cast<size_t>((r * shards.size()) >> 32);
+   }
+
+   // Zajęcie losowego wolnego sharda; po wielu nieudanych próbach wątek
+   // czeka na muteks.
+   Shard& lock_any() {
+      const int attempts = 16;
+      for (int i = 0; i < attempts; ++i) {
+         Shard& shard = shards[random_index()];
+         if (shard.lock.try_lock())
+            return shard;
+      }
+      Shard& shard = shards[random_index()];
+      shard.lock.lock();
+      return shard;
+   }
+
+   // Wyjęcie minimum z zablokowanego, niepustego sharda.
+   std::optional<std::pair<K, V>> pop(Shard& shard) {
+      std::optional<std::pair<K, V>> result = shard.queue.tryPopMin();
+      counter.fetch_sub(1, std::memory_order_relaxed);
+      return result;
+   }
+
+   std::vector<Shard> shards;
+   std::atomic<size_type> counter{0};
+};
+
+#endif /* __MULTIQUEUE_HH__ */
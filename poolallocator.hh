@@ -0,0 +1,199 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* Alokator węzłów o stałym rozmiarze dla PriorityQueue. Pamięć jest          */
+/* pobierana w slabach (blokach po wiele węzłów), a zwolnione węzły trafiają  */
+/* na listę wolnych zamiast do operator delete. Slaby są oddawane dopiero     */
+/* przy zniszczeniu puli, tj. gdy zniknie ostatnia kopia alokatora.           */
+/*                                                                            */
+/* Kopie alokatora (także po rebind) współdzielą pulę, dlatego alokator nie   */
+/* jest bezpieczny wielowątkowo - tak jak sama kolejka.                       */
+/*============================================================================*/
+
+#ifndef __POOLALLOCATOR_HH__
+#define __POOLALLOCATOR_HH__
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/*============================================================================*/
+/*                                 NodePool.                                  */
+/*============================================================================*/
+
+class NodePool {
+
+public:
+
+   /**
+    * Pula bloków o rozmiarze block_size; pierwszy slab mieści first_slab
+    * bloków, każdy kolejny dwa razy więcej (do max_slab). [O(1)]
+    */
+   explicit NodePool(size_t block_size, size_t first_slab = 64,
+                     size_t max_slab = 65536)
+      : block(rounded(block_size)), next_slab(first_slab), max_slab(max_slab)
+   {}
+
+   NodePool(const NodePool&) = delete;
+
+   NodePool& operator=(const NodePool&) = delete;
+
+   /**
+    * Zwalnia wszystkie slaby. [O(liczba slabów)]
+    */
+   ~NodePool() {
+      for (void* slab : slabs)
+         ::operator delete(slab);
+   }
+
+   size_t block_size() const noexcept {
+      return block;
+   }
+
+   /**
+    * Rzeczywisty rozmiar bloku dla obiektów rozmiaru size (z wyrównaniem).
+    */
+   static size_t rounded(size_t size) noexcept {
+      const size_t align = alignof(std::max_align_t);
+      size = size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size;
+      return (size + align - 1) / align * align;
+   }
+
+   /**
+    * Pobranie bloku z listy wolnych, a gdy jest pusta - z bieżącego slaba;
+    * nowy slab jest alokowany tylko po wyczerpaniu poprzedniego.
+    * [O(1) zamortyzowane]
+    */
+   void* allocate() {
+      if (free_list) {
+         FreeBlock* b = free_list;
+         free_list = b->next;
+         return b;
+      }
+      if (cursor == slab_end)
+         grow();
+      void* b = cursor;
+      cursor += block;
+      return b;
+   }
+
+   /**
+    * Oddanie bloku na listę wolnych. [O(1)]
+    */
+   void deallocate(void* p) noexcept {
+      FreeBlock* b = static_cast<FreeBlock*>(p);
+      b->next = free_list;
+      free_list = b;
+   }
+
+private:
+
+   struct FreeBlock {
+      FreeBlock* next;
+   };
+
+   void grow() {
+      slabs.reserve(slabs.size() + 1);
+      char* slab = static_cast<char*>(::operator new(block * next_slab));
+      slabs.push_back(slab); // Miejsce zarezerwowane, no-throw.
+      cursor = slab;
+      slab_end = slab + block * next_slab;
+      if (next_slab < max_slab)
+         next_slab *= 2;
+   }
+
+   size_t block;
+   size_t next_slab;
+   size_t max_slab;
+   std::vector<void*> slabs;
+   char* cursor = nullptr;
+   char* slab_end = nullptr;
+   FreeBlock* free_list = nullptr;
+};
+
+/*============================================================================*/
+/*                               PoolAllocator.                               */
+/*============================================================================*/
+
+namespace pq_detail {
+
+// Zestaw pul współdzielony przez wszystkie kopie alokatora, po jednej puli
+// na rozmiar bloku (w praktyce jedna - dla węzła kolejki).
+class PoolSet {
+
+public:
+
+   NodePool& pool(size_t size) {
+      size_t block = NodePool::rounded(size);
+      for (auto& p : pools)
+         if (p->block_size() == block)
+            return *p;
+      pools.reserve(pools.size() + 1);
+      pools.emplace_back(new NodePool(block));
+      return *pools.back();
+   }
+
+private:
+
+   std::vector<std::unique_ptr<NodePool>> pools;
+};
+
+} // namespace pq_detail
+
+template<typename T>
+class PoolAllocator {
+
+public:
+
+   using value_type = T;
+   using propagate_on_container_copy_assignment = std::true_type;
+   using propagate_on_container_move_assignment = std::true_type;
+   using propagate_on_container_swap = std::true_type;
+
+   static_assert(alignof(T) <= alignof(std::max_align_t),
+                 "PoolAllocator: typ o zbyt dużym wyrównaniu");
+
+   /**
+    * Nowy alokator z własną, pustą pulą.
+    */
+   PoolAllocator() : pools(std::make_shared<pq_detail::PoolSet>()) {}
+
+   template<typename U>
+   PoolAllocator(const PoolAllocator<U>& alloc) noexcept : pools(alloc.pools) {}
+
+   /**
+    * Pojedyncze obiekty pochodzą z puli, tablice z operator new. [O(1)]
+    */
+   T* allocate(size_t n) {
+      if (n == 1)
+         return static_cast<T*>(pools->pool(sizeof(T)).allocate());
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+   }
+
+   void deallocate(T* p, size_t n) noexcept {
+      if (n == 1)
+         pools->pool(sizeof(T)).deallocate(p);
+      else
+         ::operator delete(p);
+   }
+
+   template<typename U>
+   bool operator==(const PoolAllocator<U>& alloc) const noexcept {
+      return pools == alloc.pools;
+   }
+
+   template<typename U>
+   bool operator!=(const PoolAllocator<U>& alloc) const noexcept {
+      return pools != alloc.pools;
+   }
+
+private:
+
+   template<typename U>
+   friend class PoolAllocator;
+
+   std::shared_ptr<pq_detail::PoolSet> pools;
+};
+
+#endif /* __POOLALLOCATOR_HH__ */
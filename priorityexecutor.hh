@@ -0,0 +1,407 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* PriorityExecutor: pula wątków wykonująca zadania w kolejności priorytetów  */
+/* (mniejsza wartość - pilniejsze zadanie, remisy w kolejności zlecenia).     */
+/* Każdy wątek roboczy ma własną kolejkę PriorityQueue pod własnym muteksem,  */
+/* więc nie ma globalnej blokady. Zadanie zlecone z wątku roboczego trafia    */
+/* do jego kolejki, a z innego wątku - do losowej. Przed każdym zadaniem      */
+/* wątek porównuje minimum swojej kolejki z minimami dwóch losowych kolejek   */
+/* innych wątków (try_lock) i bierze najlepsze zadanie; gdy jego kolejka jest */
+/* pusta, przenosi do niej także część najlepszych zadań ofiary (kradzież     */
+/* pracy).                                                                    */
+/*                                                                            */
+/* Gwarancje porządku są osłabione jak w MultiQueue: zadanie pilniejsze od    */
+/* już wykonywanego może czekać w kolejce innego wątku, dopóki któryś wątek   */
+/* go nie wylosuje; przy jednym wątku roboczym porządek jest dokładny.        */
+/*                                                                            */
+/* Zadanie nie może zgłaszać wyjątków (std::terminate). W C++20 schedule      */
+/* zwraca obiekt dla co_await, który wznawia korutynę jako zadanie            */
+/* o podanym priorytecie.                                                     */
+/*============================================================================*/
+
+#ifndef __PRIORITYEXECUTOR_HH__
+#define __PRIORITYEXECUTOR_HH__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#define PRIORITYEXECUTOR_COROUTINES 1
+#endif
+
+#include "priorityqueue.hh"
+
+template<typename P = int>
+class PriorityExecutor {
+
+   struct Task;
+
+public:
+
+   using size_type = size_t;
+   using priority_type = P;
+
+   // Maksymalna liczba zadań przenoszonych przy jednej kradzieży.
+   static constexpr size_type steal_batch = 32;
+
+   /**
+    * Uchwyt do zleconego zadania, ważny także po jego wykonaniu.
+    */
+   class task_handle {
+
+   public:
+
+      task_handle() {}
+
+   private:
+
+      friend class PriorityExecutor<P>;
+
+      explicit task_handle(std::shared_ptr<Task> t) : task(std::move(t)) {}
+
+      std::shared_ptr<Task> task;
+   };
+
+   /**
+    * Konstruktor uruchamiający threads wątków roboczych (co najmniej jeden).
+    * [O(threads)]
+    */
+   explicit PriorityExecutor(
+      unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+      threads = std::max(1u, threads);
+      for (unsigned i = 0; i < threads; ++i)
+         workers.push_back(std::make_unique<Worker>());
+      try {
+         for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back([this, i] { run(i); });
+      } catch (...) {
+         shutdown();
+         throw;
+      }
+   }
+
+   PriorityExecutor(const PriorityExecutor&) = delete;
+
+   PriorityExecutor& operator=(const PriorityExecutor&) = delete;
+
+   /**
+    * Destruktor czeka na wykonanie wszystkich zleconych zadań (także
+    * zleconych przez zadania) i kończy wątki robocze.
+    */
+   ~PriorityExecutor() {
+      wait();
+      shutdown();
+   }
+
+   size_type threadCount() const {
+      return workers.size();
+   }
+
+   /**
+    * Liczba zadań zleconych i jeszcze niezakończonych; przybliżona, gdy
+    * trwają inne operacje. [O(1)]
+    */
+   size_type pending() const {
+      return unfinished.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * Metoda zlecająca wykonanie function() z priorytetem priority.
+    * [O(log n) dla n zadań w kolejce wątku]
+    */
+   template<typename F>
+   task_handle submit(const P& priority, F&& function) {
+      auto task = std::make_shared<Task>(std::forward<F>(function));
+      unfinished.fetch_add(1);
+      queued.fetch_add(1);
+      try {
+         unsigned index = lock_any();
+         Worker& worker = *workers[index];
+         std::lock_guard<std::mutex> guard(worker.lock, std::adopt_lock);
+         task->seq = worker.next_seq++ * workers.size() + index;
+         worker.queue.insert(Job{task->seq, task}, priority);
+         task->owner.store(index, std::memory_order_relaxed);
+         worker.size.fetch_add(1, std::memory_order_relaxed);
+      } catch (...) {
+         queued.fetch_sub(1);
+         unfinished.fetch_sub(1);
+         throw;
+      }
+      wake();
+      return task_handle(std::move(task));
+   }
+
+   /**
+    * Metoda zmieniająca priorytet zadania oczekującego w kolejce (przez
+    * changeValue w kolejce wątku, który je przechowuje). Zwraca false, gdy
+    * zadanie zostało już rozpoczęte. [O(log n)]
+    */
+   bool reprioritize(const task_handle& handle, const P& priority) {
+      assert(handle.task);
+      Task& task = *handle.task;
+      for (;;) {
+         unsigned index = task.owner.load();
+         if (index == running)
+            return false;
+         Worker& worker = *workers[index];
+         std::lock_guard<std::mutex> guard(worker.lock);
+         // Właściciel zmienia się tylko pod jego muteksem.
+         if (task.owner.load() != index)
+            continue;
+         worker.queue.changeValue(Job{task.seq, nullptr}, priority);
+         return true;
+      }
+   }
+
+   /**
+    * Metoda czekająca, aż wszystkie zlecone zadania zostaną zakończone.
+    * Nie może być wywołana z zadania.
+    */
+   void wait() {
+      std::unique_lock<std::mutex> guard(idle_lock);
+      done.wait(guard, [this] { return unfinished.load() == 0; });
+   }
+
+#ifdef PRIORITYEXECUTOR_COROUTINES
+   class schedule_awaiter {
+
+   public:
+
+      bool await_ready() const noexcept {
+         return false;
+      }
+
+      void await_suspend(std::coroutine_handle<> handle) {
+         executor.submit(priority, [handle] { handle.resume(); });
+      }
+
+      void await_resume() const noexcept {}
+
+   private:
+
+      friend class PriorityExecutor<P>;
+
+      schedule_awaiter(PriorityExecutor& e, const P& p)
+         : executor(e), priority(p) {}
+
+      PriorityExecutor& executor;
+      P priority;
+   };
+
+   /**
+    * co_await executor.schedule(priority) wstrzymuje korutynę i wznawia ją
+    * w wątku roboczym jako zadanie o priorytecie priority.
+    */
+   schedule_awaiter schedule(const P& priority) {
+      return schedule_awaiter(*this, priority);
+   }
+#endif
+
+private:
+
+   static constexpr unsigned running = ~0u;
+
+   struct Task {
+      template<typename F>
+      explicit Task(F&& f) : function(std::forward<F>(f)) {}
+
+      std::function<void()> function;
+      uint64_t seq = 0;
+      std::atomic<unsigned> owner{running};
+   };
+
+   // Klucz w kolejce wątku: numer zadania (unikalny) i samo zadanie.
+   struct Job {
+      uint64_t seq;
+      std::shared_ptr<Task> task;
+
+      bool operator<(const Job& job) const noexcept {
+         return seq < job.seq;
+      }
+
+      bool operator==(const Job& job) const noexcept {
+         return seq == job.seq;
+      }
+   };
+
+   // Kolejka wątku w osobnej linii pamięci podręcznej.
+   struct alignas(64) Worker {
+      std::mutex lock;
+      PriorityQueue<Job, P> queue;
+      std::atomic<size_type> size{0};
+      uint64_t next_seq = 0;
+   };
+
+   // Numer wątku roboczego tego wykonawcy, w którym działa wywołujący
+   // (lub running).
+   unsigned current_worker() const {
+      return current().first == this ? current().second : running;
+   }
+
+   static std::pair<const void*, unsigned>& current() {
+      thread_local std::pair<const void*, unsigned> worker{nullptr, running};
+      return worker;
+   }
+
+   // Losowy indeks wątku z generatora xorshift64* lokalnego dla wątku.
+   unsigned random_index() const {
+      thread_local uint64_t state =
+         std::hash<std::thread::id>()(std::this_thread::get_id()) |
+         0x9E3779B97F4A7C15ull;
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      uint64_t r = (state * 0x2545F4914F6CDD1Dull) >> 32;
+      return static_cast<unsigned>((r * workers.size()) >> 32);
+   }
+
+   // Zajęcie kolejki dla nowego zadania: w wątku roboczym jego własnej,
+   // poza nim - losowej wolnej (wątek wywłaszczony z muteksem nie blokuje
+   // zlecających); po wielu nieudanych próbach wątek czeka na muteks.
+   unsigned lock_any() {
+      unsigned index = current_worker();
+      if (index == running) {
+         const int attempts = 16;
+         for (int i = 0; i < attempts; ++i) {
+            index = random_index();
+            if (workers[index]->lock.try_lock())
+               return index;
+         }
+         index = random_index();
+      }
+      workers[index]->lock.lock();
+      return index;
+   }
+
+   // Obudzenie śpiącego wątku po zleceniu zadania.
+   void wake() {
+      if (sleepers.load() > 0) {
+         std::lock_guard<std::mutex> guard(idle_lock);
+         idle.notify_one();
+      }
+   }
+
+   // Wyjęcie zadania z zablokowanej, niepustej kolejki.
+   std::shared_ptr<Task> pop(Worker& worker) {
+      std::shared_ptr<Task> task = std::move(worker.queue.popMin().first.task);
+      task->owner.store(running);
+      worker.size.fetch_sub(1, std::memory_order_relaxed);
+      queued.fetch_sub(1);
+      return task;
+   }
+
+   // Najlepsze zadanie spośród kolejki wątku self i dwóch losowych kolejek
+   // innych wątków; przy pustej kolejce własnej część najlepszych zadań
+   // ofiary przechodzi do niej.
+   std::shared_ptr<Task> take(unsigned self) {
+      Worker& own = *workers[self];
+      std::lock_guard<std::mutex> guard(own.lock);
+      Worker* best = own.queue.empty() ? nullptr : &own;
+      std::unique_lock<std::mutex> victim_guard;
+      for (int i = 0; i < 2 && workers.size() > 1; ++i) {
+         Worker& victim = *workers[random_index()];
+         if (&victim == &own || &victim == best ||
+             victim.size.load(std::memory_order_relaxed) == 0)
+            continue;
+         std::unique_lock<std::mutex> lock(victim.lock, std::try_to_lock);
+         if (!lock || victim.queue.empty())
+            continue;
+         if (!best || victim.queue.minValue() < best->queue.minValue()) {
+            best = &victim;
+            victim_guard = std::move(lock);
+         }
+      }
+      if (!best)
+         return nullptr;
+
+      std::shared_ptr<Task> task = pop(*best);
+      if (best != &own && own.queue.empty()) {
+         size_type n = std::min(steal_batch, best->queue.size() / 2);
+         for (size_type i = 0; i < n; ++i) {
+            // Wstawienie przed usunięciem: przy braku pamięci zadanie
+            // zostaje u ofiary.
+            Task* stolen = best->queue.minKey().task.get();
+            own.queue.insert(best->queue.minKey(), best->queue.minValue());
+            stolen->owner.store(self);
+            best->queue.deleteMin();
+            best->size.fetch_sub(1, std::memory_order_relaxed);
+            own.size.fetch_add(1, std::memory_order_relaxed);
+         }
+      }
+      return task;
+   }
+
+   // Zadanie z dowolnej kolejki (przegląd wszystkich pod muteksami).
+   std::shared_ptr<Task> take_any() {
+      for (auto& worker : workers) {
+         if (worker->size.load(std::memory_order_relaxed) == 0)
+            continue;
+         std::lock_guard<std::mutex> guard(worker->lock);
+         if (!worker->queue.empty())
+            return pop(*worker);
+      }
+      return nullptr;
+   }
+
+   void run(unsigned self) {
+      current() = {this, self};
+      for (;;) {
+         std::shared_ptr<Task> task = take(self);
+         if (!task && queued.load() > 0)
+            task = take_any();
+         if (task) {
+            task->function();
+            task->function = nullptr;
+            if (unfinished.fetch_sub(1) == 1) {
+               std::lock_guard<std::mutex> guard(idle_lock);
+               done.notify_all();
+            }
+            continue;
+         }
+         if (queued.load() > 0) {
+            // Zadanie jest zliczone, ale jeszcze nie wstawione.
+            std::this_thread::yield();
+            continue;
+         }
+         std::unique_lock<std::mutex> guard(idle_lock);
+         sleepers.fetch_add(1);
+         idle.wait(guard, [this] { return queued.load() > 0 || stopping; });
+         sleepers.fetch_sub(1);
+         if (stopping && queued.load() == 0)
+            return;
+      }
+   }
+
+   void shutdown() {
+      {
+         std::lock_guard<std::mutex> guard(idle_lock);
+         stopping = true;
+         idle.notify_all();
+      }
+      for (auto& thread : pool)
+         thread.join();
+   }
+
+   std::vector<std::unique_ptr<Worker>> workers;
+   std::vector<std::thread> pool;
+   std::atomic<size_type> unfinished{0}; // zlecone i niezakończone
+   std::atomic<size_type> queued{0};     // czekające w kolejkach
+   std::atomic<unsigned> sleepers{0};
+   std::mutex idle_lock;
+   std::condition_variable idle;
+   std::condition_variable done;
+   bool stopping = false;
+};
+
+#endif /* __PRIORITYEXECUTOR_HH__ */
@@ -3,479 +3,3454 @@
 /*                        Katarzyna Herba  - kh359525                         */
 /*                        Artur Myszkowski - am347189                         */
 /*============================================================================*/
-/* Implementacja kolejki priorytetowej opiera się na strukturach              */
-/* przechowujących smart pointer'y - shared_ptr. Każda para (Key, Value) jest */
-/* tworzona raz, a opearcje wykonywane są na wskaźnikach. Użyte kontenery to  */
-/* map<shared_ptr<K>, multiset<shared_ptr<V>>> oraz                           */
-/* map<shared_ptr<V>, multiset<shared_ptr<K>>> z odpowiednio zdefiniowanym    */
-/* komparatorem.                                                              */
+/* Implementacja kolejki priorytetowej opiera się na węzłach intruzyjnych.    */
+/* Każda para (Key, Value) jest przechowywana w dokładnie jednym węźle,       */
+/* alokowanym jednorazowo przy wstawieniu. Węzeł zawiera dwa zaczepy (hook)   */
+/* drzewa AVL, dzięki czemu jest jednocześnie podpięty do indeksu kluczy      */
+/* (porządek po parze (klucz, wartość)) oraz do indeksu wartości (porządek po */
+/* wartości, przy równych wartościach - kolejność wstawiania). Operacje na    */
+/* drzewach, które nie porównują elementów (podpinanie, odpinanie,            */
+/* rotacje), nie zgłaszają wyjątków, co pozwala zapewnić silną gwarancję:     */
+/* najpierw wyszukujemy pozycje (porównania mogą rzucić), a dopiero potem     */
+/* modyfikujemy strukturę.                                                    */
 /*============================================================================*/
 
 #ifndef __PRIORITYQUEUE_HH__
 #define __PRIORITYQUEUE_HH__
 
 #include <memory>
-#include <map>
-#include <set>
+#include <new>
+#include <vector>
 #include <algorithm>
+#include <functional>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 /*============================================================================*/
 /*                                 Wyjątki.                                   */
 /*============================================================================*/
 
-class PriorityQueueEmptyException: public std::exception {
+class PriorityQueueEmptyException: public std::exception {
+
+public:
+
+   virtual const char* what() const noexcept {
+      return "PriorityQueueEmptyException";
+   }
+};
+
+class PriorityQueueNotFoundException: public std::exception {
+
+public:
+
+   virtual const char* what() const noexcept {
+      return "PriorityQueueNotFoundException";
+   }
+};
+
+// Błąd zapisu lub odczytu migawki: plik niedostępny, uszkodzony (zła suma
+// kontrolna) albo zapisany dla innych typów K i V.
+class PriorityQueueSnapshotException: public std::exception {
+
+public:
+
+   virtual const char* what() const noexcept {
+      return "PriorityQueueSnapshotException";
+   }
+};
+
+/*============================================================================*/
+/*                              Statystyki.                                   */
+/*============================================================================*/
+
+// Migawka liczników kolejki ze strategią InstrumentedBackend (stats()).
+// Liczniki operacji dotyczą obiektu kolejki od jego utworzenia; kopia
+// i kolejka przeniesiona zaczynają od zera.
+struct PriorityQueueStats {
+   size_t comparisons = 0;    // porównania kluczy i wartości przy wyszukiwaniu
+                              // i sortowaniu paczek
+   size_t allocations = 0;    // alokacje węzłów
+   size_t deallocations = 0;  // zwolnienia węzłów
+   size_t insertions = 0;     // wstawione pary: insert, emplace, insertBatch
+   size_t deletions = 0;      // usunięte pary: deleteMin, deleteMax, pop*,
+                              // eraseKey, eraseAll
+   size_t value_changes = 0;  // wywołania changeValue
+   size_t merges = 0;         // wywołania merge
+   size_t nodes = 0;          // węzły w kolejce (po jednym na parę)
+   size_t duplicate_keys = 0; // pary o kluczu takim jak poprzednia w porządku
+                              // kluczy (tyle węzłów dzielą klucze powtórzone)
+   size_t memory_bytes = 0;   // obiekt kolejki i jej węzły (bez narzutu
+                              // alokatora)
+   size_t tombstones = 0;     // pary usunięte leniwie, czekające na
+                              // kompaktowanie (zawarte w nodes)
+};
+
+/*============================================================================*/
+/*                               Migawki.                                     */
+/*============================================================================*/
+
+// Serializator elementów migawki (saveSnapshot, loadSnapshot). Domyślny
+// zapisuje bajty obiektu i jest dostępny dla typów trywialnie kopiowalnych;
+// dla innych typów należy dostarczyć specjalizację (jak dla std::string
+// poniżej) lub własną klasę z tymi samymi statycznymi metodami.
+template<typename T>
+struct SnapshotSerializer {
+
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "SnapshotSerializer: brak serializatora dla tego typu");
+
+   // Dopisanie reprezentacji t do out.
+   static void write(std::vector<char>& out, const T& t) {
+      const char* bytes = reinterpret_cast<const char*>(&t);
+      out.insert(out.end(), bytes, bytes + sizeof(T));
+   }
+
+   // Odczyt obiektu z [p, end), przesuwa p; przy zbyt krótkich danych
+   // zgłasza PriorityQueueSnapshotException.
+   static T read(const char*& p, const char* end) {
+      if (static_cast<size_t>(end - p) < sizeof(T))
+         throw PriorityQueueSnapshotException();
+      T t;
+      std::memcpy(static_cast<void*>(&t), p, sizeof(T));
+      p += sizeof(T);
+      return t;
+   }
+};
+
+// Napis jako długość (uint64_t) i znaki.
+template<typename C, typename Traits, typename A>
+struct SnapshotSerializer<std::basic_string<C, Traits, A>> {
+
+   using string_t = std::basic_string<C, Traits, A>;
+
+   static void write(std::vector<char>& out, const string_t& s) {
+      SnapshotSerializer<uint64_t>::write(out, s.size());
+      const char* bytes = reinterpret_cast<const char*>(s.data());
+      out.insert(out.end(), bytes, bytes + s.size() * sizeof(C));
+   }
+
+   static string_t read(const char*& p, const char* end) {
+      uint64_t size = SnapshotSerializer<uint64_t>::read(p, end);
+      if (size > static_cast<uint64_t>(end - p) / sizeof(C))
+         throw PriorityQueueSnapshotException();
+      string_t s(size, C());
+      std::memcpy(&s[0], p, size * sizeof(C));
+      p += size * sizeof(C);
+      return s;
+   }
+};
+
+/*============================================================================*/
+/*                          Struktury pomocnicze.                             */
+/*============================================================================*/
+
+namespace pq_detail {
+
+// Zaczep węzła w drzewie AVL. Węzeł kolejki dziedziczy po dwóch zaczepach
+// (KeyHook i ValueHook), więc konwersja zaczep -> węzeł to static_cast.
+// Licznik węzłów poddrzewa jest utrzymywany tylko w CountedTree; mieści się
+// obok wysokości w 8 bajtach, stąd limit 2^32 - 1 par w kolejce.
+struct TreeHook {
+   TreeHook* parent = nullptr;
+   TreeHook* left = nullptr;
+   TreeHook* right = nullptr;
+   uint32_t count = 1;
+   int8_t height = 1;
+};
+
+struct KeyHook: TreeHook {};
+
+// Znacznik pary usuniętej leniwie (setLazyErase): węzeł pozostaje w obu
+// indeksach do kompaktowania. Pole mieści się w wyrównaniu zaczepu, więc nie
+// powiększa węzła.
+struct ValueHook: TreeHook {
+   bool dead = false;
+};
+
+// Pobranie linii pamięci spod adresu p do pamięci podręcznej z wyprzedzeniem
+// (bez efektu na kompilatorach bez __builtin_prefetch).
+inline void prefetch(const void* p) noexcept {
+#if defined(__GNUC__)
+   __builtin_prefetch(p);
+#else
+   (void)p;
+#endif
+}
+
+// Miejsce, w którym należy podpiąć nowy węzeł (wynik wyszukiwania).
+struct Position {
+   TreeHook* parent;
+   bool left;
+};
+
+// Intruzyjne drzewo AVL. Drzewo nie zna typu elementów i nie porównuje ich -
+// wyszukiwanie pozycji odbywa się po stronie kolejki, a wszystkie metody
+// drzewa są no-throw. Drzewo z licznikami (Counted, zaczepy typu ValueHook)
+// pamięta w każdym węźle liczbę żywych (nieoznaczonych) węzłów poddrzewa,
+// co daje wybór k-tego węzła i rangi w O(log n).
+template<bool Counted>
+class BasicTree {
+
+public:
+
+   BasicTree() {}
+
+   BasicTree(const BasicTree&) = delete;
+
+   BasicTree& operator=(const BasicTree&) = delete;
+
+   TreeHook* root() const noexcept { return root_; }
+
+   // Skrajne węzły są pamiętane, więc first() i last() działają w O(1).
+   TreeHook* first() const noexcept { return leftmost_; }
+
+   TreeHook* last() const noexcept { return rightmost_; }
+
+   // Liczba żywych węzłów poddrzewa h (tylko Counted).
+   static uint32_t count(const TreeHook* h) noexcept {
+      return h ? h->count : 0;
+   }
+
+   // Czy węzeł h jest żywy, tj. liczony (tylko Counted).
+   static uint32_t own(const TreeHook* h) noexcept {
+      return !static_cast<const ValueHook*>(h)->dead;
+   }
+
+   // Poprawienie liczników na ścieżce od h do korzenia po oznaczeniu h.
+   // [O(log n)]
+   static void recount(TreeHook* h) noexcept {
+      static_assert(Counted, "BasicTree::recount wymaga liczników");
+      for (; h; h = h->parent)
+         h->count = own(h) + count(h->left) + count(h->right);
+   }
+
+   // Żywy węzeł o pozycji k (od 0) wśród żywych lub nullptr. [O(log n)]
+   TreeHook* select(size_t k) const noexcept {
+      static_assert(Counted, "BasicTree::select wymaga liczników");
+      TreeHook* h = root_;
+      while (h) {
+         size_t left = count(h->left);
+         if (k < left) {
+            h = h->left;
+         } else if (k == left && own(h)) {
+            return h;
+         } else {
+            k -= left + own(h);
+            h = h->right;
+         }
+      }
+      return nullptr;
+   }
+
+   static TreeHook* next(TreeHook* h) noexcept {
+      if (h->right) {
+         h = h->right;
+         while (h->left)
+            h = h->left;
+         return h;
+      }
+      while (h->parent && h->parent->right == h)
+         h = h->parent;
+      return h->parent;
+   }
+
+   static TreeHook* prev(TreeHook* h) noexcept {
+      if (h->left) {
+         h = h->left;
+         while (h->right)
+            h = h->right;
+         return h;
+      }
+      while (h->parent && h->parent->left == h)
+         h = h->parent;
+      return h->parent;
+   }
+
+   // Jak next i prev, ale przy zejściu do skrajnego węzła poddrzewa
+   // pobierają z wyprzedzeniem korzenie poddrzew odwiedzanych po mijanych
+   // węzłach; przy przejściu wielu węzłów spoza pamięci podręcznej ich
+   // pobieranie nakłada się z obsługą wcześniejszych.
+   static TreeHook* next_ahead(TreeHook* h) noexcept {
+      if (h->right) {
+         h = h->right;
+         while (h->left) {
+            prefetch(h->right);
+            h = h->left;
+         }
+         prefetch(h->right);
+         return h;
+      }
+      while (h->parent && h->parent->right == h)
+         h = h->parent;
+      return h->parent;
+   }
+
+   static TreeHook* prev_ahead(TreeHook* h) noexcept {
+      if (h->left) {
+         h = h->left;
+         while (h->right) {
+            prefetch(h->left);
+            h = h->right;
+         }
+         prefetch(h->left);
+         return h;
+      }
+      while (h->parent && h->parent->left == h)
+         h = h->parent;
+      return h->parent;
+   }
+
+   // Wyszukanie miejsca dla węzła nie mniejszego od hint (lub od korzenia,
+   // gdy hint == nullptr); goes_left(h) mówi, czy miejsce leży na lewo od h.
+   // Przy kolejnych wstawieniach posortowanego ciągu wspinaczka od hint
+   // odwiedza głównie węzły ścieżek już obecne w pamięci podręcznej.
+   template<typename GoesLeft>
+   Position search(TreeHook* hint, GoesLeft goes_left) const {
+      TreeHook* h = root_;
+      if (hint) {
+         // Najniższy przodek hint, którego poddrzewo zawiera szukane miejsce.
+         h = hint;
+         while (true) {
+            while (h->parent && h->parent->right == h)
+               h = h->parent;
+            if (!h->parent || goes_left(h->parent))
+               break;
+            h = h->parent;
+         }
+      }
+      Position pos{nullptr, false};
+      while (h) {
+         pos.parent = h;
+         pos.left = goes_left(h);
+         h = pos.left ? h->left : h->right;
+      }
+      return pos;
+   }
+
+   // Podpięcie węzła w miejscu wyznaczonym przez wyszukiwanie. [O(log n)]
+   void link(TreeHook* node, Position pos) noexcept {
+      node->parent = pos.parent;
+      node->left = node->right = nullptr;
+      node->height = 1;
+      if constexpr (Counted)
+         node->count = own(node);
+      if (!pos.parent) {
+         root_ = leftmost_ = rightmost_ = node;
+         return;
+      }
+      if (pos.left) {
+         pos.parent->left = node;
+         if (pos.parent == leftmost_)
+            leftmost_ = node;
+      } else {
+         pos.parent->right = node;
+         if (pos.parent == rightmost_)
+            rightmost_ = node;
+      }
+      // Rotacje przeliczają liczniki z dzieci, więc ścieżka musi być
+      // poprawiona wcześniej.
+      if constexpr (Counted)
+         add(pos.parent, nullptr, own(node));
+      rebalance(pos.parent);
+   }
+
+   // Podpięcie węzła bezpośrednio przed węzłem succ (lub na końcu, gdy succ
+   // to nullptr), bez porównań. [O(log n)]
+   void link_before(TreeHook* node, TreeHook* succ) noexcept {
+      if (!succ)
+         link(node, Position{rightmost_, false});
+      else if (!succ->left)
+         link(node, Position{succ, true});
+      else
+         link(node, Position{prev(succ), false});
+   }
+
+   // Następnik miejsca pos w porządku drzewa z pominięciem węzła skip
+   // (który zostanie odpięty przed ponownym podpięciem). [O(log n)]
+   static TreeHook* successor(Position pos, TreeHook* skip) noexcept {
+      TreeHook* succ = pos.left ? pos.parent : next(pos.parent);
+      return succ == skip ? next(skip) : succ;
+   }
+
+   // Odpięcie węzła z drzewa. [O(log n)]
+   void unlink(TreeHook* node) noexcept {
+      if (node == leftmost_)
+         leftmost_ = next(node);
+      if (node == rightmost_)
+         rightmost_ = prev(node);
+
+      if constexpr (Counted)
+         add(node->parent, nullptr, -own(node));
+      TreeHook* start;
+      if (node->left && node->right) {
+         // Następnik zajmuje miejsce usuwanego węzła.
+         TreeHook* s = node->right;
+         while (s->left)
+            s = s->left;
+         if constexpr (Counted) {
+            add(s->parent, node, -own(s));
+            s->count = node->count - own(node);
+         }
+         if (s == node->right) {
+            start = s;
+         } else {
+            start = s->parent;
+            start->left = s->right;
+            if (s->right)
+               s->right->parent = start;
+            s->right = node->right;
+            s->right->parent = s;
+         }
+         s->left = node->left;
+         s->left->parent = s;
+         s->height = node->height;
+         replace_child(node->parent, node, s);
+      } else {
+         TreeHook* child = node->left ? node->left : node->right;
+         replace_child(node->parent, node, child);
+         start = node->parent;
+      }
+      rebalance(start);
+   }
+
+   // Odcięcie wszystkich węzłów od pierwszego do last włącznie (węzły nie
+   // są zwalniane, ich zaczepy przestają być ważne). Pozostałe węzły to
+   // prawe poddrzewa przodków last, od których ścieżka skręca w lewo -
+   // łączymy je od dołu. [O(log n)]
+   void cut_front(TreeHook* last) noexcept {
+      TreeHook* first = next(last);
+      TreeHook* rest = detach(last->right);
+      for (TreeHook *c = last, *a = last->parent; a;) {
+         TreeHook* up = a->parent;
+         if (a->left == c)
+            rest = join(rest, a, detach(a->right));
+         c = a;
+         a = up;
+      }
+      root_ = rest;
+      leftmost_ = first;
+      if (!rest)
+         rightmost_ = nullptr;
+   }
+
+   // Odcięcie wszystkich węzłów od first do ostatniego włącznie, symetrycznie
+   // do cut_front. [O(log n)]
+   void cut_back(TreeHook* first) noexcept {
+      TreeHook* last = prev(first);
+      TreeHook* rest = detach(first->left);
+      for (TreeHook *c = first, *a = first->parent; a;) {
+         TreeHook* up = a->parent;
+         if (a->right == c)
+            rest = join(detach(a->left), a, rest);
+         c = a;
+         a = up;
+      }
+      root_ = rest;
+      rightmost_ = last;
+      if (!rest)
+         leftmost_ = nullptr;
+   }
+
+   // Odpięcie pierwszego węzła bez równoważenia - jego miejsce zajmuje
+   // prawe poddrzewo. Kolejne wywołania przesuwają się po lewym brzegu
+   // drzewa, na którym wysokości i liczności są odtąd nieaktualne, dopóki
+   // mend_front go nie naprawi; pozostałe poddrzewa są nietknięte. [O(1)
+   // zamortyzowane przy przejściu wielu węzłów]
+   void drop_first() noexcept {
+      TreeHook* h = leftmost_;
+      leftmost_ = next_ahead(h);
+      replace_child(h->parent, h, h->right);
+      if (!root_)
+         rightmost_ = nullptr;
+   }
+
+   // Odpięcie ostatniego węzła, symetrycznie do drop_first.
+   void drop_last() noexcept {
+      TreeHook* h = rightmost_;
+      rightmost_ = prev_ahead(h);
+      replace_child(h->parent, h, h->left);
+      if (!root_)
+         leftmost_ = nullptr;
+   }
+
+   // Naprawa lewego brzegu po drop_first: łączymy od dołu węzły brzegu
+   // z ich prawymi poddrzewami, jak w cut_front. [O(log n)]
+   void mend_front() noexcept {
+      TreeHook* rest = nullptr;
+      for (TreeHook* a = leftmost_; a;) {
+         TreeHook* up = a->parent;
+         rest = join(rest, a, detach(a->right));
+         a = up;
+      }
+      root_ = rest;
+   }
+
+   // Naprawa prawego brzegu po drop_last.
+   void mend_back() noexcept {
+      TreeHook* rest = nullptr;
+      for (TreeHook* a = rightmost_; a;) {
+         TreeHook* up = a->parent;
+         rest = join(detach(a->left), a, rest);
+         a = up;
+      }
+      root_ = rest;
+   }
+
+   // Budowa drzewa z węzłów podanych w porządku drzewa. [O(n)]
+   void build(TreeHook* const* begin, TreeHook* const* end) noexcept {
+      root_ = build(begin, end, nullptr);
+      leftmost_ = begin != end ? *begin : nullptr;
+      rightmost_ = begin != end ? *(end - 1) : nullptr;
+   }
+
+   // Przejście post-order, w którym wolno zwolnić odwiedzany węzeł
+   // (drzewo zostaje przy tym rozebrane). [O(n)]
+   template<typename F>
+   void dispose(F f) noexcept {
+      TreeHook* h = root_;
+      while (h) {
+         if (h->left) {
+            h = h->left;
+         } else if (h->right) {
+            h = h->right;
+         } else {
+            TreeHook* p = h->parent;
+            if (p) {
+               if (p->left == h)
+                  p->left = nullptr;
+               else
+                  p->right = nullptr;
+            }
+            f(h);
+            h = p;
+         }
+      }
+      reset();
+   }
+
+   void reset() noexcept {
+      root_ = leftmost_ = rightmost_ = nullptr;
+   }
+
+   void swap(BasicTree& tree) noexcept {
+      std::swap(root_, tree.root_);
+      std::swap(leftmost_, tree.leftmost_);
+      std::swap(rightmost_, tree.rightmost_);
+   }
+
+private:
+
+   static int height(const TreeHook* h) noexcept {
+      return h ? h->height : 0;
+   }
+
+   static void update(TreeHook* h) noexcept {
+      h->height = 1 + std::max(height(h->left), height(h->right));
+      if constexpr (Counted)
+         h->count = own(h) + count(h->left) + count(h->right);
+   }
+
+   // Dodanie n (modulo 2^32) do liczników na ścieżce od h do stop.
+   static void add(TreeHook* h, TreeHook* stop, uint32_t n) noexcept {
+      for (; h != stop; h = h->parent)
+         h->count += n;
+   }
+
+   void replace_child(TreeHook* parent, TreeHook* old,
+                      TreeHook* node) noexcept {
+      if (node)
+         node->parent = parent;
+      if (!parent)
+         root_ = node;
+      else if (parent->left == old)
+         parent->left = node;
+      else
+         parent->right = node;
+   }
+
+   TreeHook* rotate_left(TreeHook* h) noexcept {
+      TreeHook* r = h->right;
+      h->right = r->left;
+      if (r->left)
+         r->left->parent = h;
+      replace_child(h->parent, h, r);
+      r->left = h;
+      h->parent = r;
+      update(h);
+      update(r);
+      return r;
+   }
+
+   TreeHook* rotate_right(TreeHook* h) noexcept {
+      TreeHook* l = h->left;
+      h->left = l->right;
+      if (l->right)
+         l->right->parent = h;
+      replace_child(h->parent, h, l);
+      l->right = h;
+      h->parent = l;
+      update(h);
+      update(l);
+      return l;
+   }
+
+   // Przywrócenie warunku AVL na ścieżce od h do korzenia. Gdy wysokość
+   // poddrzewa (po ewentualnej rotacji) się nie zmieniła, wyżej nic się nie
+   // zmienia - przejście kończy się wcześniej.
+   void rebalance(TreeHook* h) noexcept {
+      while (h) {
+         int old = h->height;
+         update(h);
+         int balance = height(h->left) - height(h->right);
+         if (balance > 1) {
+            if (height(h->left->left) < height(h->left->right))
+               rotate_left(h->left);
+            h = rotate_right(h);
+         } else if (balance < -1) {
+            if (height(h->right->right) < height(h->right->left))
+               rotate_right(h->right);
+            h = rotate_left(h);
+         }
+         if (h->height == old)
+            return;
+         h = h->parent;
+      }
+   }
+
+   // Odłączenie poddrzewa h od rodzica (rodzic nie jest zmieniany).
+   static TreeHook* detach(TreeHook* h) noexcept {
+      if (h)
+         h->parent = nullptr;
+      return h;
+   }
+
+   // Złączenie odłączonych drzew l i r przez węzeł k (l < k < r) w jedno
+   // drzewo AVL; zwraca jego korzeń. Niższe drzewo zastępuje na brzegu
+   // wyższego poddrzewo o zbliżonej wysokości, a rebalance naprawia ścieżkę
+   // w górę - root_ wskazuje przy tym wyższe drzewo.
+   // [O(|height(l) - height(r)| + 1)]
+   TreeHook* join(TreeHook* l, TreeHook* k, TreeHook* r) noexcept {
+      if (height(l) > height(r) + 1) {
+         TreeHook *p = nullptr, *c = l;
+         while (height(c) > height(r) + 1) {
+            p = c;
+            c = c->right;
+         }
+         attach(k, c, r);
+         p->right = k;
+         k->parent = p;
+         root_ = l;
+         if constexpr (Counted)
+            add(p, nullptr, own(k) + count(r));
+         rebalance(p);
+         return root_;
+      }
+      if (height(r) > height(l) + 1) {
+         TreeHook *p = nullptr, *c = r;
+         while (height(c) > height(l) + 1) {
+            p = c;
+            c = c->left;
+         }
+         attach(k, l, c);
+         p->left = k;
+         k->parent = p;
+         root_ = r;
+         if constexpr (Counted)
+            add(p, nullptr, own(k) + count(l));
+         rebalance(p);
+         return root_;
+      }
+      attach(k, l, r);
+      k->parent = nullptr;
+      return k;
+   }
+
+   static void attach(TreeHook* k, TreeHook* l, TreeHook* r) noexcept {
+      k->left = l;
+      k->right = r;
+      if (l)
+         l->parent = k;
+      if (r)
+         r->parent = k;
+      update(k);
+   }
+
+   static TreeHook* build(TreeHook* const* begin, TreeHook* const* end,
+                          TreeHook* parent) noexcept {
+      if (begin == end)
+         return nullptr;
+      TreeHook* const* mid = begin + (end - begin) / 2;
+      TreeHook* h = *mid;
+      h->parent = parent;
+      h->left = build(begin, mid, h);
+      h->right = build(mid + 1, end, h);
+      update(h);
+      return h;
+   }
+
+   TreeHook* root_ = nullptr;
+   TreeHook* leftmost_ = nullptr;
+   TreeHook* rightmost_ = nullptr;
+};
+
+using Tree = BasicTree<false>;
+using CountedTree = BasicTree<true>;
+
+// Odwzorowanie węzeł źródłowy -> kopia używane przy kopiowaniu kolejki
+// (adresowanie otwarte, jedna alokacja). [O(1) oczekiwanie na operację]
+class NodeMap {
+
+public:
+
+   explicit NodeMap(size_t n) {
+      size_t capacity = 16;
+      while (capacity < 2 * n)
+         capacity *= 2;
+      slots.assign(capacity, Slot{nullptr, nullptr});
+   }
+
+   void insert(const void* from, void* to) noexcept {
+      size_t i = index(from);
+      while (slots[i].from)
+         i = (i + 1) & (slots.size() - 1);
+      slots[i] = Slot{from, to};
+   }
+
+   void* find(const void* from) const noexcept {
+      size_t i = index(from);
+      while (slots[i].from != from)
+         i = (i + 1) & (slots.size() - 1);
+      return slots[i].to;
+   }
+
+private:
+
+   struct Slot {
+      const void* from;
+      void* to;
+   };
+
+   size_t index(const void* p) const noexcept {
+      uint64_t h = reinterpret_cast<uintptr_t>(p);
+      h = (h >> 4) * 0x9E3779B97F4A7C15ull;
+      return static_cast<size_t>(h >> 20) & (slots.size() - 1);
+   }
+
+   std::vector<Slot> slots;
+};
+
+// Stabilne sortowanie dzielące zakres na części sortowane równolegle
+// (std::async) i scalane w miejscu. Krótkie zakresy są sortowane w bieżącym
+// wątku. Wyjątek z porównania jest przekazywany dalej po zakończeniu
+// wszystkich wątków. [O(n log n)]
+template<typename It, typename Less>
+void parallel_stable_sort(It first, It last, Less less, unsigned threads) {
+   const ptrdiff_t sequential = 1 << 15;
+   if (threads < 2 || last - first < sequential) {
+      std::stable_sort(first, last, less);
+      return;
+   }
+   It mid = first + (last - first) / 2;
+   auto left = std::async(std::launch::async, [=] {
+      parallel_stable_sort(first, mid, less, threads / 2);
+   });
+   parallel_stable_sort(mid, last, less, threads - threads / 2);
+   left.get();
+   std::inplace_merge(first, mid, last, less);
+}
+
+template<typename It, typename Less>
+void parallel_stable_sort(It first, It last, Less less) {
+   parallel_stable_sort(first, last, less,
+                        std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Czy wartość typu KK może służyć do wyszukiwania klucza typu K bez
+// konwersji na K: oba porównania operatorem < muszą być dostępne. Typy
+// arytmetyczne są wyłączone - porównanie np. int z double nie jest
+// równoważne porównaniu po konwersji, a konwersja nie alokuje pamięci.
+template<typename K, typename KK, typename = void>
+struct is_lookup_key: std::false_type {};
+
+template<typename K, typename KK>
+struct is_lookup_key<K, KK, std::void_t<
+   decltype(bool(std::declval<const K&>() < std::declval<const KK&>())),
+   decltype(bool(std::declval<const KK&>() < std::declval<const K&>()))>>
+   : std::integral_constant<bool, !std::is_same<K, KK>::value &&
+                                  !std::is_arithmetic<KK>::value> {};
+
+// Czy porównanie operatorem < wartości typu T nie zgłasza wyjątków (typy
+// wbudowane oraz typy z operatorem < oznaczonym noexcept).
+template<typename T>
+struct is_nothrow_less: std::integral_constant<bool, noexcept(
+   bool(std::declval<const T&>() < std::declval<const T&>()))> {};
+
+// Czy zapis pary P (jako rvalue) przez iterator wyjściowy It nie narusza
+// jej, gdy zgłasza wyjątek: zapis nie zgłasza wyjątków albo wstawia parę
+// do kontenera elementów typu P przenoszonych bez wyjątków - wyjątek może
+// wtedy pochodzić tylko z alokacji, przed przeniesieniem pary.
+template<typename It, typename P>
+struct keeps_pair_on_throw: std::integral_constant<bool, noexcept(
+   *std::declval<It&>() = std::declval<P&&>())> {};
+
+template<typename C, typename P>
+struct inserts_whole_pair
+   : std::integral_constant<bool,
+                            std::is_same<typename C::value_type, P>::value &&
+                            std::is_nothrow_move_constructible<P>::value> {};
+
+template<typename C, typename P>
+struct keeps_pair_on_throw<std::back_insert_iterator<C>, P>
+   : inserts_whole_pair<C, P> {};
+
+template<typename C, typename P>
+struct keeps_pair_on_throw<std::front_insert_iterator<C>, P>
+   : inserts_whole_pair<C, P> {};
+
+template<typename C, typename P>
+struct keeps_pair_on_throw<std::insert_iterator<C>, P>
+   : inserts_whole_pair<C, P> {};
+
+// Nagłówek pliku migawki (64 bajty). Za nim, od przesunięcia 64, leżą pary
+// w porządku wartości: rekordy {K, V} stałej długości (format raw, dla
+// typów trywialnie kopiowalnych z domyślnym serializatorem) lub ciąg bajtów
+// z serializatorów (format serialized). Dalej, od przesunięcia
+// wyrównanego do 8 bajtów, tablica uint64_t: indeksy par w porządku kluczy.
+// Suma kontrolna obejmuje wszystko za nagłówkiem. Liczby są zapisane
+// w kolejności bajtów maszyny, która zapisała plik (pole endian).
+struct SnapshotHeader {
+   static constexpr uint32_t current_version = 1;
+   static constexpr uint32_t raw = 0, serialized = 1;
+
+   char magic[8];
+   uint32_t version;
+   uint32_t endian;
+   uint32_t format;
+   uint32_t key_size;
+   uint32_t value_size;
+   uint32_t record_size;
+   uint64_t count;
+   uint64_t records_bytes;
+   uint64_t order_offset;
+   uint64_t checksum;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader: 64 bajty");
+
+constexpr char snapshot_magic[8] = {'P', 'Q', 'S', 'N', 'A', 'P', '\r', '\n'};
+constexpr uint32_t snapshot_endian = 0x01020304;
+
+// Suma kontrolna FNV-1a liczona na słowach 8-bajtowych (i bajtach końcówki).
+// Wynik zależy od podziału danych na części, dlatego zapis przekazuje je
+// w częściach o długościach podzielnych przez 8.
+inline uint64_t snapshot_checksum(uint64_t hash, const char* p, size_t n) {
+   const uint64_t prime = 0x100000001B3ull;
+   for (; n >= 8; p += 8, n -= 8) {
+      uint64_t word;
+      std::memcpy(&word, p, 8);
+      hash = (hash ^ word) * prime;
+   }
+   for (; n > 0; ++p, --n)
+      hash = (hash ^ static_cast<unsigned char>(*p)) * prime;
+   return hash;
+}
+
+constexpr uint64_t snapshot_checksum_seed = 0xCBF29CE484222325ull;
+
+// Buforowany zapis pliku migawki z liczeniem sumy kontrolnej. Plik powstaje
+// pod nazwą tymczasową i zastępuje docelowy dopiero w commit(), więc
+// przerwany zapis nie niszczy poprzedniej migawki.
+class SnapshotWriter {
+
+public:
+
+   explicit SnapshotWriter(const std::string& path)
+      : path(path), temporary(path + ".tmp"), buffer(1 << 16) {
+      file = std::fopen(temporary.c_str(), "wb");
+      if (!file)
+         throw PriorityQueueSnapshotException();
+      SnapshotHeader empty{};
+      if (std::fwrite(&empty, sizeof(empty), 1, file) != 1)
+         fail();
+   }
+
+   SnapshotWriter(const SnapshotWriter&) = delete;
+
+   SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+   ~SnapshotWriter() {
+      if (file) {
+         std::fclose(file);
+         std::remove(temporary.c_str());
+      }
+   }
+
+   void write(const void* data, size_t n) {
+      const char* p = static_cast<const char*>(data);
+      while (n > 0) {
+         size_t chunk = std::min(n, buffer.size() - used);
+         std::memcpy(buffer.data() + used, p, chunk);
+         used += chunk;
+         p += chunk;
+         n -= chunk;
+         if (used == buffer.size())
+            flush();
+      }
+   }
+
+   // Dopełnienie zerami do wielokrotności alignment bajtów od początku
+   // danych za nagłówkiem.
+   void pad(size_t alignment) {
+      static const char zeros[8] = {};
+      while ((written + used) % alignment != 0)
+         write(zeros, 1);
+   }
+
+   // Liczba bajtów zapisanych za nagłówkiem.
+   uint64_t size() const {
+      return written + used;
+   }
+
+   // Zapis nagłówka z sumą kontrolną i zamiana pliku tymczasowego na
+   // docelowy.
+   void commit(SnapshotHeader header) {
+      flush();
+      header.checksum = hash;
+      if (std::fseek(file, 0, SEEK_SET) != 0 ||
+          std::fwrite(&header, sizeof(header), 1, file) != 1)
+         fail();
+      int result = std::fclose(file);
+      file = nullptr;
+      if (result != 0 || std::rename(temporary.c_str(), path.c_str()) != 0) {
+         std::remove(temporary.c_str());
+         throw PriorityQueueSnapshotException();
+      }
+   }
+
+private:
+
+   void flush() {
+      if (used == 0)
+         return;
+      hash = snapshot_checksum(hash, buffer.data(), used);
+      if (std::fwrite(buffer.data(), 1, used, file) != used)
+         fail();
+      written += used;
+      used = 0;
+   }
+
+   [[noreturn]] void fail() {
+      throw PriorityQueueSnapshotException();
+   }
+
+   std::string path;
+   std::string temporary;
+   std::vector<char> buffer;
+   size_t used = 0;
+   uint64_t written = 0;
+   uint64_t hash = snapshot_checksum_seed;
+   std::FILE* file = nullptr;
+};
+
+// Plik migawki w pamięci: odwzorowany przez mmap (systemy uniksowe) albo
+// wczytany w całości.
+class MappedFile {
+
+public:
+
+   explicit MappedFile(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+         throw PriorityQueueSnapshotException();
+      struct stat info;
+      if (::fstat(fd, &info) != 0) {
+         ::close(fd);
+         throw PriorityQueueSnapshotException();
+      }
+      size_ = static_cast<size_t>(info.st_size);
+      if (size_ > 0) {
+         void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (p != MAP_FAILED)
+            mapped = static_cast<const char*>(p);
+      }
+      ::close(fd);
+      if (mapped || size_ == 0)
+         return;
+#endif
+      std::FILE* file = std::fopen(path.c_str(), "rb");
+      if (!file)
+         throw PriorityQueueSnapshotException();
+      std::vector<char> data;
+      char chunk[1 << 14];
+      size_t n;
+      while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+         data.insert(data.end(), chunk, chunk + n);
+      bool error = std::ferror(file);
+      std::fclose(file);
+      if (error)
+         throw PriorityQueueSnapshotException();
+      copy.swap(data);
+      size_ = copy.size();
+   }
+
+   MappedFile(const MappedFile&) = delete;
+
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+      if (mapped)
+         ::munmap(const_cast<char*>(mapped), size_);
+#endif
+   }
+
+   const char* data() const {
+      return mapped ? mapped : copy.data();
+   }
+
+   size_t size() const {
+      return size_;
+   }
+
+private:
+
+   const char* mapped = nullptr;
+   std::vector<char> copy;
+   size_t size_ = 0;
+};
+
+// Liczniki operacji przechowywane w kolejce jako klasa bazowa. Wersja
+// wyłączona jest pusta (optymalizacja pustej klasy bazowej), a jej metody
+// nic nie robią, więc nie zmienia ani rozmiaru kolejki, ani kodu operacji.
+template<bool Enabled>
+class OperationCounters {
+
+protected:
+
+   void record(size_t PriorityQueueStats::*, size_t = 1) const noexcept {}
+};
+
+template<>
+class OperationCounters<true> {
+
+protected:
+
+   void record(size_t PriorityQueueStats::* field,
+               size_t n = 1) const noexcept {
+      counters.*field += n;
+   }
+
+   mutable PriorityQueueStats counters;
+};
+
+} // namespace pq_detail
+
+/*============================================================================*/
+/*                                Interfejs.                                  */
+/*============================================================================*/
+
+// Strategia reprezentacji kolejki (parametr Backend) - dwa indeksy na
+// węzłach intruzyjnych, z pełnym interfejsem (domyślna). Inne strategie są
+// dostarczane jako specjalizacje PriorityQueue w osobnych nagłówkach.
+struct IndexedBackend {};
+
+// Strategia IndexedBackend z licznikami operacji dostępnymi przez stats().
+struct InstrumentedBackend {};
+
+// Strategia IndexedBackend, w której indeks wartości pamięta liczności
+// poddrzew: kthValue, rankOf, countInRange, median i nth działają
+// w O(log n). Utrzymanie liczników wydłuża każde wstawienie i usunięcie
+// o przejście ścieżki do korzenia.
+struct OrderStatisticBackend {};
+
+template<typename K, typename V,
+         typename Allocator = std::allocator<std::pair<const K, V>>,
+         typename Backend = IndexedBackend>
+class PriorityQueue: private pq_detail::OperationCounters<
+   std::is_same<Backend, InstrumentedBackend>::value> {
+
+   static_assert(std::is_same<Backend, IndexedBackend>::value ||
+                 std::is_same<Backend, InstrumentedBackend>::value ||
+                 std::is_same<Backend, OrderStatisticBackend>::value,
+                 "PriorityQueue: nieznana strategia (brak nagłówka?)");
+
+   // Czy indeks wartości ma liczniki poddrzew (OrderStatisticBackend).
+   static constexpr bool ranked =
+      std::is_same<Backend, OrderStatisticBackend>::value;
+
+   // Czy operacje są zliczane (InstrumentedBackend).
+   static constexpr bool instrumented =
+      std::is_same<Backend, InstrumentedBackend>::value;
+
+   // Warunek dla metod wyszukujących klucz typu KK (pq_detail::is_lookup_key).
+   template<typename KK>
+   using lookup_t =
+      typename std::enable_if<pq_detail::is_lookup_key<K, KK>::value>::type;
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using allocator_type = Allocator;
+
+   class handle_type;
+
+   template<bool ByValue>
+   class basic_iterator;
+
+   // Iteratory po parach w porządku wartości i w porządku kluczy.
+   using value_iterator = basic_iterator<true>;
+   using key_iterator = basic_iterator<false>;
+   using const_iterator = value_iterator;
+
+   template<typename It>
+   class range_view;
+
+   /**
+    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
+    */
+   PriorityQueue() {}
+
+   /**
+    * Konstruktor tworzący pustą kolejkę, której węzły będą pochodziły
+    * z alokatora alloc (np. PoolAllocator z poolallocator.hh). [O(1)]
+    */
+   explicit PriorityQueue(const Allocator& alloc);
+
+   /**
+    * Konstruktor wczytujący pary (klucz, wartość) z zakresu [first, last)
+    * (elementy z polami first i second, np. std::pair<K, V>). Oba indeksy są
+    * budowane od dołu w czasie liniowym; jeśli zakres nie jest posortowany
+    * po kluczach lub po wartościach, węzły są najpierw sortowane równolegle.
+    * Wynik jest taki sam jak przy wstawianiu par po kolei. Przy sortowaniu
+    * równoległym porównania K i V są wywoływane współbieżnie.
+    * [O(n), a dla nieposortowanych danych O(n log n)]
+    */
+   template<typename InputIt>
+   PriorityQueue(InputIt first, InputIt last,
+                 const Allocator& alloc = Allocator());
+
+   /**
+    * Konstruktor kopiujący. [O(queue.size())]
+    */
+   PriorityQueue(const PriorityQueue<K, V, Allocator, Backend>& queue);
+
+   /**
+    * Konstruktor przenoszący. [O(1)]
+    */
+   PriorityQueue(PriorityQueue<K, V, Allocator, Backend>&& queue);
+
+   /**
+    * Destruktor zwalniający wszystkie węzły. [O(size())]
+    */
+   ~PriorityQueue();
+
+   /**
+    * Operator przypisania.
+    * [O(queue.size()) dla użycia P = Q, a O(1) dla użycia P = move(Q)]
+    */
+   PriorityQueue<K, V, Allocator, Backend>& operator=(
+      PriorityQueue<K, V, Allocator, Backend> queue);
+
+   /**
+    * Metoda zastępująca zawartość kolejki parami z zakresu [first, last),
+    * jak konstruktor zakresowy. [O(n), a dla nieposortowanych danych
+    * O(n log n)]
+    */
+   template<typename InputIt>
+   void assign(InputIt first, InputIt last);
+
+   /**
+    * Metoda zwracająca kopię alokatora kolejki. [O(1)]
+    */
+   allocator_type get_allocator() const;
+
+   /**
+    * Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta. [O(1)]
+    */
+   bool empty() const;
+
+   /**
+    * Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce.
+    * [O(1)]
+    */
+   size_type size() const;
+
+   /**
+    * Metoda wstawiająca do kolejki parę o kluczu key i wartości value
+    * [O(log size())] (dopuszczamy możliwość występowania w kolejce wielu
+    * par o tym samym kluczu). Wykonuje dokładnie jedną alokację.
+    * Zwraca uchwyt do wstawionej pary.
+    */
+   handle_type insert(const K& key, const V& value);
+
+   /**
+    * Wersja insert przejmująca klucz i wartość (przenoszone do węzła bez
+    * kopiowania) [O(log size())]. Pozycja jest wyszukiwana przed
+    * przeniesieniem, więc wyjątek z porównania pozostawia key i value
+    * nietknięte.
+    */
+   handle_type insert(K&& key, V&& value);
+
+   /**
+    * Metody wstawiające parę konstruowaną w miejscu, wewnątrz węzła:
+    * z argumentów key i value lub z krotek argumentów konstruktorów K i V
+    * (std::piecewise_construct). [O(log size())]
+    */
+   template<typename KK, typename VV>
+   handle_type emplace(KK&& key, VV&& value);
+
+   template<typename... KArgs, typename... VArgs>
+   handle_type emplace(std::piecewise_construct_t,
+                       std::tuple<KArgs...> key_args,
+                       std::tuple<VArgs...> value_args);
+
+   /**
+    * Metody zwracające odpowiednio najmniejszą i największą wartość
+    * przechowywaną w kolejce [O(1)]; w przypadku wywołania którejś z tych metod
+    * na pustej strukturze powinien zostać zgłoszony wyjątek
+    * PriorityQueueEmptyException.
+    */
+   const V& minValue() const;
+
+   const V& maxValue() const;
+
+   /**
+    * Metody zwracające klucz o przypisanej odpowiednio najmniejszej lub
+    * największej wartości [O(1)]; w przypadku wywołania którejś z tych metod
+    * na pustej strukturze powinien zostać zgłoszony wyjątek
+    * PriorityQueueEmptyException.
+    */
+   const K& minKey() const;
+
+   const K& maxKey() const;
+
+   /**
+    * Metody usuwające z kolejki jedną parę o odpowiednio najmniejszej lub
+    * największej wartości. [O(log size())] Nie wykonują porównań.
+    */
+   void deleteMin();
+
+   void deleteMax();
+
+   /**
+    * Metody usuwające z kolejki parę o odpowiednio najmniejszej lub
+    * największej wartości i zwracające ją (klucz i wartość są przenoszone,
+    * jeśli przeniesienie obu nie zgłasza wyjątków, a w przeciwnym razie
+    * kopiowane) [O(log size())]. Nie wykonują porównań ani wyszukiwań;
+    * w przypadku pustej kolejki zgłaszają wyjątek PriorityQueueEmptyException.
+    * Jeśli przeniesienie pary zgłosi wyjątek, kolejka pozostaje bez zmian.
+    */
+   std::pair<K, V> popMin();
+
+   std::pair<K, V> popMax();
+
+   /**
+    * Wersje popMin i popMax zwracające std::nullopt dla pustej kolejki
+    * zamiast zgłaszać wyjątek. [O(log size())]
+    */
+   std::optional<std::pair<K, V>> tryPopMin();
+
+   std::optional<std::pair<K, V>> tryPopMax();
+
+   /**
+    * Metoda wstawiająca pary z zakresu [first, last) (elementy z polami
+    * first i second). Paczka jest sortowana, a następnie - jeśli jest
+    * co najmniej dwa razy większa od kolejki - scalana z indeksami w jednym
+    * przejściu i oba indeksy są budowane od nowa, a w przeciwnym razie
+    * wstawiana do każdego indeksu w jego porządku, z wyszukiwaniem od
+    * poprzednio wstawionej pary. Wynik jest taki sam jak przy kolejnych
+    * wywołaniach insert; przy wyjątku kolejka pozostaje bez zmian.
+    * [O(m log (size() + m)) dla m par]
+    */
+   template<typename InputIt>
+   void insertBatch(InputIt first, InputIt last);
+
+   /**
+    * Metody usuwające z kolejki (co najwyżej) n par o najmniejszych lub
+    * największych wartościach i zapisujące je do out w kolejności
+    * usuwania (jak kolejne popMin lub popMax). Pary są zdejmowane ze
+    * skraju indeksu wartości bez równoważenia go po każdej z nich - jest on
+    * naprawiany raz, na końcu - a gdy usuwane pary stanowią większość
+    * kolejki, indeks wartości jest cięty raz, za n-tą parą, a indeks kluczy
+    * budowany od nowa z pozostałych par. Zwracają iterator za ostatnią
+    * zapisaną parą. Jeśli zapis do out zgłosi wyjątek, pary zapisane
+    * wcześniej są usunięte, a pozostałe (łącznie z zapisywaną) zostają
+    * w kolejce bez zmian.
+    * [O(n log size()), przy n >= 2/3 size() O(size())]
+    */
+   template<typename OutputIt>
+   OutputIt extractMin(size_type n, OutputIt out);
+
+   template<typename OutputIt>
+   OutputIt extractMax(size_type n, OutputIt out);
+
+   /**
+    * Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową
+    * wartość value [O(log size())]; w przypadku gdy w kolejce nie ma pary
+    * o kluczu key, powinien zostać zgłoszony wyjątek
+    * PriorityQueueNotFoundException(); w przypadku kiedy w kolejce jest kilka
+    * par o kluczu key, zmienia wartość w dowolnie wybranej parze o podanym
+    * kluczu.
+    */
+   void changeValue(const K& key, const V& value);
+
+   void changeValue(const K& key, V&& value);
+
+   /**
+    * Wersje changeValue, find, contains i count przyjmujące klucz innego
+    * typu KK porównywalnego z K operatorem < w obie strony (np.
+    * std::string_view lub const char* dla K = std::string). Wyszukiwanie
+    * odbywa się bez tworzenia obiektu K.
+    */
+   template<typename KK, typename = lookup_t<KK>>
+   void changeValue(const KK& key, const V& value);
+
+   template<typename KK, typename = lookup_t<KK>>
+   void changeValue(const KK& key, V&& value);
+
+   /**
+    * Metoda zwracająca uchwyt do pary o kluczu key (przy kilku takich parach
+    * - do pary o najmniejszej wartości) lub domyślny uchwyt, gdy w kolejce
+    * nie ma takiej pary. [O(log size())]
+    */
+   handle_type find(const K& key) const;
+
+   template<typename KK, typename = lookup_t<KK>>
+   handle_type find(const KK& key) const;
+
+   /**
+    * Metoda sprawdzająca, czy w kolejce jest para o kluczu key.
+    * [O(log size())]
+    */
+   bool contains(const K& key) const;
+
+   template<typename KK, typename = lookup_t<KK>>
+   bool contains(const KK& key) const;
+
+   /**
+    * Metoda zwracająca liczbę par o kluczu key. [O(log size() + wynik)]
+    */
+   size_type count(const K& key) const;
+
+   template<typename KK, typename = lookup_t<KK>>
+   size_type count(const KK& key) const;
+
+   /**
+    * Metoda zmieniająca wartość pary wskazanej uchwytem handle na value, bez
+    * wyszukiwania klucza [O(log size())]. Zwraca uchwyt do zmienionej pary;
+    * jeśli przypisanie przenoszące V nie zgłasza wyjątków, para jest
+    * modyfikowana w miejscu (bez alokacji) i uchwyt pozostaje ten sam,
+    * w przeciwnym razie para jest zastępowana nową, a stary uchwyt traci
+    * ważność.
+    */
+   handle_type update(handle_type handle, const V& value);
+
+   handle_type update(handle_type handle, V&& value);
+
+   /**
+    * Metoda usuwająca z kolejki parę wskazaną uchwytem handle.
+    * [O(log size()), w trybie leniwym O(1) zamortyzowane]
+    */
+   void erase(handle_type handle);
+
+   /**
+    * Metoda usuwająca parę o kluczu key (spośród kilku - tę o najmniejszej
+    * wartości, jak changeValue). Zwraca false, jeśli w kolejce nie ma pary
+    * o kluczu key. [O(log size())]
+    */
+   bool eraseKey(const K& key);
+
+   /**
+    * Metoda usuwająca wszystkie pary o kluczu key; zwraca ich liczbę.
+    * [O(log size() + wynik * log size()), w trybie leniwym
+    * O(log size() + wynik)]
+    */
+   size_type eraseAll(const K& key);
+
+   /**
+    * Metoda włączająca (enabled == true) lub wyłączająca tryb leniwego
+    * usuwania. W tym trybie erase, eraseKey i eraseAll tylko oznaczają parę
+    * jako usuniętą, bez odpinania węzła od indeksów (ze strategią
+    * OrderStatisticBackend poprawiane są liczniki na ścieżce do korzenia
+    * - O(log size())); oznaczone pary są
+    * pomijane przez wszystkie operacje, a skrajne pary porządku wartości są
+    * zawsze żywe, więc minValue, maxValue, deleteMin i deleteMax działają
+    * bez zmian. Gdy oznaczonych par jest więcej niż max_tombstone_ratio
+    * wszystkich węzłów, oba indeksy są przebudowywane bez nich w jednym
+    * przejściu (kompaktowanie); domyślnie oznaczonych par jest najwyżej
+    * tyle, co żywych. Opłaca się przy masowych anulowaniach par (zob.
+    * bench/cancel.cc); wyłączenie trybu kompaktuje kolejkę od razu.
+    * [O(size())]
+    */
+   void setLazyErase(bool enabled, double max_tombstone_ratio = 0.5);
+
+   /**
+    * Metody zwracające wartość i klucz pary wskazanej uchwytem handle. [O(1)]
+    */
+   const V& value(handle_type handle) const;
+
+   const K& key(handle_type handle) const;
+
+   /**
+    * Metody zwracające iteratory po parach w porządku wartości: begin()
+    * wskazuje parę minValue, std::prev(end()) - parę maxValue; równe
+    * wartości w kolejności wstawiania. Przejście nie kopiuje par ani
+    * kolejki. [O(1)]
+    */
+   value_iterator begin() const;
+
+   value_iterator end() const;
+
+   /**
+    * Metody zwracające iteratory po parach w porządku kluczy (równe klucze
+    * rosnąco po wartościach). [O(1), w trybie leniwym O(1) zamortyzowane]
+    */
+   key_iterator keyBegin() const;
+
+   key_iterator keyEnd() const;
+
+   /**
+    * Metoda zwracająca widok wszystkich par w porządku kluczy, np. do pętli
+    * for (auto [key, value] : queue.keys()). [O(1)]
+    */
+   range_view<key_iterator> keys() const;
+
+   /**
+    * Metoda zwracająca widok par o wartościach z przedziału [lo, hi),
+    * w porządku wartości; dla hi <= lo widok jest pusty. [O(log size())]
+    */
+   range_view<value_iterator> valueRange(const V& lo, const V& hi) const;
+
+   /**
+    * Statystyki pozycyjne wartości (tylko ze strategią
+    * OrderStatisticBackend). Metoda nth zwraca iterator do pary o pozycji k
+    * (od 0) w porządku wartości lub end(), gdy k >= size(). [O(log size())]
+    */
+   value_iterator nth(size_type k) const;
+
+   /**
+    * Metoda zwracająca wartość pary o pozycji k (od 0) w porządku wartości,
+    * tj. wartość, od której mniejszych lub równych jest co najmniej k + 1
+    * par (powtórzone wartości zajmują kolejne pozycje). Dla k >= size()
+    * zgłasza PriorityQueueNotFoundException. [O(log size())]
+    */
+   const V& kthValue(size_type k) const;
+
+   /**
+    * Metoda zwracająca liczbę par o wartości mniejszej od value, czyli
+    * pozycję pierwszej pary o wartości value, jeśli taka jest (wtedy
+    * kthValue(rankOf(value)) == value). [O(log size())]
+    */
+   size_type rankOf(const V& value) const;
+
+   /**
+    * Metoda zwracająca liczbę par o wartościach z przedziału [lo, hi) - jak
+    * valueRange, ale bez przechodzenia par. [O(log size())]
+    */
+   size_type countInRange(const V& lo, const V& hi) const;
+
+   /**
+    * Metoda zwracająca medianę wartości (dolną przy parzystej liczbie par:
+    * kthValue((size() - 1) / 2)). Dla pustej kolejki zgłasza
+    * PriorityQueueEmptyException. [O(log size())]
+    */
+   const V& median() const;
+
+   /**
+    * Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja
+    * usuwa wszystkie elementy z kolejki queue i wstawia je do kolejki *this.
+    * [O(queue.size() * log (queue.size() + size()))] Przy równych
+    * alokatorach węzły są przepinane bez kopiowania i realokacji, a uchwyty
+    * do par z queue wskazują po scaleniu te same pary w *this.
+    */
+   void merge(PriorityQueue<K, V, Allocator, Backend>& queue);
+
+   /**
+    * Metoda zamieniającą zawartość kolejki z podaną kolejką queue (tak jak
+    * większość kontenerów w bibliotece standardowej). [O(1)]
+    */
+   void swap(PriorityQueue<K, V, Allocator, Backend>& queue);
+
+   bool operator==(const PriorityQueue<K, V, Allocator, Backend>& queue) const;
+
+   bool operator<(const PriorityQueue<K, V, Allocator, Backend>& queue) const;
+
+   bool operator!=(const PriorityQueue<K, V, Allocator, Backend>& queue) const;
+
+   bool operator<=(const PriorityQueue<K, V, Allocator, Backend>& queue) const;
+
+   bool operator>(const PriorityQueue<K, V, Allocator, Backend>& queue) const;
+
+   bool operator>=(const PriorityQueue<K, V, Allocator, Backend>& queue) const;
+
+   /**
+    * Metoda zwracająca migawkę liczników (tylko ze strategią
+    * InstrumentedBackend). [O(size())] - liczba powtórzonych kluczy jest
+    * wyznaczana przejściem po indeksie kluczy, bez zliczania porównań.
+    */
+   PriorityQueueStats stats() const;
+
+   /**
+    * Metoda zapisująca kolejkę do pliku path jako migawkę: nagłówek (wersja
+    * formatu, rozmiary typów, suma kontrolna), pary w porządku wartości
+    * i porządek kluczy jako tablica indeksów par. Dla trywialnie
+    * kopiowalnych K i V z domyślnymi serializatorami pary są rekordami
+    * stałej długości, ułożonymi jak struct {K; V;} od przesunięcia 64 (plik
+    * można odwzorować w pamięci i czytać bezpośrednio); w przeciwnym razie
+    * pary są zapisywane przez KeySerializer i ValueSerializer (zob.
+    * SnapshotSerializer). Plik powstaje pod nazwą tymczasową i zastępuje
+    * path dopiero po udanym zapisie. Błędy wejścia-wyjścia zgłaszają
+    * PriorityQueueSnapshotException. [O(size())]
+    */
+   template<typename KeySerializer = SnapshotSerializer<K>,
+            typename ValueSerializer = SnapshotSerializer<V>>
+   void saveSnapshot(const std::string& path) const;
+
+   /**
+    * Metoda zastępująca zawartość kolejki migawką z pliku path, zapisaną
+    * z tymi samymi serializatorami. Plik jest odwzorowywany w pamięci
+    * (mmap), a po sprawdzeniu nagłówka i sumy kontrolnej oba indeksy są
+    * budowane z zapisanych porządków, bez porównań; rekordy stałej długości
+    * są kopiowane do węzłów bez parsowania. Uszkodzony lub niezgodny plik
+    * zgłasza PriorityQueueSnapshotException; przy każdym wyjątku kolejka
+    * pozostaje bez zmian. [O(n) dla n zapisanych par]
+    */
+   template<typename KeySerializer = SnapshotSerializer<K>,
+            typename ValueSerializer = SnapshotSerializer<V>>
+   void loadSnapshot(const std::string& path);
+
+private:
+
+   struct Node;
+
+public:
+
+   /**
+    * Uchwyt do pary przechowywanej w kolejce. Pozostaje ważny, dopóki para
+    * nie zostanie usunięta z kolejki (deleteMin, deleteMax, erase, zmiana
+    * wartości tej pary przez changeValue) lub kolejka nie zostanie
+    * zniszczona; swap, przeniesienie kolejki oraz merge (przy równych
+    * alokatorach) zachowują ważność uchwytów.
+    * Domyślnie skonstruowany uchwyt nie wskazuje na żadną parę.
+    */
+   class handle_type {
+
+   public:
+
+      handle_type() {}
+
+      template<bool>
+      friend class basic_iterator;
+
+      bool operator==(const handle_type& handle) const {
+         return node == handle.node;
+      }
+
+      bool operator!=(const handle_type& handle) const {
+         return node != handle.node;
+      }
+
+   private:
+
+      friend class PriorityQueue<K, V, Allocator, Backend>;
+
+      explicit handle_type(Node* n) : node(n) {}
+
+      Node* node = nullptr;
+   };
+
+   /**
+    * Stały iterator dwukierunkowy po parach kolejki. Dereferencja daje
+    * std::pair<const K&, const V&> z referencjami do pary w węźle (bez
+    * kopiowania), a handle() - uchwyt do wskazywanej pary. Iteratory tracą
+    * ważność przy każdej modyfikacji kolejki. Pary usunięte w trybie
+    * leniwym (setLazyErase) są pomijane.
+    */
+   template<bool ByValue>
+   class basic_iterator {
+
+   public:
+
+      using iterator_category = std::bidirectional_iterator_tag;
+      using value_type = std::pair<K, V>;
+      using difference_type = std::ptrdiff_t;
+      using reference = std::pair<const K&, const V&>;
+
+      // Wynik operator-> (para referencji nie ma adresu, więc jest
+      // przechowywana w obiekcie pośredniczącym).
+      class pointer {
+
+      public:
+
+         const reference* operator->() const {
+            return &pair;
+         }
+
+      private:
+
+         friend class basic_iterator;
+
+         explicit pointer(reference pair) : pair(pair) {}
+
+         reference pair;
+      };
+
+      basic_iterator() {}
+
+      reference operator*() const {
+         return reference(node()->key, node()->value);
+      }
+
+      pointer operator->() const {
+         return pointer(**this);
+      }
+
+      const K& key() const {
+         return node()->key;
+      }
+
+      const V& value() const {
+         return node()->value;
+      }
+
+      handle_type handle() const {
+         return handle_type(node());
+      }
+
+      basic_iterator& operator++() {
+         hook = skip(pq_detail::Tree::next(hook), pq_detail::Tree::next);
+         return *this;
+      }
+
+      basic_iterator operator++(int) {
+         basic_iterator result = *this;
+         ++*this;
+         return result;
+      }
+
+      // Cofnięcie end() daje ostatnią parę.
+      basic_iterator& operator--() {
+         hook = skip(hook ? pq_detail::Tree::prev(hook) : tree->last(),
+                     pq_detail::Tree::prev);
+         return *this;
+      }
+
+      basic_iterator operator--(int) {
+         basic_iterator result = *this;
+         --*this;
+         return result;
+      }
+
+      bool operator==(const basic_iterator& it) const {
+         return hook == it.hook;
+      }
+
+      bool operator!=(const basic_iterator& it) const {
+         return hook != it.hook;
+      }
+
+   private:
+
+      friend class PriorityQueue<K, V, Allocator, Backend>;
+
+      using tree_type = typename std::conditional<
+         ByValue, pq_detail::BasicTree<ranked>, pq_detail::Tree>::type;
+
+      basic_iterator(const tree_type* tree, pq_detail::TreeHook* hook)
+         : tree(tree), hook(skip(hook, pq_detail::Tree::next)) {}
+
+      static Node* node(pq_detail::TreeHook* h) {
+         return ByValue ? value_node(h) : key_node(h);
+      }
+
+      Node* node() const {
+         assert(hook);
+         return node(hook);
+      }
+
+      // Pierwszy od h zaczep żywej pary w kierunku step.
+      static pq_detail::TreeHook* skip(
+         pq_detail::TreeHook* h,
+         pq_detail::TreeHook* (*step)(pq_detail::TreeHook*)) {
+         while (h && node(h)->dead)
+            h = step(h);
+         return h;
+      }
+
+      const tree_type* tree = nullptr;
+      pq_detail::TreeHook* hook = nullptr;
+   };
+
+   /**
+    * Widok zakresu par [begin(), end()) - bez kopiowania.
+    */
+   template<typename It>
+   class range_view {
+
+   public:
+
+      range_view(It first, It last) : first(first), last(last) {}
+
+      It begin() const {
+         return first;
+      }
+
+      It end() const {
+         return last;
+      }
+
+      bool empty() const {
+         return first == last;
+      }
+
+   private:
+
+      It first;
+      It last;
+   };
+
+private:
+
+   using hook_t = pq_detail::TreeHook;
+   using position_t = pq_detail::Position;
+   using tree_t = pq_detail::Tree;
+   using value_tree_t = pq_detail::BasicTree<ranked>;
+
+   // Węzeł przechowujący jedyną kopię pary, podpięty do obu indeksów.
+   struct Node: pq_detail::KeyHook, pq_detail::ValueHook {
+      template<typename KK, typename VV>
+      Node(KK&& k, VV&& v) noexcept(
+         std::is_nothrow_constructible<K, KK&&>::value &&
+         std::is_nothrow_constructible<V, VV&&>::value)
+         : key(std::forward<KK>(k)), value(std::forward<VV>(v)) {}
+
+      template<typename... KArgs, typename... VArgs>
+      Node(std::piecewise_construct_t, std::tuple<KArgs...>&& k,
+           std::tuple<VArgs...>&& v)
+         : key(std::make_from_tuple<K>(std::move(k))),
+           value(std::make_from_tuple<V>(std::move(v))) {}
+
+      K key;
+      V value;
+   };
+
+   static Node* key_node(hook_t* h) {
+      return static_cast<Node*>(static_cast<pq_detail::KeyHook*>(h));
+   }
+
+   static Node* value_node(hook_t* h) {
+      return static_cast<Node*>(static_cast<pq_detail::ValueHook*>(h));
+   }
+
+   static hook_t* key_hook(Node* n) {
+      return static_cast<pq_detail::KeyHook*>(n);
+   }
+
+   static hook_t* value_hook(Node* n) {
+      return static_cast<pq_detail::ValueHook*>(n);
+   }
+
+   using node_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<Node>;
+   using node_traits_t = std::allocator_traits<node_allocator_t>;
+
+   static_assert(std::is_same<typename node_traits_t::pointer, Node*>::value,
+                 "PriorityQueue: alokator musi używać zwykłych wskaźników");
+
+   // Utworzenie węzła z alokatora kolejki; przy wyjątku w konstruktorze
+   // pamięć jest oddawana do alokatora.
+   template<typename... Args>
+   Node* create_node(Args&&... args);
+
+   // Zniszczenie węzła i oddanie pamięci do alokatora (no-throw).
+   void destroy_node(Node* n);
+
+   // Strażnik niszczący węzeł, który nie został podpięty do indeksów.
+   class NodeGuard {
+
+   public:
+
+      NodeGuard(PriorityQueue<K, V, Allocator, Backend>& queue, Node* n)
+         : queue(queue), node(n) {}
+
+      ~NodeGuard() {
+         if (node)
+            queue.destroy_node(node);
+      }
+
+      Node* get() const {
+         return node;
+      }
+
+      Node* release() {
+         Node* n = node;
+         node = nullptr;
+         return n;
+      }
+
+   private:
+
+      PriorityQueue<K, V, Allocator, Backend>& queue;
+      Node* node;
+   };
+
+   // Strażnik wyjmowanej pary: węzeł jest już odpięty; przy wyjściu bez
+   // wyjątku strażnik go niszczy, a przy wyjątku (z konstrukcji wyniku)
+   // podpina go z powrotem w to samo miejsce, bez porównań.
+   class ExtractGuard {
+
+   public:
+
+      ExtractGuard(PriorityQueue<K, V, Allocator, Backend>& queue, Node* n)
+         : queue(queue), node(n),
+           key_succ(tree_t::next(key_hook(n))),
+           value_succ(tree_t::next(value_hook(n))),
+           exceptions(std::uncaught_exceptions()) {
+         queue.unlink(n);
+      }
+
+      ~ExtractGuard() {
+         if (std::uncaught_exceptions() > exceptions) {
+            queue.map_key.link_before(key_hook(node), key_succ);
+            queue.map_value.link_before(value_hook(node), value_succ);
+            ++queue.counter;
+         } else {
+            queue.destroy_node(node);
+            queue.collect();
+            queue.record(&PriorityQueueStats::deletions);
+         }
+      }
+
+   private:
+
+      PriorityQueue<K, V, Allocator, Backend>& queue;
+      Node* node;
+      hook_t* key_succ;
+      hook_t* value_succ;
+      int exceptions;
+   };
+
+   // Składowe wyjmowanej pary są przenoszone, gdy przeniesienie obu nie
+   // zgłasza wyjątków, a w przeciwnym razie kopiowane - wtedy wyjątek
+   // w trakcie konstrukcji pary nie zmienia węzła.
+   static constexpr bool nothrow_take =
+      std::is_nothrow_move_constructible<K>::value &&
+      std::is_nothrow_move_constructible<V>::value;
+
+   template<typename T>
+   using take_t =
+      typename std::conditional<nothrow_take, T&&, const T&>::type;
+
+   // Porównania kluczy i wartości nie zgłaszają wyjątków (np. dla typów
+   // wbudowanych) - wtedy wstawianie paczki i merge nie przygotowują
+   // wycofania zmian.
+   static constexpr bool nothrow_less =
+      pq_detail::is_nothrow_less<K>::value &&
+      pq_detail::is_nothrow_less<V>::value;
+
+   // Wyjęcie pary z węzła n do obiektu typu R konstruowanego z argumentów
+   // tag..., klucza i wartości. [O(log size())]
+   template<typename R, typename... Tag>
+   R extract(Node* n, Tag... tag);
+
+   // Pozycje nowej pary w indeksach; porównania mogą zgłosić wyjątek.
+   position_t key_position(const K& key, const V& value) const;
+
+   position_t value_position(const V& value) const;
+
+   // Czy migawka z danymi serializatorami używa rekordów stałej długości.
+   template<typename KS, typename VS>
+   static constexpr bool raw_snapshot() {
+      return std::is_same<KS, SnapshotSerializer<K>>::value &&
+             std::is_same<VS, SnapshotSerializer<V>>::value &&
+             std::is_trivially_copyable<K>::value &&
+             std::is_trivially_copyable<V>::value &&
+             std::is_default_constructible<K>::value &&
+             std::is_default_constructible<V>::value;
+   }
+
+   // Układ rekordu stałej długości - jak struct {K key; V value;}.
+   static constexpr size_t record_align =
+      alignof(K) > alignof(V) ? alignof(K) : alignof(V);
+   static constexpr size_t record_value_offset =
+      (sizeof(K) + alignof(V) - 1) / alignof(V) * alignof(V);
+   static constexpr size_t record_size =
+      (record_value_offset + sizeof(V) + record_align - 1) / record_align *
+      record_align;
+
+   // Porównanie a < b zliczane w strategii InstrumentedBackend.
+   template<typename T, typename U>
+   bool less(const T& a, const U& b) const {
+      this->record(&PriorityQueueStats::comparisons);
+      return a < b;
+   }
+
+   // Węzeł o kluczu key (o najmniejszej wartości) lub nullptr.
+   template<typename KK>
+   Node* find_key(const KK& key) const;
+
+   template<typename KK>
+   size_type count_key(const KK& key) const;
+
+   // Pierwszy zaczep indeksu wartości o wartości nie mniejszej od value
+   // lub nullptr.
+   hook_t* value_lower_bound(const V& value) const;
+
+   // Wstawienie pary: najpierw wyszukanie pozycji, potem utworzenie węzła.
+   template<typename KK, typename VV>
+   handle_type insert_pair(KK&& key, VV&& value);
+
+   // Wstawienie gotowego węzła (przy wyjątku węzeł jest niszczony).
+   handle_type insert_node(Node* n);
+
+   // Podpięcie węzła do obu indeksów (no-throw).
+   void link(Node* n, position_t key_pos, position_t value_pos);
+
+   // Odpięcie węzła od obu indeksów (no-throw).
+   void unlink(Node* n);
+
+   // Pierwszy zaczep od h (włącznie) w porządku indeksu kluczy lub wartości,
+   // którego para nie została usunięta leniwie; nullptr, gdy nie ma takiego.
+   static hook_t* live_key(hook_t* h);
+
+   static hook_t* live_value(hook_t* h);
+
+   // Usunięcie pary z węzła n - w trybie leniwym tylko oznaczenie (no-throw).
+   void erase_node(Node* n);
+
+   // Zwolnienie oznaczonych węzłów z obu końców porządku wartości (skrajne
+   // pary muszą być żywe) i kompaktowanie, gdy oznaczonych węzłów jest za
+   // dużo (no-throw).
+   void collect();
+
+   // Przebudowa obu indeksów bez oznaczonych węzłów (no-throw).
+   void compact();
+
+   // Zwolnienie wszystkich węzłów (no-throw).
+   void clear();
+
+   // Porządki indeksów kluczy i wartości na zaczepach (porównania przez
+   // less).
+   bool key_less(hook_t* lhs, hook_t* rhs) const;
+
+   bool value_less(hook_t* lhs, hook_t* rhs) const;
+
+   // Czy przebudowa indeksów z m zmienianymi węzłami (przy n pozostałych)
+   // jest tańsza od m operacji na pojedynczych węzłach.
+   static bool rebuild_cheaper(size_type m, size_type n);
+
+   // Utworzenie węzłów z par z zakresu [first, last) i ułożenie ich
+   // w porządku obu indeksów; przy wyjątku węzły są niszczone.
+   template<typename InputIt>
+   void create_sorted(InputIt first, InputIt last, std::vector<hook_t*>& keys,
+                      std::vector<hook_t*>& values);
+
+   // Wyjęcie co najwyżej n par o najmniejszych (max == false) lub
+   // największych wartościach.
+   template<typename OutputIt>
+   OutputIt extract_range(size_type n, OutputIt out, bool max);
+
+   // Warianty extract_range: wyjmowanie par po kolei ze skraju indeksu
+   // wartości oraz - gdy wyjmowane pary to większość kolejki - z budową
+   // indeksu kluczy od nowa z pozostałych zaczepów, dla których keys ma
+   // zarezerwowane miejsce.
+   template<typename OutputIt>
+   OutputIt extract_stream(size_type n, OutputIt out, bool max);
+
+   template<typename OutputIt>
+   OutputIt extract_bulk(size_type n, OutputIt out, bool max,
+                         std::vector<hook_t*>& keys);
+
+   // Zapis pary z węzła n do *out (bez przesunięcia out); przy wyjątku
+   // węzeł zachowuje parę.
+   template<typename OutputIt>
+   static void write_pair(Node* n, OutputIt& out);
+
+   // Scalenie z kolejką o innym alokatorze - przez kopie par.
+   void merge_copy(PriorityQueue<K, V, Allocator, Backend>& queue);
+
+   // Zmiana wartości pary w węźle n; zwraca węzeł z nową wartością.
+   // Wersja dla V z no-throw przypisaniem przenoszącym działa w miejscu.
+   template<typename VV>
+   Node* assign_value(Node* n, VV&& value, std::true_type);
+
+   template<typename VV>
+   Node* assign_value(Node* n, VV&& value, std::false_type);
+
+   using assign_in_place_t =
+      std::integral_constant<bool, std::is_nothrow_move_assignable<V>::value>;
+
+   node_allocator_t alloc;
+   tree_t map_key;
+   value_tree_t map_value;
+   size_type counter = 0; // węzły w indeksach, także oznaczone
+   size_type dead = 0; // węzły oznaczone jako usunięte (tryb leniwy)
+   double max_dead_ratio = 0.5;
+   bool lazy_erase = false;
+};
+
+/*============================================================================*/
+/*                             Implementacja.                                 */
+/*============================================================================*/
+
+template<typename K, typename V, typename A, typename B>
+PriorityQueue<K, V, A, B>::PriorityQueue(const A& alloc) : alloc(alloc) {}
+
+template<typename K, typename V, typename A, typename B>
+template<typename InputIt>
+PriorityQueue<K, V, A, B>::PriorityQueue(InputIt first, InputIt last,
+                                      const A& alloc)
+   : alloc(alloc) {
+   std::vector<hook_t*> keys, values;
+   create_sorted(first, last, keys, values);
+   map_key.build(keys.data(), keys.data() + keys.size()); // O(n)
+   map_value.build(values.data(), values.data() + values.size()); // O(n)
+   counter = keys.size();
+}
+
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::key_less(hook_t* lhs, hook_t* rhs) const {
+   const Node* l = key_node(lhs);
+   const Node* r = key_node(rhs);
+   return less(l->key, r->key) ||
+          (!less(r->key, l->key) && less(l->value, r->value));
+}
+
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::value_less(hook_t* lhs, hook_t* rhs) const {
+   return less(value_node(lhs)->value, value_node(rhs)->value);
+}
+
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::rebuild_cheaper(size_type m, size_type n) {
+   // Przebudowa odwiedza i zapisuje każdy węzeł obu drzew, zwykle spoza
+   // pamięci podręcznej; w pomiarach (10^6 par) kosztowała na węzeł ponad
+   // połowę wstawienia lub usunięcia pojedynczej pary, więc opłaca się
+   // dopiero, gdy zmieniane węzły stanowią większość.
+   return m >= 2 * n;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename InputIt>
+void PriorityQueue<K, V, A, B>::create_sorted(InputIt first, InputIt last,
+                                              std::vector<hook_t*>& keys,
+                                              std::vector<hook_t*>& values) {
+   try {
+      for (; first != last; ++first) {
+         auto&& pair = *first;
+         if (keys.size() == keys.capacity())
+            keys.reserve(std::max<size_t>(16, 2 * keys.capacity()));
+         Node* n = create_node(std::forward<decltype(pair)>(pair).first,
+                               std::forward<decltype(pair)>(pair).second);
+         keys.push_back(key_hook(n)); // Miejsce zarezerwowane, no-throw.
+      }
+      values.reserve(keys.size());
+      for (hook_t* h : keys)
+         values.push_back(value_hook(key_node(h)));
+
+      // Stabilne sortowanie zachowuje kolejność wstawiania przy remisach.
+      // Liczniki InstrumentedBackend nie są atomowe, więc wtedy sortujemy
+      // w jednym wątku.
+      auto by_key = [this](hook_t* l, hook_t* r) { return key_less(l, r); };
+      auto by_value = [this](hook_t* l, hook_t* r) {
+         return value_less(l, r);
+      };
+      unsigned threads =
+         instrumented ? 1 : std::max(1u, std::thread::hardware_concurrency());
+      if (!std::is_sorted(keys.begin(), keys.end(), by_key)) // O(n)
+         pq_detail::parallel_stable_sort(keys.begin(), keys.end(), by_key,
+                                         threads);
+      if (!std::is_sorted(values.begin(), values.end(), by_value)) // O(n)
+         pq_detail::parallel_stable_sort(values.begin(), values.end(),
+                                         by_value, threads);
+   } catch (...) {
+      for (hook_t* h : keys)
+         destroy_node(key_node(h));
+      throw;
+   }
+}
+
+template<typename K, typename V, typename A, typename B>
+PriorityQueue<K, V, A, B>::PriorityQueue(const PriorityQueue<K, V, A, B>& queue)
+   : alloc(node_traits_t::select_on_container_copy_construction(queue.alloc)) {
+   // Kopiujemy węzły w porządku kluczy, a następnie budujemy oba indeksy
+   // z posortowanych ciągów, bez porównań. [O(queue.size())]
+   std::vector<hook_t*> keys, values;
+   keys.reserve(queue.size());
+   values.reserve(queue.size());
+   pq_detail::NodeMap copies(queue.size());
+   try {
+      for (hook_t* h = live_key(queue.map_key.first()); h;
+           h = live_key(tree_t::next(h))) {
+         const Node* n = key_node(h);
+         Node* copy = create_node(n->key, n->value);
+         keys.push_back(key_hook(copy)); // Miejsce zarezerwowane, no-throw.
+         copies.insert(n, copy);
+      }
+   } catch (...) {
+      for (hook_t* h : keys)
+         destroy_node(key_node(h));
+      throw;
+   }
+   for (hook_t* h = live_value(queue.map_value.first()); h;
+        h = live_value(tree_t::next(h))) {
+      Node* copy = static_cast<Node*>(copies.find(value_node(h)));
+      values.push_back(value_hook(copy));
+   }
+   map_key.build(keys.data(), keys.data() + keys.size());
+   map_value.build(values.data(), values.data() + values.size());
+   counter = keys.size();
+   max_dead_ratio = queue.max_dead_ratio;
+   lazy_erase = queue.lazy_erase;
+}
+
+template<typename K, typename V, typename A, typename B>
+PriorityQueue<K, V, A, B>::PriorityQueue(PriorityQueue<K, V, A, B>&& queue)
+   : alloc(queue.alloc) {
+   map_key.swap(queue.map_key);
+   map_value.swap(queue.map_value);
+   std::swap(counter, queue.counter);
+   std::swap(dead, queue.dead);
+   max_dead_ratio = queue.max_dead_ratio;
+   lazy_erase = queue.lazy_erase;
+}
+
+template<typename K, typename V, typename A, typename B>
+PriorityQueue<K, V, A, B>::~PriorityQueue() {
+   clear();
+}
+
+template<typename K, typename V, typename A, typename B>
+PriorityQueue<K, V, A, B>&
+PriorityQueue<K, V, A, B>::operator=(PriorityQueue<K, V, A, B> queue) {
+   queue.swap(*this);
+   return *this;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename InputIt>
+void PriorityQueue<K, V, A, B>::assign(InputIt first, InputIt last) {
+   PriorityQueue<K, V, A, B> tmp(first, last, get_allocator());
+   tmp.setLazyErase(lazy_erase, max_dead_ratio);
+   tmp.swap(*this);
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::allocator_type
+PriorityQueue<K, V, A, B>::get_allocator() const {
+   return allocator_type(alloc);
+}
+
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::empty() const {
+   return counter == dead;
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::size() const {
+   return counter - dead;
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::position_t
+PriorityQueue<K, V, A, B>::key_position(const K& key, const V& value) const {
+   // Porządek po parze (klucz, wartość); równe pary trafiają na prawo.
+   position_t pos{nullptr, false};
+   hook_t* h = map_key.root();
+   while (h) {
+      const Node* cur = key_node(h);
+      pos.parent = h;
+      pos.left = less(key, cur->key) ||
+                 (!less(cur->key, key) && less(value, cur->value));
+      h = pos.left ? h->left : h->right;
+   }
+   return pos;
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::position_t
+PriorityQueue<K, V, A, B>::value_position(const V& value) const {
+   // Porządek po wartości; równe wartości w kolejności wstawiania.
+   position_t pos{nullptr, false};
+   hook_t* h = map_value.root();
+   while (h) {
+      pos.parent = h;
+      pos.left = less(value, value_node(h)->value);
+      h = pos.left ? h->left : h->right;
+   }
+   return pos;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename KK>
+typename PriorityQueue<K, V, A, B>::Node*
+PriorityQueue<K, V, A, B>::find_key(const KK& key) const {
+   hook_t* h = map_key.root();
+   hook_t* found = nullptr;
+   while (h) {
+      if (less(key_node(h)->key, key)) {
+         h = h->right;
+      } else {
+         found = h;
+         h = h->left;
+      }
+   }
+   found = live_key(found);
+   if (!found || less(key, key_node(found)->key))
+      return nullptr;
+   return key_node(found);
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::link(Node* n, position_t key_pos,
+                               position_t value_pos) {
+   map_key.link(key_hook(n), key_pos);
+   map_value.link(value_hook(n), value_pos);
+   ++counter;
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::unlink(Node* n) {
+   map_key.unlink(key_hook(n));
+   map_value.unlink(value_hook(n));
+   --counter;
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::hook_t*
+PriorityQueue<K, V, A, B>::live_key(hook_t* h) {
+   while (h && key_node(h)->dead)
+      h = tree_t::next(h);
+   return h;
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::hook_t*
+PriorityQueue<K, V, A, B>::live_value(hook_t* h) {
+   while (h && value_node(h)->dead)
+      h = tree_t::next(h);
+   return h;
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::erase_node(Node* n) {
+   if (lazy_erase) {
+      n->dead = true;
+      if constexpr (ranked)
+         value_tree_t::recount(value_hook(n)); // O(log size())
+      ++dead;
+   } else {
+      unlink(n); // O(log size())
+      destroy_node(n);
+   }
+   collect();
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::collect() {
+   // Każdy oznaczony węzeł jest zwalniany tu lub przy kompaktowaniu
+   // dokładnie raz, a kompaktowanie następuje po co najmniej
+   // max_dead_ratio * size() oznaczeniach, więc koszt rozkłada się na
+   // operacje, które oznaczyły węzły.
+   while (dead > 0) {
+      Node* n = value_node(map_value.first());
+      if (!n->dead) {
+         n = value_node(map_value.last());
+         if (!n->dead)
+            break;
+      }
+      unlink(n); // O(log size())
+      destroy_node(n);
+      --dead;
+   }
+   if (dead > max_dead_ratio * counter)
+      compact(); // O(size())
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::compact() {
+   if (dead == 0)
+      return;
+
+   // Żywe węzły w porządku obu indeksów; drzewa budujemy od nowa, bez
+   // porównań i rotacji. [O(size() + dead)]
+   std::vector<hook_t*> keys, values, graves;
+   try {
+      keys.reserve(counter - dead);
+      values.reserve(counter - dead);
+      graves.reserve(dead);
+   } catch (...) {
+      // Bez pamięci na tablice: odpinanie oznaczonych węzłów po kolei.
+      // Następnik wyznaczony przed odpięciem pozostaje poprawny.
+      // [O(size() + dead * log size())]
+      for (hook_t* h = map_value.first(); h;) {
+         Node* n = value_node(h);
+         h = tree_t::next(h);
+         if (n->dead) {
+            unlink(n);
+            destroy_node(n);
+         }
+      }
+      dead = 0;
+      return;
+   }
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   for (hook_t* h = live_key(map_key.first()); h;
+        h = live_key(tree_t::next(h)))
+      keys.push_back(h);
+   for (hook_t* h = map_value.first(); h; h = tree_t::next(h))
+      (value_node(h)->dead ? graves : values).push_back(h);
+   map_key.build(keys.data(), keys.data() + keys.size());
+   map_value.build(values.data(), values.data() + values.size());
+   for (hook_t* h : graves)
+      destroy_node(value_node(h));
+   counter = keys.size();
+   dead = 0;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename... Args>
+typename PriorityQueue<K, V, A, B>::Node*
+PriorityQueue<K, V, A, B>::create_node(Args&&... args) {
+   Node* n = node_traits_t::allocate(alloc, 1);
+   if constexpr (noexcept(node_traits_t::construct(
+                    alloc, n, std::forward<Args>(args)...))) {
+      node_traits_t::construct(alloc, n, std::forward<Args>(args)...);
+   } else {
+      try {
+         node_traits_t::construct(alloc, n, std::forward<Args>(args)...);
+      } catch (...) {
+         node_traits_t::deallocate(alloc, n, 1);
+         throw;
+      }
+   }
+   this->record(&PriorityQueueStats::allocations);
+   return n;
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::destroy_node(Node* n) {
+   node_traits_t::destroy(alloc, n);
+   node_traits_t::deallocate(alloc, n, 1);
+   this->record(&PriorityQueueStats::deallocations);
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::clear() {
+   map_value.reset();
+   map_key.dispose([this](hook_t* h) { destroy_node(key_node(h)); });
+   counter = 0;
+   dead = 0;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename VV>
+typename PriorityQueue<K, V, A, B>::Node*
+PriorityQueue<K, V, A, B>::assign_value(Node* n, VV&& value, std::true_type) {
+   // Miejsca docelowe wyznaczamy, zanim cokolwiek zmienimy, jako następniki
+   // w obu indeksach - pozostają poprawne po odpięciu węzła n.
+   hook_t* key_succ = tree_t::successor(key_position(n->key, value),
+                                        key_hook(n)); // O(log size())
+   hook_t* value_succ = tree_t::successor(value_position(value),
+                                          value_hook(n)); // O(log size())
+   V tmp(std::forward<VV>(value));
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   map_key.unlink(key_hook(n));
+   map_value.unlink(value_hook(n));
+   n->value = std::move(tmp);
+   map_key.link_before(key_hook(n), key_succ);
+   map_value.link_before(value_hook(n), value_succ);
+   collect();
+   return n;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename VV>
+typename PriorityQueue<K, V, A, B>::Node*
+PriorityQueue<K, V, A, B>::assign_value(Node* old, VV&& value,
+                                        std::false_type) {
+   // Nowa para powstaje obok starej; stara jest usuwana dopiero wtedy,
+   // gdy nowa została w całości wstawiona.
+   position_t key_pos = key_position(old->key, value); // O(log size())
+   position_t value_pos = value_position(value); // O(log size())
+   Node* n = create_node(old->key, std::forward<VV>(value));
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   link(n, key_pos, value_pos);
+   unlink(old);
+   destroy_node(old);
+   collect();
+   return n;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename VV>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::insert_pair(KK&& key, VV&& value) {
+   position_t key_pos = key_position(key, value); // O(log size())
+   position_t value_pos = value_position(value); // O(log size())
+   Node* n = create_node(std::forward<KK>(key), std::forward<VV>(value));
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   link(n, key_pos, value_pos); // O(log size())
+   this->record(&PriorityQueueStats::insertions);
+   return handle_type(n);
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::insert_node(Node* node) {
+   NodeGuard n(*this, node);
+   position_t key_pos = key_position(node->key, node->value); // O(log size())
+   position_t value_pos = value_position(node->value); // O(log size())
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   link(n.release(), key_pos, value_pos); // O(log size())
+   this->record(&PriorityQueueStats::insertions);
+   return handle_type(node);
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::insert(const K& key, const V& value) {
+   return insert_pair(key, value);
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::insert(K&& key, V&& value) {
+   return insert_pair(std::move(key), std::move(value));
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename VV>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::emplace(KK&& key, VV&& value) {
+   return insert_node(create_node(std::forward<KK>(key),
+                                  std::forward<VV>(value)));
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename... KArgs, typename... VArgs>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::emplace(std::piecewise_construct_t,
+                                std::tuple<KArgs...> key_args,
+                                std::tuple<VArgs...> value_args) {
+   return insert_node(create_node(std::piecewise_construct,
+                                  std::move(key_args), std::move(value_args)));
+}
+
+template<typename K, typename V, typename A, typename B>
+const V& PriorityQueue<K, V, A, B>::minValue() const {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return value_node(map_value.first())->value;
+}
+
+template<typename K, typename V, typename A, typename B>
+const V& PriorityQueue<K, V, A, B>::maxValue() const {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return value_node(map_value.last())->value;
+}
+
+template<typename K, typename V, typename A, typename B>
+const K& PriorityQueue<K, V, A, B>::minKey() const {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return value_node(map_value.first())->key;
+}
+
+template<typename K, typename V, typename A, typename B>
+const K& PriorityQueue<K, V, A, B>::maxKey() const {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return value_node(map_value.last())->key;
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::deleteMin() {
+   if (empty())
+      return;
+
+   Node* n = value_node(map_value.first());
+   unlink(n); // O(log size())
+   destroy_node(n);
+   collect();
+   this->record(&PriorityQueueStats::deletions);
+}
+
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::deleteMax() {
+   if (empty())
+      return;
+
+   Node* n = value_node(map_value.last());
+   unlink(n); // O(log size())
+   destroy_node(n);
+   collect();
+   this->record(&PriorityQueueStats::deletions);
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename R, typename... Tag>
+R PriorityQueue<K, V, A, B>::extract(Node* n, Tag... tag) {
+   ExtractGuard guard(*this, n); // O(log size())
+   // Wynik jest konstruowany bezpośrednio w obiekcie zwracanym (prvalue),
+   // więc po jego utworzeniu nic już nie może zgłosić wyjątku.
+   return R(tag..., static_cast<take_t<K>>(n->key),
+            static_cast<take_t<V>>(n->value));
+}
 
-public:
+template<typename K, typename V, typename A, typename B>
+std::pair<K, V> PriorityQueue<K, V, A, B>::popMin() {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return extract<std::pair<K, V>>(value_node(map_value.first()));
+}
 
-   virtual const char* what() const noexcept {
-      return "PriorityQueueEmptyException";
+template<typename K, typename V, typename A, typename B>
+std::pair<K, V> PriorityQueue<K, V, A, B>::popMax() {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return extract<std::pair<K, V>>(value_node(map_value.last()));
+}
+
+template<typename K, typename V, typename A, typename B>
+std::optional<std::pair<K, V>> PriorityQueue<K, V, A, B>::tryPopMin() {
+   if (empty())
+      return std::nullopt;
+   return extract<std::optional<std::pair<K, V>>>(
+      value_node(map_value.first()), std::in_place);
+}
+
+template<typename K, typename V, typename A, typename B>
+std::optional<std::pair<K, V>> PriorityQueue<K, V, A, B>::tryPopMax() {
+   if (empty())
+      return std::nullopt;
+   return extract<std::optional<std::pair<K, V>>>(
+      value_node(map_value.last()), std::in_place);
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename InputIt>
+void PriorityQueue<K, V, A, B>::insertBatch(InputIt first, InputIt last) {
+   std::vector<hook_t*> keys, values;
+   create_sorted(first, last, keys, values); // O(m log m)
+   size_type m = keys.size();
+   if (m == 0)
+      return;
+
+   if (!rebuild_cheaper(m, counter)) {
+      // Mała paczka: wstawianie do każdego indeksu osobno, w jego porządku,
+      // z wyszukiwaniem od poprzednio wstawionego węzła paczki. Równe
+      // wartości zachowują kolejność z paczki. [O(m log (size() + m))]
+      size_type keys_linked = 0, values_linked = 0;
+      auto link_all = [&] {
+         for (hook_t* hint = nullptr; keys_linked < m; ++keys_linked) {
+            hook_t* k = keys[keys_linked];
+            position_t pos = map_key.search(hint, [this, k](hook_t* h) {
+               return key_less(k, h);
+            });
+            map_key.link(hint = k, pos);
+         }
+         for (hook_t* hint = nullptr; values_linked < m; ++values_linked) {
+            hook_t* v = values[values_linked];
+            position_t pos = map_value.search(hint, [this, v](hook_t* h) {
+               return value_less(v, h);
+            });
+            map_value.link(hint = v, pos);
+         }
+      };
+      if constexpr (nothrow_less) {
+         link_all();
+      } else {
+         try {
+            link_all();
+         } catch (...) {
+            for (size_type i = 0; i < values_linked; ++i)
+               map_value.unlink(values[i]);
+            for (size_type i = 0; i < keys_linked; ++i)
+               map_key.unlink(keys[i]);
+            for (hook_t* h : keys)
+               destroy_node(key_node(h));
+            throw;
+         }
+      }
+      counter += m;
+      this->record(&PriorityQueueStats::insertions, m);
+      return;
    }
-};
 
-class PriorityQueueNotFoundException: public std::exception {
+   // Duża paczka: scalenie posortowanych ciągów z porządkami indeksów
+   // i budowa obu drzew od nowa. Przy remisach węzły kolejki poprzedzają
+   // węzły paczki, jak przy wstawianiu po kolei. [O(size() + m)]
+   // Węzły oznaczone w trybie leniwym są przy okazji zwalniane.
+   auto by_key = [this](hook_t* l, hook_t* r) { return key_less(l, r); };
+   auto by_value = [this](hook_t* l, hook_t* r) { return value_less(l, r); };
+   std::vector<hook_t*> all_keys, all_values, graves;
+   try {
+      all_keys.reserve(size() + m);
+      all_values.reserve(size() + m);
+      graves.reserve(dead);
+      std::vector<hook_t*> old;
+      old.reserve(size());
+      for (hook_t* h = live_key(map_key.first()); h;
+           h = live_key(tree_t::next(h)))
+         old.push_back(h);
+      std::merge(old.begin(), old.end(), keys.begin(), keys.end(),
+                 std::back_inserter(all_keys), by_key);
+      old.clear();
+      for (hook_t* h = map_value.first(); h; h = tree_t::next(h))
+         (value_node(h)->dead ? graves : old).push_back(h);
+      std::merge(old.begin(), old.end(), values.begin(), values.end(),
+                 std::back_inserter(all_values), by_value);
+   } catch (...) {
+      for (hook_t* h : keys)
+         destroy_node(key_node(h));
+      throw;
+   }
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   map_key.build(all_keys.data(), all_keys.data() + all_keys.size());
+   map_value.build(all_values.data(), all_values.data() + all_values.size());
+   for (hook_t* h : graves)
+      destroy_node(value_node(h));
+   counter = all_keys.size();
+   dead = 0;
+   this->record(&PriorityQueueStats::insertions, m);
+}
 
-public:
+template<typename K, typename V, typename A, typename B>
+template<typename OutputIt>
+void PriorityQueue<K, V, A, B>::write_pair(Node* n, OutputIt& out) {
+   // Składowe przenosimy z węzła tylko wtedy, gdy nieudany zapis zostawia
+   // parę nietkniętą (albo gdy nie da się jej skopiować); iterator
+   // zamieniający typy mógłby przenieść klucz, zanim zgłosi wyjątek, więc
+   // w pozostałych przypadkach zapisujemy kopię.
+   constexpr bool move_out = nothrow_take &&
+      (pq_detail::keeps_pair_on_throw<OutputIt, std::pair<K, V>>::value ||
+       !std::is_copy_constructible<K>::value ||
+       !std::is_copy_constructible<V>::value);
+   if constexpr (move_out) {
+      std::pair<K, V> pair(std::move(n->key), std::move(n->value));
+      try {
+         *out = std::move(pair);
+      } catch (...) {
+         // Przeniesione składowe wracają do węzła (bez wyjątków).
+         n->key.~K();
+         new (&n->key) K(std::move(pair.first));
+         n->value.~V();
+         new (&n->value) V(std::move(pair.second));
+         throw;
+      }
+   } else {
+      *out = std::pair<K, V>(n->key, n->value);
+   }
+}
 
-   virtual const char* what() const noexcept {
-      return "PriorityQueueNotFoundException";
+template<typename K, typename V, typename A, typename B>
+template<typename OutputIt>
+OutputIt PriorityQueue<K, V, A, B>::extract_range(size_type n, OutputIt out,
+                                                  bool max) {
+   n = std::min(n, size());
+   if (n == 0)
+      return out;
+   bool rebuild = rebuild_cheaper(n, size() - n);
+   std::vector<hook_t*> keys;
+   if (rebuild) {
+      try {
+         keys.reserve(counter - n);
+      } catch (...) {
+         rebuild = false;
+      }
    }
-};
+   return rebuild ? extract_bulk(n, std::move(out), max, keys)
+                  : extract_stream(n, std::move(out), max);
+}
 
-/*============================================================================*/
-/*                                Interfejs.                                  */
-/*============================================================================*/
+template<typename K, typename V, typename A, typename B>
+template<typename OutputIt>
+OutputIt PriorityQueue<K, V, A, B>::extract_stream(size_type n, OutputIt out,
+                                                   bool max) {
+   // Węzły są zdejmowane ze skraju indeksu wartości bez równoważenia,
+   // odpinane z indeksu kluczy i zwalniane, póki są w pamięci podręcznej;
+   // brzeg indeksu wartości naprawiamy raz, na końcu lub po wyjątku zapisu
+   // (zapisywana para zostaje wtedy w kolejce). [O(n log size())]
+   size_type erased = 0;
+   auto finish = [this, &erased, max] {
+      if (max)
+         map_value.mend_back(); // O(log size())
+      else
+         map_value.mend_front(); // O(log size())
+      collect();
+      this->record(&PriorityQueueStats::deletions, erased);
+   };
+   try {
+      while (n > 0) {
+         Node* node = value_node(max ? map_value.last() : map_value.first());
+         bool written = !node->dead;
+         if (written) {
+            write_pair(node, out);
+            --n;
+            ++erased;
+         } else {
+            --dead;
+         }
+         if (max)
+            map_value.drop_last();
+         else
+            map_value.drop_first();
+         map_key.unlink(key_hook(node)); // O(log size())
+         destroy_node(node);
+         --counter;
+         // Zapisana para jest już usunięta - wyjątek przy przesunięciu out
+         // jej nie przywraca.
+         if (written)
+            ++out;
+      }
+   } catch (...) {
+      finish();
+      throw;
+   }
+   finish();
+   return out;
+}
 
-template<typename K, typename V>
-class PriorityQueue {
+template<typename K, typename V, typename A, typename B>
+template<typename OutputIt>
+OutputIt PriorityQueue<K, V, A, B>::extract_bulk(size_type n, OutputIt out,
+                                                 bool max,
+                                                 std::vector<hook_t*>& keys) {
+   // Zapis par od skrajnej bez zmian w indeksach. Odwiedzone węzły (także
+   // oznaczone w trybie leniwym) dostają licznik zaczepu klucza równy 0 -
+   // indeks kluczy licznika nie używa. Przy wyjątku węzły przed zapisywaną
+   // parą usuwamy po kolei. [O(n + oznaczone)]
+   size_type m = 0, erased = 0;
+   hook_t* end = nullptr;
+   try {
+      for (hook_t* h = max ? map_value.last() : map_value.first(); n > 0;
+           h = max ? tree_t::prev_ahead(h) : tree_t::next_ahead(h)) {
+         Node* node = value_node(h);
+         bool written = !node->dead;
+         if (written) {
+            write_pair(node, out);
+            --n;
+            ++erased;
+         }
+         key_hook(node)->count = 0;
+         end = h;
+         ++m;
+         if (written)
+            ++out;
+      }
+   } catch (...) {
+      for (; m > 0; --m) {
+         Node* node = value_node(max ? map_value.last() : map_value.first());
+         dead -= node->dead;
+         unlink(node); // O(log size())
+         destroy_node(node);
+      }
+      collect();
+      this->record(&PriorityQueueStats::deletions, erased);
+      throw;
+   }
 
-public:
-   
-   using size_type = size_t;
-   using key_type = K;
-   using value_type = V;
+   // Od tego miejsca nic nie zgłasza wyjątku. Indeks wartości tniemy raz,
+   // za ostatnim odwiedzonym węzłem, a indeks kluczy rozbieramy od
+   // początku: oznaczone węzły zwalniamy, a z pozostałych budujemy go od
+   // nowa. [O(size())]
+   if (max)
+      map_value.cut_back(end); // O(log size())
+   else
+      map_value.cut_front(end); // O(log size())
+   while (hook_t* h = map_key.first()) {
+      map_key.drop_first();
+      Node* node = key_node(h);
+      if (h->count != 0) {
+         keys.push_back(h);
+      } else {
+         dead -= node->dead;
+         destroy_node(node);
+      }
+   }
+   map_key.build(keys.data(), keys.data() + keys.size());
+   counter -= m;
+   collect();
+   this->record(&PriorityQueueStats::deletions, erased);
+   return out;
+}
 
-   /**
-    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
-    */
-   PriorityQueue() {}
+template<typename K, typename V, typename A, typename B>
+template<typename OutputIt>
+OutputIt PriorityQueue<K, V, A, B>::extractMin(size_type n, OutputIt out) {
+   return extract_range(n, std::move(out), false);
+}
 
-   /**
-    * Konstruktor kopiujący. [O(queue.size())]
-    */
-   PriorityQueue(const PriorityQueue<K, V>& queue);
+template<typename K, typename V, typename A, typename B>
+template<typename OutputIt>
+OutputIt PriorityQueue<K, V, A, B>::extractMax(size_type n, OutputIt out) {
+   return extract_range(n, std::move(out), true);
+}
 
-   /**
-    * Konstruktor przenoszący. [O(1)]
-    */
-   PriorityQueue(PriorityQueue<K, V>&& queue);
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::changeValue(const K& key, const V& value) {
+   // Znajdowanie klucza.
+   Node* old = find_key(key); // O(log size())
+   if (!old)
+      throw PriorityQueueNotFoundException();
 
-   /**
-    * Operator przypisania. 
-    * [O(queue.size()) dla użycia P = Q, a O(1) dla użycia P = move(Q)]
-    */
-   PriorityQueue<K, V>& operator=(PriorityQueue<K, V> queue);
+   assign_value(old, value, assign_in_place_t()); // O(log size())
+   this->record(&PriorityQueueStats::value_changes);
+}
 
-   /**
-    * Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta. [O(1)]
-    */
-   bool empty() const;
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::changeValue(const K& key, V&& value) {
+   Node* old = find_key(key); // O(log size())
+   if (!old)
+      throw PriorityQueueNotFoundException();
 
-   /**
-    * Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce.
-    * [O(1)]
-    */
-   size_type size() const;
+   assign_value(old, std::move(value), assign_in_place_t()); // O(log size())
+   this->record(&PriorityQueueStats::value_changes);
+}
 
-   /**
-    * Metoda wstawiająca do kolejki parę o kluczu key i wartości value
-    * [O(log size())] (dopuszczamy możliwość występowania w kolejce wielu
-    * par o tym samym kluczu).
-    */
-   void insert(const K& key, const V& value);
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename>
+void PriorityQueue<K, V, A, B>::changeValue(const KK& key, const V& value) {
+   Node* old = find_key(key); // O(log size())
+   if (!old)
+      throw PriorityQueueNotFoundException();
 
-   /**
-    * Metody zwracające odpowiednio najmniejszą i największą wartość 
-    * przechowywaną w kolejce [O(1)]; w przypadku wywołania którejś z tych metod
-    * na pustej strukturze powinien zostać zgłoszony wyjątek 
-    * PriorityQueueEmptyException.
-    */
-   const V& minValue() const;
-   
-   const V& maxValue() const;
+   assign_value(old, value, assign_in_place_t()); // O(log size())
+   this->record(&PriorityQueueStats::value_changes);
+}
 
-   /**
-    * Metody zwracające klucz o przypisanej odpowiednio najmniejszej lub
-    * największej wartości [O(1)]; w przypadku wywołania którejś z tych metod
-    * na pustej strukturze powinien zostać zgłoszony wyjątek
-    * PriorityQueueEmptyException.
-    */
-   const K& minKey() const;
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename>
+void PriorityQueue<K, V, A, B>::changeValue(const KK& key, V&& value) {
+   Node* old = find_key(key); // O(log size())
+   if (!old)
+      throw PriorityQueueNotFoundException();
 
-   const K& maxKey() const;
+   assign_value(old, std::move(value), assign_in_place_t()); // O(log size())
+   this->record(&PriorityQueueStats::value_changes);
+}
 
-   /**
-    * Metody usuwające z kolejki jedną parę o odpowiednio najmniejszej lub
-    * największej wartości. [O(log size())]
-    */
-   void deleteMin();
-   
-   void deleteMax();
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::find(const K& key) const {
+   return handle_type(find_key(key));
+}
 
-   /**
-    * Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową
-    * wartość value [O(log size())]; w przypadku gdy w kolejce nie ma pary
-    * o kluczu key, powinien zostać zgłoszony wyjątek
-    * PriorityQueueNotFoundException(); w przypadku kiedy w kolejce jest kilka 
-    * par o kluczu key, zmienia wartość w dowolnie wybranej parze o podanym 
-    * kluczu.
-    */
-   void changeValue(const K& key, const V& value);
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::find(const KK& key) const {
+   return handle_type(find_key(key));
+}
 
-   /**
-    * Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja 
-    * usuwa wszystkie elementy z kolejki queue i wstawia je do kolejki *this.
-    * [O(size() + queue.size() * log (queue.size() + size()))]
-    */
-   void merge(PriorityQueue<K, V>& queue);
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::contains(const K& key) const {
+   return find_key(key) != nullptr;
+}
 
-   /**
-    * Metoda zamieniającą zawartość kolejki z podaną kolejką queue (tak jak
-    * większość kontenerów w bibliotece standardowej). [O(1)]
-    */
-   void swap(PriorityQueue<K, V>& queue);
-  
-   bool operator==(const PriorityQueue<K, V>& queue) const;
-   
-   bool operator<(const PriorityQueue<K, V>& queue) const;
-   
-   bool operator!=(const PriorityQueue<K, V>& queue) const;
-   
-   bool operator<=(const PriorityQueue<K, V>& queue) const;
-   
-   bool operator>(const PriorityQueue<K, V>& queue) const;
-   
-   bool operator>=(const PriorityQueue<K, V>& queue) const;
-   
-private:
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename>
+bool PriorityQueue<K, V, A, B>::contains(const KK& key) const {
+   return find_key(key) != nullptr;
+}
 
-   // Komparator porównujący zdereferowane wskaźniki.
-   template<typename T>
-   struct LessPtr {
-      bool operator() (const T& lhs, const T& rhs) const {
-         return *lhs < *rhs;
-      }
-   };
-   
-   using ptr_key_t = std::shared_ptr<K>;
-   using ptr_value_t = std::shared_ptr<V>;
-   using set_key_t = std::multiset<ptr_key_t, LessPtr<ptr_key_t>>;
-   using set_value_t = std::multiset<ptr_value_t, LessPtr<ptr_value_t>>;
-   using map_key_t = std::map<ptr_key_t, set_value_t, LessPtr<ptr_key_t>>;
-   using map_value_t = std::map<ptr_value_t, set_key_t, LessPtr<ptr_value_t>>;
-
-   map_key_t map_key;
-   map_value_t map_value;
-   size_type counter = 0;
-};
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::count(const K& key) const {
+   return count_key(key);
+}
 
-/*============================================================================*/
-/*                             Implementacja.                                 */
-/*============================================================================*/
+template<typename K, typename V, typename A, typename B>
+template<typename KK, typename>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::count(const KK& key) const {
+   return count_key(key);
+}
 
-template<typename K, typename V>
-PriorityQueue<K, V>::PriorityQueue(const PriorityQueue<K, V>& queue) {
-   map_key_t tmp_key(queue.map_key); // O(queue.size())
-   map_value_t tmp_value(queue.map_value); // O(queue.size()
-   map_key.swap(tmp_key);
-   map_value.swap(tmp_value);
-   counter = queue.counter; 
+template<typename K, typename V, typename A, typename B>
+template<typename KK>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::count_key(const KK& key) const {
+   // Pary o kluczu key leżą w indeksie kluczy obok siebie.
+   Node* first = find_key(key); // O(log size())
+   size_type result = 0;
+   for (hook_t* h = first ? key_hook(first) : nullptr;
+        h && !less(key, key_node(h)->key); h = tree_t::next(h))
+      result += !key_node(h)->dead;
+   return result;
 }
 
-template<typename K, typename V>
-PriorityQueue<K, V>::PriorityQueue(PriorityQueue<K, V>&& queue) {
-   map_key = std::move(queue.map_key); 
-   map_value = std::move(queue.map_value);
-   counter = queue.counter; 
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::update(handle_type handle, const V& value) {
+   assert(handle.node);
+   return handle_type(assign_value(handle.node, value, assign_in_place_t()));
 }
 
-template<typename K, typename V>
-PriorityQueue<K, V>& PriorityQueue<K, V>::operator=(PriorityQueue<K, V> queue) {
-   queue.swap(*this);
-   return *this;
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::handle_type
+PriorityQueue<K, V, A, B>::update(handle_type handle, V&& value) {
+   assert(handle.node);
+   return handle_type(assign_value(handle.node, std::move(value),
+                                   assign_in_place_t()));
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::empty() const {
-   return counter == 0;
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::erase(handle_type handle) {
+   assert(handle.node && !handle.node->dead);
+   erase_node(handle.node); // O(log size())
 }
 
-template<typename K, typename V>
-typename PriorityQueue<K, V>::size_type PriorityQueue<K, V>::size() const {
-   return counter;
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::eraseKey(const K& key) {
+   Node* n = find_key(key); // O(log size())
+   if (!n)
+      return false;
+
+   erase_node(n); // O(log size())
+   this->record(&PriorityQueueStats::deletions);
+   return true;
 }
 
-template<typename K, typename V>
-void PriorityQueue<K, V>::insert(const K& key, const V& value) {
-   ptr_key_t tmp_k = std::make_shared<K>(key);
-   ptr_value_t tmp_v = std::make_shared<V>(value);
-   auto it = map_key.find(tmp_k); // O(log size()))
-   typename set_value_t::const_iterator set_it;
-   bool first = false;
-   if (it == map_key.end()) {
-      first = true;
-      set_value_t s;
-      s.insert(tmp_v);
-      auto it_tmp = map_key.insert(std::make_pair(tmp_k,s));
-      it = it_tmp.first;
-   } else {
-      set_it = map_key[tmp_k].insert(tmp_v); // O(log size()))
-   }
-   try {
-      map_value[tmp_v].insert(tmp_k);
-   } catch (...) {
-      if (first) 
-         map_key.erase(it); // O(1)
-      else 
-         it->second.erase(set_it); // O(1)
-      throw;
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::eraseAll(const K& key) {
+   // Najpierw wyznaczamy koniec grupy par o kluczu key (porównania mogą
+   // zgłosić wyjątek), dopiero potem usuwamy. Następnik wyznaczony przed
+   // odpięciem węzła pozostaje poprawny.
+   Node* first = find_key(key); // O(log size())
+   hook_t* begin = first ? key_hook(first) : nullptr;
+   hook_t* end = begin;
+   while (end && !less(key, key_node(end)->key))
+      end = tree_t::next(end);
+
+   size_type result = 0;
+   for (hook_t* h = begin; h != end;) {
+      Node* n = key_node(h);
+      h = tree_t::next(h);
+      if (n->dead)
+         continue;
+      if (lazy_erase) {
+         n->dead = true;
+         if constexpr (ranked)
+            value_tree_t::recount(value_hook(n)); // O(log size())
+         ++dead;
+      } else {
+         unlink(n); // O(log size())
+         destroy_node(n);
+      }
+      ++result;
+      this->record(&PriorityQueueStats::deletions);
    }
-   ++counter;
+   collect();
+   return result;
 }
 
-template<typename K, typename V>
-const V& PriorityQueue<K, V>::minValue() const {
-   if (empty())
-      throw PriorityQueueEmptyException();
-   return *map_value.cbegin()->first;
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::setLazyErase(bool enabled,
+                                             double max_tombstone_ratio) {
+   assert(max_tombstone_ratio >= 0);
+   lazy_erase = enabled;
+   max_dead_ratio = max_tombstone_ratio;
+   if (!enabled)
+      compact(); // O(size())
 }
 
-template<typename K, typename V>
-const V& PriorityQueue<K, V>::maxValue() const {
-   if (empty())
-      throw PriorityQueueEmptyException();
-   return *map_value.crbegin()->first;
+template<typename K, typename V, typename A, typename B>
+const V& PriorityQueue<K, V, A, B>::value(handle_type handle) const {
+   assert(handle.node);
+   return handle.node->value;
 }
 
-template<typename K, typename V>
-const K& PriorityQueue<K, V>::minKey() const {
-   if (empty())
-      throw PriorityQueueEmptyException();
-   return **map_value.cbegin()->second.begin();
+template<typename K, typename V, typename A, typename B>
+const K& PriorityQueue<K, V, A, B>::key(handle_type handle) const {
+   assert(handle.node);
+   return handle.node->key;
 }
 
-template<typename K, typename V>
-const K& PriorityQueue<K, V>::maxKey() const {
-   if (empty())
-      throw PriorityQueueEmptyException();
-   return **map_value.crbegin()->second.begin();
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::value_iterator
+PriorityQueue<K, V, A, B>::begin() const {
+   return value_iterator(&map_value, map_value.first());
 }
 
-template<typename K, typename V>
-void PriorityQueue<K, V>::deleteMin() {
-    if (empty())
-      return;
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::value_iterator
+PriorityQueue<K, V, A, B>::end() const {
+   return value_iterator(&map_value, nullptr);
+}
 
-   auto it_k = map_value.cbegin()->second.cbegin();
-   ptr_key_t tmp_k = *it_k;
-   ptr_value_t tmp_v = map_value.cbegin()->first;
-
-   auto it_map_key = map_key.find(tmp_k); // O(log size()))
-   assert(it_map_key != map_key.end());
-   auto it_map_key_set = it_map_key->second.find(tmp_v); // O(log size()))
-   assert(it_map_key_set != it_map_key->second.end());
-
-   // Usunięcie klucza spod min wartości.
-   map_value.begin()->second.erase(it_k); // O(1)
-   if (map_value.begin()->second.empty()) 
-      map_value.erase(map_value.cbegin()); // O(1)
-
-   // Usunięcie tej wartości spod klucza.
-   it_map_key->second.erase(it_map_key_set); // O(1)
-   if (it_map_key->second.empty())
-      map_key.erase(it_map_key); // O(1)
- 
-   --counter;
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::key_iterator
+PriorityQueue<K, V, A, B>::keyBegin() const {
+   return key_iterator(&map_key, map_key.first());
 }
 
-template<typename K, typename V>
-void PriorityQueue<K, V>::deleteMax() {
-   if (empty())
-      return;
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::key_iterator
+PriorityQueue<K, V, A, B>::keyEnd() const {
+   return key_iterator(&map_key, nullptr);
+}
 
-   auto it_k = map_value.crbegin()->second.cbegin();
-   ptr_key_t tmp_k = *it_k;
-   ptr_value_t tmp_v = map_value.crbegin()->first;
-
-   auto it_map_key = map_key.find(tmp_k); // O(log size()))
-   assert(it_map_key != map_key.end());
-   auto it_map_key_set = it_map_key->second.find(tmp_v); // O(log size()))
-   assert(it_map_key_set != it_map_key->second.end());
-
-   // Usunięcie klucza spod max wartości.
-   map_value.rbegin()->second.erase(it_k); // O(1)
-   if (map_value.rbegin()->second.empty()) 
-      map_value.erase(--map_value.crbegin().base()); // O(1)
-
-   // Usunięcie tej wartości spod klucza.
-   it_map_key->second.erase(it_map_key_set); // O(1)
-   if (it_map_key->second.empty())
-      map_key.erase(it_map_key); // O(1)
- 
-   --counter;
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::template range_view<
+   typename PriorityQueue<K, V, A, B>::key_iterator>
+PriorityQueue<K, V, A, B>::keys() const {
+   return range_view<key_iterator>(keyBegin(), keyEnd());
 }
 
-template<typename K, typename V>
-void PriorityQueue<K, V>::changeValue(const K& key, const V& value) { 
-   ptr_key_t tmp_k = std::make_shared<K>(key);
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::hook_t*
+PriorityQueue<K, V, A, B>::value_lower_bound(const V& value) const {
+   hook_t* h = map_value.root();
+   hook_t* found = nullptr;
+   while (h) {
+      if (less(value_node(h)->value, value)) {
+         h = h->right;
+      } else {
+         found = h;
+         h = h->left;
+      }
+   }
+   return found;
+}
 
-   // Znajdowanie klucza.
-   auto it_k = map_key.find(tmp_k); // O(log size())
-   if (it_k == map_key.end())
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::value_iterator
+PriorityQueue<K, V, A, B>::nth(size_type k) const {
+   static_assert(std::is_same<B, OrderStatisticBackend>::value,
+                 "PriorityQueue::nth wymaga strategii "
+                 "OrderStatisticBackend");
+   return value_iterator(&map_value, map_value.select(k)); // O(log size())
+}
+
+template<typename K, typename V, typename A, typename B>
+const V& PriorityQueue<K, V, A, B>::kthValue(size_type k) const {
+   static_assert(std::is_same<B, OrderStatisticBackend>::value,
+                 "PriorityQueue::kthValue wymaga strategii "
+                 "OrderStatisticBackend");
+   hook_t* h = map_value.select(k); // O(log size())
+   if (!h)
       throw PriorityQueueNotFoundException();
+   return value_node(h)->value;
+}
 
-   // Uzyskanie iteratorow do elementow, ktore będą usuwane
-   // przy pomyślnym insercie nowego elementu.
-   ptr_value_t tmp_v = *it_k->second.begin();
-   auto map_value_it = map_value.find(tmp_v); // O(log size())
-   auto set_key_it = it_k->second.begin();
-   typename set_key_t::const_iterator set_it;
-   bool single = (map_value_it->second.size() == 1) ? true : false;
-   if (!single)
-      set_it = map_value_it->second.find(tmp_k); // O(log size())
-   
-   insert(key, value);
-   --counter;
-   
-   // Usunięcie elementów przy zakończonym sukcesem insercie,
-   // ponieważ begin() oraz erase() dla iteratorów są
-   // no-throw, tu wyjątek nie może się pojawić.
-   it_k->second.erase(set_key_it); // O(1)
-   if (single)
-      map_value.erase(map_value_it); // O(1)
-   else
-      map_value_it->second.erase(set_it); // O(1)
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::rankOf(const V& value) const {
+   static_assert(std::is_same<B, OrderStatisticBackend>::value,
+                 "PriorityQueue::rankOf wymaga strategii "
+                 "OrderStatisticBackend");
+   // Pary o mniejszych wartościach to poddrzewa na lewo od ścieżki
+   // wyszukiwania wraz z węzłami, z których ścieżka skręca w prawo.
+   size_type result = 0;
+   hook_t* h = map_value.root();
+   while (h) {
+      if (less(value_node(h)->value, value)) {
+         result += value_tree_t::count(h) - value_tree_t::count(h->right);
+         h = h->right;
+      } else {
+         h = h->left;
+      }
+   }
+   return result;
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::size_type
+PriorityQueue<K, V, A, B>::countInRange(const V& lo, const V& hi) const {
+   if (!less(lo, hi))
+      return 0;
+   return rankOf(hi) - rankOf(lo); // O(log size())
+}
+
+template<typename K, typename V, typename A, typename B>
+const V& PriorityQueue<K, V, A, B>::median() const {
+   if (empty())
+      throw PriorityQueueEmptyException();
+   return kthValue((size() - 1) / 2);
+}
+
+template<typename K, typename V, typename A, typename B>
+typename PriorityQueue<K, V, A, B>::template range_view<
+   typename PriorityQueue<K, V, A, B>::value_iterator>
+PriorityQueue<K, V, A, B>::valueRange(const V& lo, const V& hi) const {
+   if (!less(lo, hi))
+      return range_view<value_iterator>(end(), end());
+   return range_view<value_iterator>(
+      value_iterator(&map_value, value_lower_bound(lo)), // O(log size())
+      value_iterator(&map_value, value_lower_bound(hi))); // O(log size())
 }
 
-template<typename K, typename V>
-void PriorityQueue<K, V>::merge(PriorityQueue<K, V>& queue) {
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::merge(PriorityQueue<K, V, A, B>& queue) {
    // Jeśli merge do samego siebie.
    if (this == &queue)
       return;
+   this->record(&PriorityQueueStats::merges);
 
-   // Merge z queue.
-   PriorityQueue<K, V> tmp(*this);
+   if (!(alloc == queue.alloc)) {
+      merge_copy(queue);
+      return;
+   }
 
-   // Obie pętle O(queue.size() * log (queue.size() + size()))
-   for (auto it = queue.map_key.begin(); it != queue.map_key.end(); ++it)
-      tmp.map_key[it->first].insert(it->second.begin(), it->second.end());
+   // Węzły queue są przepinane w porządku wartości, dzięki czemu pary
+   // o równych wartościach zachowują wzajemną kolejność. Porządek wartości
+   // zapamiętujemy, bo przepinanie niszczy drzewa queue; przy porównaniach
+   // mogących zgłosić wyjątek także porządek kluczy, aby w razie wyjątku
+   // odbudować queue w czasie liniowym, bez porównań. [O(queue.size())]
+   // Węzły oznaczone w queue nie są przepinane, lecz zwalniane na końcu.
+   std::vector<hook_t*> keys, values;
+   if constexpr (!nothrow_less) {
+      keys.reserve(queue.counter);
+      for (hook_t* h = queue.map_key.first(); h; h = tree_t::next(h))
+         keys.push_back(h);
+   }
+   values.reserve(queue.counter);
+   for (hook_t* h = queue.map_value.first(); h; h = tree_t::next(h))
+      values.push_back(h);
+
+   // [O(queue.size() * log (queue.size() + size()))]
+   size_type moved = 0;
+   auto move_all = [&] {
+      for (; moved < values.size(); ++moved) {
+         Node* n = value_node(values[moved]);
+         if (n->dead)
+            continue;
+         position_t key_pos = key_position(n->key, n->value);
+         position_t value_pos = value_position(n->value);
+         link(n, key_pos, value_pos);
+      }
+   };
+   if constexpr (nothrow_less) {
+      move_all();
+   } else {
+      try {
+         move_all();
+      } catch (...) {
+         // Wycofanie: odpięcie przeniesionych węzłów (no-throw) i odbudowa
+         // indeksów queue z zapamiętanych porządków.
+         while (moved > 0) {
+            Node* n = value_node(values[--moved]);
+            if (!n->dead)
+               unlink(n);
+         }
+         queue.map_key.build(keys.data(), keys.data() + keys.size());
+         queue.map_value.build(values.data(), values.data() + values.size());
+         throw;
+      }
+   }
 
-   for (auto it = queue.map_value.begin(); it != queue.map_value.end(); ++it)
-      tmp.map_value[it->first].insert(it->second.begin(), it->second.end());
+   if (queue.dead > 0)
+      for (hook_t* h : values)
+         if (value_node(h)->dead)
+            destroy_node(value_node(h));
+   queue.map_key.reset();
+   queue.map_value.reset();
+   queue.counter = 0;
+   queue.dead = 0;
+}
 
-   tmp.counter += queue.counter;
-   tmp.swap(*this);
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::merge_copy(PriorityQueue<K, V, A, B>& queue) {
+   // Węzły queue pochodzą z innego alokatora, więc wstawiamy ich kopie,
+   // a w razie wyjątku usuwamy już wstawione.
+   std::vector<Node*> inserted;
+   inserted.reserve(queue.size());
+   try {
+      for (hook_t* h = live_value(queue.map_value.first()); h;
+           h = live_value(tree_t::next(h)))
+         inserted.push_back(insert(value_node(h)->key,
+                                   value_node(h)->value).node);
+   } catch (...) {
+      for (Node* n : inserted) {
+         unlink(n);
+         destroy_node(n);
+      }
+      throw;
+   }
 
-   // Czyszczenie queue. clear() jest no-throw.
-   queue.map_key.clear(); // O(queue.size())
-   queue.map_value.clear(); //  O(queue.size())
-   queue.counter = 0;
+   // Czyszczenie queue, clear() jest no-throw.
+   queue.clear(); // O(queue.size())
+}
+
+template<typename K, typename V, typename A, typename B>
+PriorityQueueStats PriorityQueue<K, V, A, B>::stats() const {
+   static_assert(std::is_same<B, InstrumentedBackend>::value,
+                 "PriorityQueue::stats wymaga strategii InstrumentedBackend");
+   PriorityQueueStats result = this->counters;
+   result.nodes = counter;
+   result.tombstones = dead;
+   hook_t* prev = nullptr;
+   for (hook_t* h = live_key(map_key.first()); h;
+        prev = h, h = live_key(tree_t::next(h)))
+      if (prev && !(key_node(prev)->key < key_node(h)->key))
+         ++result.duplicate_keys;
+   result.memory_bytes = sizeof(*this) + counter * sizeof(Node);
+   return result;
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename KS, typename VS>
+void PriorityQueue<K, V, A, B>::saveSnapshot(const std::string& path) const {
+   constexpr bool raw = raw_snapshot<KS, VS>();
+   pq_detail::SnapshotWriter writer(path);
+
+   // Pary w porządku wartości. NodeMap pamięta indeks każdej z nich (jako
+   // wskaźnik o wartości indeks + 1) do zapisu porządku kluczy.
+   pq_detail::NodeMap index(size());
+   std::vector<char> bytes(raw ? record_size : 0);
+   uintptr_t i = 0;
+   for (hook_t* h = live_value(map_value.first()); h;
+        h = live_value(tree_t::next(h))) {
+      const Node* n = value_node(h);
+      index.insert(n, reinterpret_cast<void*>(++i));
+      if constexpr (raw) {
+         std::memcpy(bytes.data(), &n->key, sizeof(K));
+         std::memcpy(bytes.data() + record_value_offset, &n->value, sizeof(V));
+      } else {
+         bytes.clear();
+         KS::write(bytes, n->key);
+         VS::write(bytes, n->value);
+      }
+      writer.write(bytes.data(), bytes.size());
+   }
+
+   pq_detail::SnapshotHeader header{};
+   std::memcpy(header.magic, pq_detail::snapshot_magic, sizeof(header.magic));
+   header.version = pq_detail::SnapshotHeader::current_version;
+   header.endian = pq_detail::snapshot_endian;
+   header.format = raw ? pq_detail::SnapshotHeader::raw
+                       : pq_detail::SnapshotHeader::serialized;
+   header.key_size = raw ? sizeof(K) : 0;
+   header.value_size = raw ? sizeof(V) : 0;
+   header.record_size = raw ? record_size : 0;
+   header.count = size();
+   header.records_bytes = writer.size();
+   writer.pad(8);
+   header.order_offset = sizeof(header) + writer.size();
+   for (hook_t* h = live_key(map_key.first()); h;
+        h = live_key(tree_t::next(h))) {
+      uint64_t position = reinterpret_cast<uintptr_t>(
+         index.find(key_node(h))) - 1;
+      writer.write(&position, sizeof(position));
+   }
+   writer.commit(header);
+}
+
+template<typename K, typename V, typename A, typename B>
+template<typename KS, typename VS>
+void PriorityQueue<K, V, A, B>::loadSnapshot(const std::string& path) {
+   constexpr bool raw = raw_snapshot<KS, VS>();
+   pq_detail::MappedFile file(path);
+   const char* data = file.data();
+   const uint64_t size = file.size();
+
+   // Sprawdzenie nagłówka, rozmiarów części pliku i sumy kontrolnej.
+   pq_detail::SnapshotHeader header;
+   if (size < sizeof(header))
+      throw PriorityQueueSnapshotException();
+   std::memcpy(&header, data, sizeof(header));
+   const uint64_t records_end = sizeof(header) + header.records_bytes;
+   if (std::memcmp(header.magic, pq_detail::snapshot_magic,
+                   sizeof(header.magic)) != 0 ||
+       header.version != pq_detail::SnapshotHeader::current_version ||
+       header.endian != pq_detail::snapshot_endian ||
+       header.format != (raw ? pq_detail::SnapshotHeader::raw
+                             : pq_detail::SnapshotHeader::serialized) ||
+       header.key_size != (raw ? sizeof(K) : 0) ||
+       header.value_size != (raw ? sizeof(V) : 0) ||
+       header.record_size != (raw ? record_size : 0) ||
+       header.records_bytes > size - sizeof(header) ||
+       header.order_offset != (records_end + 7) / 8 * 8 ||
+       header.order_offset > size ||
+       header.count != (size - header.order_offset) / 8 ||
+       (size - header.order_offset) % 8 != 0 ||
+       (raw && header.records_bytes != header.count * record_size))
+      throw PriorityQueueSnapshotException();
+   if (pq_detail::snapshot_checksum(pq_detail::snapshot_checksum_seed,
+                                    data + sizeof(header),
+                                    size - sizeof(header)) != header.checksum)
+      throw PriorityQueueSnapshotException();
+
+   // Węzły w porządku wartości, potem porządek kluczy z tablicy indeksów.
+   PriorityQueue<K, V, A, B> queue(alloc);
+   queue.setLazyErase(lazy_erase, max_dead_ratio);
+   std::vector<hook_t*> keys, values;
+   keys.reserve(header.count);
+   values.reserve(header.count);
+   try {
+      const char* p = data + sizeof(header);
+      const char* end = data + records_end;
+      for (uint64_t i = 0; i < header.count; ++i) {
+         Node* n;
+         if constexpr (raw) {
+            K key;
+            V value;
+            std::memcpy(static_cast<void*>(&key), p, sizeof(K));
+            std::memcpy(static_cast<void*>(&value), p + record_value_offset,
+                        sizeof(V));
+            p += record_size;
+            n = queue.create_node(key, value);
+         } else {
+            K key = KS::read(p, end);
+            V value = VS::read(p, end);
+            n = queue.create_node(std::move(key), std::move(value));
+         }
+         values.push_back(value_hook(n)); // Miejsce zarezerwowane, no-throw.
+      }
+      if (p != end)
+         throw PriorityQueueSnapshotException();
+
+      std::vector<bool> seen(header.count, false);
+      const char* order = data + header.order_offset;
+      for (uint64_t i = 0; i < header.count; ++i, order += 8) {
+         uint64_t position;
+         std::memcpy(&position, order, sizeof(position));
+         if (position >= header.count || seen[position])
+            throw PriorityQueueSnapshotException();
+         seen[position] = true;
+         keys.push_back(key_hook(value_node(values[position])));
+      }
+   } catch (...) {
+      for (hook_t* h : values)
+         queue.destroy_node(value_node(h));
+      throw;
+   }
+   // Od tego miejsca nic nie zgłasza wyjątku.
+   queue.map_key.build(keys.data(), keys.data() + keys.size()); // O(n)
+   queue.map_value.build(values.data(), values.data() + values.size()); // O(n)
+   queue.counter = keys.size();
+   swap(queue);
 }
 
-template<typename K, typename V>
-void PriorityQueue<K, V>::swap(PriorityQueue<K, V>& queue) {
-   std::swap(map_key, queue.map_key);
-   std::swap(map_value, queue.map_value);
+template<typename K, typename V, typename A, typename B>
+void PriorityQueue<K, V, A, B>::swap(PriorityQueue<K, V, A, B>& queue) {
+   using std::swap;
+   swap(alloc, queue.alloc);
+   map_key.swap(queue.map_key);
+   map_value.swap(queue.map_value);
    std::swap(counter, queue.counter);
+   std::swap(dead, queue.dead);
+   std::swap(max_dead_ratio, queue.max_dead_ratio);
+   std::swap(lazy_erase, queue.lazy_erase);
 }
 
 // Globalna metoda swap.
-template<typename K, typename V>
-void swap(PriorityQueue<K, V>& lhs, PriorityQueue<K, V>& rhs) {
+template<typename K, typename V, typename A, typename B>
+void swap(PriorityQueue<K, V, A, B>& lhs, PriorityQueue<K, V, A, B>& rhs) {
    lhs.swap(rhs);
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::operator==(const PriorityQueue<K, V>& queue) const {
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::operator==(
+   const PriorityQueue<K, V, A, B>& queue) const {
    if (size() != queue.size())
       return false;
-   if (map_key.size() != queue.map_key.size()) {
-      return false;
-   }
-   auto lhs_it = map_key.begin();
-   auto rhs_it = queue.map_key.begin();
-   while (lhs_it != map_key.end()) {
-      if (!(*(lhs_it->first) == *(rhs_it->first))) {
+   // Oba indeksy kluczy są uporządkowane po parach (klucz, wartość).
+   hook_t* lhs_it = live_key(map_key.first());
+   hook_t* rhs_it = live_key(queue.map_key.first());
+   while (lhs_it) {
+      const Node* lhs = key_node(lhs_it);
+      const Node* rhs = key_node(rhs_it);
+      if (!(lhs->key == rhs->key) || !(lhs->value == rhs->value))
          return false;
-      } else {
-         if (lhs_it->second.size() != rhs_it->second.size()) {
-            return false;
-         } else {
-            auto lhs_set_it = lhs_it->second.begin();
-            auto rhs_set_it = rhs_it->second.begin();
-            while (lhs_set_it != lhs_it->second.end()) {
-               if (!(**lhs_set_it == **rhs_set_it)) {
-                  return false;
-               } else {
-                  ++lhs_set_it;
-                  ++rhs_set_it;
-               }
-            }
-         }
-      }
-      ++lhs_it;
-      ++rhs_it;
+      lhs_it = live_key(tree_t::next(lhs_it));
+      rhs_it = live_key(tree_t::next(rhs_it));
    }
    return true;
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::operator!=(const PriorityQueue<K, V>& queue) const {
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::operator!=(
+   const PriorityQueue<K, V, A, B>& queue) const {
    return !(*this == queue);
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::operator<(const PriorityQueue<K, V>& queue) const {
-   auto lhs_it = map_key.begin();
-   auto rhs_it = queue.map_key.begin();
-   while (lhs_it != map_key.end() && rhs_it != queue.map_key.end()) {
-      if (*lhs_it->first == *rhs_it->first) {
-         if (lhs_it->second.size() == rhs_it->second.size()) {
-            auto lhs_set_it = lhs_it->second.begin();
-            auto rhs_set_it = rhs_it->second.begin();
-            while (lhs_set_it != lhs_it->second.end()) {
-               if (**lhs_set_it == **rhs_set_it) {
-                  ++lhs_set_it;
-                  ++rhs_set_it;
-               } else {
-                  return **lhs_set_it < **rhs_set_it;
-               }
-            }
-         } else {
-            return lhs_it->second.size() > rhs_it->second.size();
-         }
-      } else {
-         return *lhs_it->first < *rhs_it->first;
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::operator<(
+   const PriorityQueue<K, V, A, B>& queue) const {
+   // Porównujemy kolejne grupy par o równym kluczu: najpierw klucze, potem
+   // liczności grup (liczniejsza jest mniejsza), a na końcu wartości.
+   auto group_end = [](hook_t* h) {
+      hook_t* end = live_key(tree_t::next(h));
+      while (end && key_node(end)->key == key_node(h)->key)
+         end = live_key(tree_t::next(end));
+      return end;
+   };
+   auto group_size = [](hook_t* begin, hook_t* end) {
+      size_type n = 0;
+      for (; begin != end; begin = live_key(tree_t::next(begin)))
+         ++n;
+      return n;
+   };
+
+   hook_t* lhs_it = live_key(map_key.first());
+   hook_t* rhs_it = live_key(queue.map_key.first());
+   while (lhs_it && rhs_it) {
+      const K& lhs_key = key_node(lhs_it)->key;
+      const K& rhs_key = key_node(rhs_it)->key;
+      if (!(lhs_key == rhs_key))
+         return lhs_key < rhs_key;
+
+      hook_t* lhs_end = group_end(lhs_it);
+      hook_t* rhs_end = group_end(rhs_it);
+      size_type lhs_size = group_size(lhs_it, lhs_end);
+      size_type rhs_size = group_size(rhs_it, rhs_end);
+      if (lhs_size != rhs_size)
+         return lhs_size > rhs_size;
+
+      while (lhs_it != lhs_end) {
+         const V& lhs_value = key_node(lhs_it)->value;
+         const V& rhs_value = key_node(rhs_it)->value;
+         if (!(lhs_value == rhs_value))
+            return lhs_value < rhs_value;
+         lhs_it = live_key(tree_t::next(lhs_it));
+         rhs_it = live_key(tree_t::next(rhs_it));
       }
-      ++lhs_it;
-      ++rhs_it;
    }
-   return (lhs_it == map_key.end() && rhs_it != queue.map_key.end());
+   return (!lhs_it && rhs_it);
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::operator>(const PriorityQueue<K, V>& queue) const {
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::operator>(
+   const PriorityQueue<K, V, A, B>& queue) const {
    return queue < *this;
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::operator>=(const PriorityQueue<K, V>& queue) const {
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::operator>=(
+   const PriorityQueue<K, V, A, B>& queue) const {
    return !(*this < queue);
 }
 
-template<typename K, typename V>
-bool PriorityQueue<K, V>::operator<=(const PriorityQueue<K, V>& queue) const {
+template<typename K, typename V, typename A, typename B>
+bool PriorityQueue<K, V, A, B>::operator<=(
+   const PriorityQueue<K, V, A, B>& queue) const {
    return !(*this > queue);
 }
 
@@ -0,0 +1,407 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* Strategia RadixHeapBackend: kolejka monotoniczna (radix heap) dla          */
+/* całkowitoliczbowych wartości V, np. odległości w algorytmie Dijkstry lub   */
+/* terminów w kolejkach timeoutów. Wartości są dzielone na kubełki według     */
+/* najstarszego bitu, którym różnią się od ostatniego zgłoszonego minimum     */
+/* (last): kubełek 0 to wartości równe last, a kubełek i > 0 - wartości,      */
+/* których najstarszy różny bit ma numer i - 1. Kubełki są listami            */
+/* dwukierunkowymi węzłów, więc wstawienie i zmiana wartości działają w O(1)  */
+/* (poza wyszukaniem klucza), a deleteMin w O(log C) zamortyzowanym, gdzie C  */
+/* to zakres wartości.                                                        */
+/*                                                                            */
+/* Kolejka wymaga monotoniczności: wartość wstawiana lub przypisywana przez   */
+/* changeValue nie może być mniejsza od ostatniego minimum zgłoszonego przez  */
+/* minValue, minKey lub usuniętego przez deleteMin. Naruszenie jest wykrywane */
+/* i zgłaszane wyjątkiem PriorityQueueMonotonicityException, a kolejka        */
+/* pozostaje bez zmian.                                                       */
+/*                                                                            */
+/* Dostępne są insert, emplace, minValue, minKey, deleteMin, changeValue      */
+/* (także zwiększenie wartości, o ile jest ona nie mniejsza od last), swap    */
+/* i kopiowanie; nie ma operacji na maksimum, uchwytów, merge ani porównań    */
+/* kolejek. Klucze są indeksowane intruzyjnym drzewem AVL z priorityqueue.hh. */
+/*============================================================================*/
+
+#ifndef __RADIXHEAP_HH__
+#define __RADIXHEAP_HH__
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+class PriorityQueueMonotonicityException: public std::exception {
+
+public:
+
+   virtual const char* what() const noexcept {
+      return "PriorityQueueMonotonicityException";
+   }
+};
+
+namespace pq_detail {
+
+// Liczba bitów znaczących x (0 dla x == 0).
+inline unsigned bit_width(uint64_t x) noexcept {
+#if defined(__GNUC__)
+   return x ? 64 - __builtin_clzll(x) : 0;
+#else
+   unsigned n = 0;
+   for (; x; x >>= 1)
+      ++n;
+   return n;
+#endif
+}
+
+// Najmłodszy ustawiony bit x != 0.
+inline unsigned lowest_bit(uint64_t x) noexcept {
+#if defined(__GNUC__)
+   return __builtin_ctzll(x);
+#else
+   unsigned n = 0;
+   for (; !(x & 1); x >>= 1)
+      ++n;
+   return n;
+#endif
+}
+
+} // namespace pq_detail
+
+struct RadixHeapBackend {};
+
+template<typename K, typename V, typename Allocator>
+class PriorityQueue<K, V, Allocator, RadixHeapBackend> {
+
+   static_assert(std::is_integral<V>::value && !std::is_same<V, bool>::value &&
+                 sizeof(V) <= sizeof(uint64_t),
+                 "RadixHeapBackend: V musi być typem całkowitoliczbowym");
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using allocator_type = Allocator;
+
+   /**
+    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
+    */
+   PriorityQueue() {}
+
+   explicit PriorityQueue(const Allocator& alloc) : alloc(alloc) {}
+
+   /**
+    * Konstruktor kopiujący; kopia ma te same kubełki i to samo ostatnie
+    * minimum. [O(queue.size())]
+    */
+   PriorityQueue(const PriorityQueue& queue)
+      : alloc(node_traits_t::select_on_container_copy_construction(
+           queue.alloc)),
+        last(queue.last) {
+      std::vector<hook_t*> keys;
+      keys.reserve(queue.counter);
+      try {
+         for (hook_t* h = queue.map_key.first(); h; h = tree_t::next(h)) {
+            const Node* n = key_node(h);
+            // Miejsce zarezerwowane, no-throw.
+            keys.push_back(create_node(n->key, n->value));
+         }
+      } catch (...) {
+         for (hook_t* h : keys)
+            destroy_node(key_node(h));
+         throw;
+      }
+      map_key.build(keys.data(), keys.data() + keys.size());
+      for (hook_t* h : keys)
+         push(key_node(h));
+      counter = queue.counter;
+   }
+
+   /**
+    * Konstruktor przenoszący [O(log C)] i operator przypisania (kopiowanie
+    * i zamiana).
+    */
+   PriorityQueue(PriorityQueue&& queue) : alloc(queue.alloc) {
+      swap(queue);
+   }
+
+   PriorityQueue& operator=(PriorityQueue queue) {
+      queue.swap(*this);
+      return *this;
+   }
+
+   /**
+    * Destruktor zwalniający wszystkie węzły. [O(size())]
+    */
+   ~PriorityQueue() {
+      map_key.dispose([this](hook_t* h) { destroy_node(key_node(h)); });
+   }
+
+   allocator_type get_allocator() const {
+      return allocator_type(alloc);
+   }
+
+   bool empty() const {
+      return counter == 0;
+   }
+
+   size_type size() const {
+      return counter;
+   }
+
+   /**
+    * Metody wstawiające parę do kolejki [O(log size())]; wartość mniejsza
+    * od ostatniego minimum powoduje zgłoszenie wyjątku
+    * PriorityQueueMonotonicityException.
+    */
+   void insert(const K& key, const V& value) {
+      insert_pair(key, value);
+   }
+
+   void insert(K&& key, V&& value) {
+      insert_pair(std::move(key), std::move(value));
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      Node* n = create_node(std::forward<KK>(key), std::forward<VV>(value));
+      try {
+         check(n->value);
+         position_t pos = key_position(n->key); // O(log size())
+         link(n, pos);
+      } catch (...) {
+         destroy_node(n);
+         throw;
+      }
+   }
+
+   /**
+    * Najmniejsza wartość i jej klucz [O(log C) zamortyzowane]; dla pustej
+    * kolejki zgłaszają wyjątek PriorityQueueEmptyException. Zgłoszone
+    * minimum staje się dolnym ograniczeniem dla kolejnych wartości.
+    */
+   const V& minValue() const {
+      return min_node()->value;
+   }
+
+   const K& minKey() const {
+      return min_node()->key;
+   }
+
+   /**
+    * Usunięcie pary o najmniejszej wartości. [O(log C) zamortyzowane]
+    */
+   void deleteMin() {
+      if (empty())
+         return;
+      Node* n = min_node();
+      unlink(n);
+      destroy_node(n);
+   }
+
+   /**
+    * Zmiana wartości pary o kluczu key na value [O(log size())]; brak
+    * klucza powoduje wyjątek PriorityQueueNotFoundException, a wartość
+    * mniejsza od ostatniego minimum - PriorityQueueMonotonicityException.
+    * Przy wielu parach o kluczu key zmieniana jest dowolna z nich.
+    */
+   void changeValue(const K& key, const V& value) {
+      Node* n = find_key(key); // O(log size())
+      if (!n)
+         throw PriorityQueueNotFoundException();
+      check(value);
+      // Od tego miejsca nic nie zgłasza wyjątku.
+      remove(n);
+      n->value = value;
+      push(n);
+   }
+
+   /**
+    * Zamiana zawartości z kolejką queue. [O(log C)]
+    */
+   void swap(PriorityQueue& queue) {
+      using std::swap;
+      swap(alloc, queue.alloc);
+      map_key.swap(queue.map_key);
+      buckets.swap(queue.buckets);
+      std::swap(used, queue.used);
+      std::swap(last, queue.last);
+      std::swap(counter, queue.counter);
+   }
+
+private:
+
+   using hook_t = pq_detail::TreeHook;
+   using position_t = pq_detail::Position;
+   using tree_t = pq_detail::Tree;
+   using bits_t = typename std::make_unsigned<V>::type;
+
+   static constexpr unsigned bucket_count =
+      std::numeric_limits<bits_t>::digits + 1;
+
+   // Węzeł podpięty do indeksu kluczy i do listy swojego kubełka.
+   struct Node: pq_detail::KeyHook {
+      template<typename KK, typename VV>
+      Node(KK&& k, VV&& v) : key(std::forward<KK>(k)),
+                             value(std::forward<VV>(v)) {}
+
+      K key;
+      V value;
+      Node* prev = nullptr;
+      Node* next = nullptr;
+      unsigned bucket = 0;
+   };
+
+   static Node* key_node(hook_t* h) {
+      return static_cast<Node*>(static_cast<pq_detail::KeyHook*>(h));
+   }
+
+   using node_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<Node>;
+   using node_traits_t = std::allocator_traits<node_allocator_t>;
+
+   template<typename... Args>
+   Node* create_node(Args&&... args) {
+      Node* n = node_traits_t::allocate(alloc, 1);
+      try {
+         node_traits_t::construct(alloc, n, std::forward<Args>(args)...);
+      } catch (...) {
+         node_traits_t::deallocate(alloc, n, 1);
+         throw;
+      }
+      return n;
+   }
+
+   void destroy_node(Node* n) {
+      node_traits_t::destroy(alloc, n);
+      node_traits_t::deallocate(alloc, n, 1);
+   }
+
+   // Wartość jako liczba bez znaku zachowująca porządek (dla typów ze
+   // znakiem odwracamy bit znaku).
+   static bits_t bits(V value) {
+      bits_t b = static_cast<bits_t>(value);
+      if (std::is_signed<V>::value)
+         b ^= bits_t(1) << (std::numeric_limits<bits_t>::digits - 1);
+      return b;
+   }
+
+   void check(V value) const {
+      if (bits(value) < last)
+         throw PriorityQueueMonotonicityException();
+   }
+
+   // Pozycja nowego klucza; równe klucze trafiają na prawo.
+   position_t key_position(const K& key) const {
+      position_t pos{nullptr, false};
+      hook_t* h = map_key.root();
+      while (h) {
+         pos.parent = h;
+         pos.left = key < key_node(h)->key;
+         h = pos.left ? h->left : h->right;
+      }
+      return pos;
+   }
+
+   Node* find_key(const K& key) const {
+      hook_t* h = map_key.root();
+      while (h) {
+         const K& cur = key_node(h)->key;
+         if (key < cur)
+            h = h->left;
+         else if (cur < key)
+            h = h->right;
+         else
+            return key_node(h);
+      }
+      return nullptr;
+   }
+
+   template<typename KK, typename VV>
+   void insert_pair(KK&& key, VV&& value) {
+      check(value);
+      position_t pos = key_position(key); // O(log size())
+      Node* n = create_node(std::forward<KK>(key), std::forward<VV>(value));
+      // Od tego miejsca nic nie zgłasza wyjątku.
+      link(n, pos);
+   }
+
+   void link(Node* n, position_t pos) {
+      map_key.link(n, pos);
+      push(n);
+      ++counter;
+   }
+
+   void unlink(Node* n) {
+      map_key.unlink(n);
+      remove(n);
+      --counter;
+   }
+
+   // Dopisanie węzła do kubełka wyznaczonego przez jego wartość. [O(1)]
+   void push(Node* n) const {
+      n->bucket = pq_detail::bit_width(bits(n->value) ^ last);
+      n->prev = nullptr;
+      n->next = buckets[n->bucket];
+      if (n->next)
+         n->next->prev = n;
+      buckets[n->bucket] = n;
+      if (n->bucket != 0)
+         used |= uint64_t(1) << (n->bucket - 1);
+   }
+
+   // Wypięcie węzła z jego kubełka. [O(1)]
+   void remove(Node* n) const {
+      if (n->prev)
+         n->prev->next = n->next;
+      else
+         buckets[n->bucket] = n->next;
+      if (n->next)
+         n->next->prev = n->prev;
+      if (n->bucket != 0 && !buckets[n->bucket])
+         used &= ~(uint64_t(1) << (n->bucket - 1));
+   }
+
+   // Węzeł o najmniejszej wartości. Gdy kubełek 0 jest pusty, last staje
+   // się minimum pierwszego niepustego kubełka, którego węzły trafiają do
+   // niższych kubełków - każdy węzeł schodzi tak co najwyżej log C razy.
+   // Zmieniane są tylko pola mutable, więc metoda jest const.
+   Node* min_node() const {
+      if (empty())
+         throw PriorityQueueEmptyException();
+      if (!buckets[0]) {
+         unsigned b = pq_detail::lowest_bit(used) + 1;
+         Node* list = buckets[b];
+         bits_t min = bits(list->value);
+         for (Node* n = list->next; n; n = n->next)
+            if (bits(n->value) < min)
+               min = bits(n->value);
+         buckets[b] = nullptr;
+         used &= ~(uint64_t(1) << (b - 1));
+         last = min;
+         while (list) {
+            Node* n = list;
+            list = list->next;
+            push(n);
+         }
+      }
+      return buckets[0];
+   }
+
+   node_allocator_t alloc;
+   tree_t map_key;
+   // Stan kubełków: głowy list, maska niepustych kubełków 1.. (bit i - 1
+   // dla kubełka i) i ostatnie zgłoszone minimum.
+   mutable std::array<Node*, bucket_count> buckets{};
+   mutable uint64_t used = 0;
+   mutable bits_t last = 0;
+   size_type counter = 0;
+};
+
+#endif /* __RADIXHEAP_HH__ */
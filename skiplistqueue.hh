@@ -0,0 +1,570 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* Strategia LockFreeSkipListBackend: współbieżna kolejka priorytetowa bez    */
+/* blokad o ścisłym porządku, na liście z przeskokami (skiplist) według       */
+/* algorytmu Lindéna i Jonssona. Lista jest uporządkowana po wartościach      */
+/* (równe wartości w kolejności wstawiania). Usunięcie węzła jest logiczne:   */
+/* deleteMin ustawia najmłodszy bit wskaźnika next[0] poprzednika (fetch_or), */
+/* więc usunięte węzły tworzą prefiks listy. Fizycznie prefiks jest           */
+/* odcinany dopiero, gdy urośnie do bound_offset węzłów - jednym CAS na       */
+/* głowie listy, po którym poprawiane są wyższe poziomy. Dzięki temu wątki    */
+/* usuwające minimum rzadko piszą do tych samych linii pamięci.               */
+/*                                                                            */
+/* Odcięte węzły są zwalniane przez mechanizm epok (EpochDomain): każda       */
+/* operacja przypina bieżącą epokę, a węzeł odpięty w epoce e jest zwalniany  */
+/* dopiero po przejściu do epoki e + 2, gdy żaden wątek nie może już mieć     */
+/* do niego wskaźnika.                                                        */
+/*                                                                            */
+/* deleteMin i tryPopMin są linearyzowalne. changeValue to linearyzowalne     */
+/* usunięcie pary (CAS na stanie węzła), po którym następuje wstawienie       */
+/* nowej pary - współbieżny deleteMin może zobaczyć stan pośredni. Wyszukanie */
+/* klucza przegląda listę, więc changeValue działa w czasie O(size()).        */
+/*                                                                            */
+/* Ograniczenia: minValue i minKey zwracają kopie (węzeł może zostać          */
+/* usunięty przez inny wątek), popMin kopiuje parę, porównania V nie mogą     */
+/* zgłaszać wyjątków, a alokator musi być bezpieczny wielowątkowo (np.        */
+/* std::allocator). Nie ma operacji na maksimum, uchwytów, kopiowania         */
+/* ani scalania kolejek.                                                      */
+/*============================================================================*/
+
+#ifndef __SKIPLISTQUEUE_HH__
+#define __SKIPLISTQUEUE_HH__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "priorityqueue.hh"
+
+namespace pq_detail {
+
+// Odzyskiwanie pamięci oparte na epokach. Wątki przypinają się do bieżącej
+// epoki (liczniki aktywnych wątków są rozłożone na paski, aby nie walczyć
+// o jedną linię pamięci), a odpięte obiekty trafiają na listę swojej epoki.
+// Epoka przesuwa się, gdy w poprzedniej nie ma już aktywnych wątków; wtedy
+// zwalniane są obiekty sprzed dwóch epok. Typ T musi mieć pole T* garbage.
+template<typename T>
+class EpochDomain {
+
+public:
+
+   // Przypięcie bieżącej epoki na czas życia obiektu.
+   class Pin {
+
+   public:
+
+      explicit Pin(EpochDomain& domain) : domain(domain) {
+         Stripe& s = domain.stripe();
+         while (true) {
+            epoch = domain.global.load();
+            s.active[epoch % 3].fetch_add(1);
+            if (domain.global.load() == epoch)
+               break;
+            s.active[epoch % 3].fetch_sub(1);
+         }
+      }
+
+      ~Pin() {
+         domain.stripe().active[epoch % 3].fetch_sub(1);
+      }
+
+      Pin(const Pin&) = delete;
+
+      Pin& operator=(const Pin&) = delete;
+
+   private:
+
+      EpochDomain& domain;
+      uint64_t epoch;
+   };
+
+   EpochDomain() {}
+
+   EpochDomain(const EpochDomain&) = delete;
+
+   EpochDomain& operator=(const EpochDomain&) = delete;
+
+   // Odłożenie łańcucha first -> ... -> last (połączonego polem garbage)
+   // do zwolnienia. Wątek musi mieć przypiętą epokę.
+   void retire(T* first, T* last) noexcept {
+      std::atomic<T*>& list = retired[global.load() % 3];
+      T* head = list.load();
+      do {
+         last->garbage = head;
+      } while (!list.compare_exchange_weak(head, first));
+   }
+
+   // Próba przesunięcia epoki; przy powodzeniu obiekty odpięte dwie epoki
+   // wcześniej są przekazywane do free.
+   template<typename F>
+   void collect(F free) noexcept {
+      uint64_t e = global.load();
+      for (Stripe& s : stripes)
+         if (s.active[(e + 2) % 3].load() != 0)
+            return;
+      if (!global.compare_exchange_strong(e, e + 1))
+         return;
+      release(retired[(e + 2) % 3].exchange(nullptr), free);
+   }
+
+   // Zwolnienie wszystkich odpiętych obiektów; tylko bez współbieżnych
+   // operacji (np. w destruktorze kolejki).
+   template<typename F>
+   void clear(F free) noexcept {
+      for (auto& list : retired)
+         release(list.exchange(nullptr), free);
+   }
+
+private:
+
+   struct alignas(64) Stripe {
+      std::atomic<int> active[3] = {{0}, {0}, {0}};
+   };
+
+   static const size_t stripe_count = 16;
+
+   Stripe& stripe() noexcept {
+      thread_local size_t index =
+         std::hash<std::thread::id>()(std::this_thread::get_id()) %
+         stripe_count;
+      return stripes[index];
+   }
+
+   template<typename F>
+   static void release(T* list, F& free) noexcept {
+      while (list) {
+         T* next = list->garbage;
+         free(list);
+         list = next;
+      }
+   }
+
+   std::atomic<uint64_t> global{0};
+   Stripe stripes[stripe_count];
+   std::atomic<T*> retired[3] = {{nullptr}, {nullptr}, {nullptr}};
+};
+
+} // namespace pq_detail
+
+struct LockFreeSkipListBackend {};
+
+template<typename K, typename V, typename Allocator>
+class PriorityQueue<K, V, Allocator, LockFreeSkipListBackend> {
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using allocator_type = Allocator;
+
+   /**
+    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
+    */
+   PriorityQueue() {
+      init();
+   }
+
+   explicit PriorityQueue(const Allocator& alloc) : alloc(alloc) {
+      init();
+   }
+
+   PriorityQueue(const PriorityQueue&) = delete;
+
+   PriorityQueue& operator=(const PriorityQueue&) = delete;
+
+   /**
+    * Destruktor zwalniający wszystkie węzły; nie może działać współbieżnie
+    * z innymi operacjami. [O(size())]
+    */
+   ~PriorityQueue() {
+      Tower* t = unmarked(head.next[0].load());
+      while (t != &tail) {
+         Tower* next = unmarked(t->next[0].load());
+         destroy_node(node(t));
+         t = next;
+      }
+      epochs.clear([this](Node* n) { destroy_node(n); });
+   }
+
+   allocator_type get_allocator() const {
+      return allocator_type(alloc);
+   }
+
+   /**
+    * Liczba par w kolejce; przybliżona, gdy trwają inne operacje. [O(1)]
+    */
+   size_type size() const {
+      return counter.load();
+   }
+
+   bool empty() const {
+      return size() == 0;
+   }
+
+   /**
+    * Metody wstawiające parę do kolejki. [O(log size()) oczekiwanie]
+    */
+   void insert(const K& key, const V& value) {
+      emplace(key, value);
+   }
+
+   void insert(K&& key, V&& value) {
+      emplace(std::move(key), std::move(value));
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      Node* n = create_node(std::forward<KK>(key), std::forward<VV>(value));
+      Pin pin(epochs);
+      link(n);
+   }
+
+   /**
+    * Kopie najmniejszej wartości i jej klucza [O(1) poza przejściem przez
+    * usunięty prefiks]; dla pustej kolejki zgłaszają wyjątek
+    * PriorityQueueEmptyException.
+    */
+   V minValue() const {
+      Pin pin(epochs);
+      return first_live()->value;
+   }
+
+   K minKey() const {
+      Pin pin(epochs);
+      return first_live()->key;
+   }
+
+   /**
+    * Usunięcie pary o najmniejszej wartości (linearyzowalne). [O(log size())
+    * zamortyzowane]
+    */
+   void deleteMin() {
+      Pin pin(epochs);
+      claim_min();
+   }
+
+   /**
+    * Usunięcie i zwrócenie (kopii) pary o najmniejszej wartości; dla pustej
+    * kolejki popMin zgłasza PriorityQueueEmptyException, a tryPopMin zwraca
+    * std::nullopt. [O(log size()) zamortyzowane]
+    */
+   std::pair<K, V> popMin() {
+      if (auto result = tryPopMin())
+         return std::move(*result);
+      throw PriorityQueueEmptyException();
+   }
+
+   std::optional<std::pair<K, V>> tryPopMin() {
+      Pin pin(epochs);
+      // Węzeł może być jednocześnie czytany przez inne wątki, więc para
+      // jest kopiowana, a nie przenoszona.
+      if (Node* n = claim_min())
+         return std::pair<K, V>(n->key, n->value);
+      return std::nullopt;
+   }
+
+   /**
+    * Zmiana wartości pary o kluczu key na value [O(size())]: usunięcie
+    * pary (linearyzowalne) i wstawienie nowej. W przypadku braku klucza
+    * zgłaszany jest wyjątek PriorityQueueNotFoundException.
+    */
+   void changeValue(const K& key, const V& value) {
+      Node* fresh = create_node(key, value);
+      Pin pin(epochs);
+      bool found;
+      try {
+         found = replace(key); // Porównania K mogą zgłosić wyjątek.
+      } catch (...) {
+         destroy_node(fresh);
+         throw;
+      }
+      if (!found) {
+         destroy_node(fresh);
+         throw PriorityQueueNotFoundException();
+      }
+      link(fresh);
+   }
+
+private:
+
+   static const int max_level = 32;
+   static const size_t bound_offset = 64;
+
+   using link_t = std::atomic<uintptr_t>;
+
+   // Wieża wskaźników; najmłodszy bit next[0] oznacza, że następnik
+   // na poziomie 0 jest usunięty. Głowa i ogon listy to same wieże.
+   struct Tower {
+      link_t* next = nullptr;
+      int level = 0;
+      std::atomic<bool> inserting{false};
+   };
+
+   enum State { LIVE, TAKEN, REPLACED };
+
+   // Węzeł z parą; jego wieża leży w pamięci tuż za nim.
+   struct Node: Tower {
+      template<typename KK, typename VV>
+      Node(KK&& k, VV&& v) : key(std::forward<KK>(k)),
+                             value(std::forward<VV>(v)) {}
+
+      K key;
+      V value;
+      std::atomic<int> state{LIVE};
+      Node* garbage = nullptr;
+   };
+
+   using node_allocator_t = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<Node>;
+   using node_traits_t = std::allocator_traits<node_allocator_t>;
+   using Pin = typename pq_detail::EpochDomain<Node>::Pin;
+
+   static Tower* unmarked(uintptr_t p) {
+      return reinterpret_cast<Tower*>(p & ~uintptr_t(1));
+   }
+
+   static bool marked(uintptr_t p) {
+      return p & 1;
+   }
+
+   static uintptr_t ptr(Tower* t) {
+      return reinterpret_cast<uintptr_t>(t);
+   }
+
+   static Node* node(Tower* t) {
+      return static_cast<Node*>(t);
+   }
+
+   // Liczba obiektów Node mieszczących węzeł z wieżą wysokości level.
+   static size_t blocks(int level) {
+      return 1 + (level * sizeof(link_t) + sizeof(Node) - 1) / sizeof(Node);
+   }
+
+   // Losowa wysokość wieży (rozkład geometryczny z p = 1/2).
+   static int random_level() {
+      thread_local uint64_t state =
+         std::hash<std::thread::id>()(std::this_thread::get_id()) |
+         0x9E3779B97F4A7C15ull;
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      uint64_t r = state * 0x2545F4914F6CDD1Dull;
+      int level = 1;
+      while (level < max_level && (r & 1)) {
+         ++level;
+         r >>= 1;
+      }
+      return level;
+   }
+
+   template<typename KK, typename VV>
+   Node* create_node(KK&& key, VV&& value) {
+      int level = random_level();
+      Node* n = node_traits_t::allocate(alloc, blocks(level));
+      try {
+         node_traits_t::construct(alloc, n, std::forward<KK>(key),
+                                  std::forward<VV>(value));
+      } catch (...) {
+         node_traits_t::deallocate(alloc, n, blocks(level));
+         throw;
+      }
+      n->level = level;
+      n->next = reinterpret_cast<link_t*>(n + 1);
+      for (int i = 0; i < level; ++i)
+         new (&n->next[i]) link_t(0);
+      n->inserting.store(true);
+      return n;
+   }
+
+   void destroy_node(Node* n) {
+      int level = n->level;
+      node_traits_t::destroy(alloc, n);
+      node_traits_t::deallocate(alloc, n, blocks(level));
+   }
+
+   void init() {
+      for (int i = 0; i < max_level; ++i)
+         head_links[i].store(ptr(&tail));
+      tail_links[0].store(0);
+      head.next = head_links;
+      head.level = max_level;
+      tail.next = tail_links;
+   }
+
+   // Poprzedniki i następniki miejsca dla wartości value na każdym
+   // poziomie, z pominięciem usuniętego prefiksu. Zwraca ostatni węzeł
+   // prefiksu napotkany na poziomie 0 (lub nullptr).
+   Tower* locate(const V& value, Tower** preds, Tower** succs) {
+      Tower* del = nullptr;
+      Tower* pred = &head;
+      for (int i = max_level - 1; i >= 0; --i) {
+         uintptr_t raw = pred->next[i].load();
+         Tower* cur = unmarked(raw);
+         while (cur != &tail && ((i == 0 && marked(raw)) ||
+                                 marked(cur->next[0].load()) ||
+                                 !(value < node(cur)->value))) {
+            if (i == 0 && marked(raw))
+               del = cur;
+            pred = cur;
+            raw = pred->next[i].load();
+            cur = unmarked(raw);
+         }
+         preds[i] = pred;
+         succs[i] = cur;
+      }
+      return del;
+   }
+
+   // Podpięcie węzła: najpierw na poziomie 0 (punkt linearyzacji), potem
+   // na wyższych poziomach, chyba że węzeł został w międzyczasie usunięty.
+   void link(Node* n) {
+      Tower* preds[max_level];
+      Tower* succs[max_level];
+      Tower* del;
+      counter.fetch_add(1);
+      while (true) {
+         del = locate(n->value, preds, succs);
+         n->next[0].store(ptr(succs[0]));
+         uintptr_t expected = ptr(succs[0]);
+         if (preds[0]->next[0].compare_exchange_strong(expected, ptr(n)))
+            break;
+      }
+      int i = 1;
+      while (i < n->level) {
+         n->next[i].store(ptr(succs[i]));
+         if (marked(n->next[0].load()) ||
+             marked(succs[i]->next[0].load()) || del == succs[i])
+            break;
+         uintptr_t expected = ptr(succs[i]);
+         if (preds[i]->next[i].compare_exchange_strong(expected, ptr(n))) {
+            ++i;
+         } else {
+            del = locate(n->value, preds, succs);
+            if (succs[0] != n)
+               break;
+         }
+      }
+      n->inserting.store(false);
+   }
+
+   // Pierwszy nieusunięty węzeł z aktualną parą.
+   Node* first_live() const {
+      const Tower* x = &head;
+      while (true) {
+         uintptr_t raw = x->next[0].load();
+         Tower* t = unmarked(raw);
+         if (t == &tail)
+            throw PriorityQueueEmptyException();
+         if (!marked(raw) && node(t)->state.load() == LIVE)
+            return node(t);
+         x = t;
+      }
+   }
+
+   // Logiczne usunięcie minimum; zwraca usunięty węzeł (ważny do końca
+   // przypięcia epoki) lub nullptr dla pustej kolejki. Gdy prefiks jest
+   // dość długi, odcina go i odkłada jego węzły do zwolnienia.
+   Node* claim_min() {
+      Tower* x = &head;
+      Tower* newhead = nullptr;
+      uintptr_t obshead = head.next[0].load();
+      size_t offset = 0;
+      while (true) {
+         uintptr_t raw = x->next[0].load();
+         if (unmarked(raw) == &tail)
+            return nullptr;
+         if (!newhead && x->inserting.load())
+            newhead = x;
+         if (!marked(raw))
+            raw = x->next[0].fetch_or(1);
+         ++offset;
+         x = unmarked(raw);
+         if (marked(raw))
+            continue;
+         // Następnik x należy do nas; pomijamy pary zastąpione przez
+         // changeValue.
+         int live = LIVE;
+         if (node(x)->state.compare_exchange_strong(live, TAKEN))
+            break;
+      }
+      counter.fetch_sub(1);
+      if (!newhead)
+         newhead = x;
+      if (offset >= bound_offset && head.next[0].load() == obshead &&
+          head.next[0].compare_exchange_strong(obshead, ptr(newhead) | 1)) {
+         restructure();
+         Tower* first = unmarked(obshead);
+         if (first != newhead) {
+            Tower* last = first;
+            while (unmarked(last->next[0].load()) != newhead) {
+               Tower* next = unmarked(last->next[0].load());
+               node(last)->garbage = node(next);
+               last = next;
+            }
+            epochs.retire(node(first), node(last));
+            epochs.collect([this](Node* n) { destroy_node(n); });
+         }
+      }
+      return node(x);
+   }
+
+   // Przesunięcie wyższych poziomów głowy za usunięty prefiks.
+   void restructure() {
+      Tower* pred = &head;
+      int i = max_level - 1;
+      while (i > 0) {
+         uintptr_t h = head.next[i].load();
+         Tower* first = unmarked(h);
+         if (first == &tail || !marked(first->next[0].load())) {
+            --i;
+            continue;
+         }
+         Tower* cur = unmarked(pred->next[i].load());
+         while (cur != &tail && marked(cur->next[0].load())) {
+            pred = cur;
+            cur = unmarked(pred->next[i].load());
+         }
+         if (head.next[i].compare_exchange_strong(h, pred->next[i].load()))
+            --i;
+      }
+   }
+
+   // Znalezienie aktualnej pary o kluczu key i oznaczenie jej jako
+   // zastąpionej; false, gdy takiej pary nie ma.
+   bool replace(const K& key) {
+      Tower* x = &head;
+      while (true) {
+         uintptr_t raw = x->next[0].load();
+         Tower* t = unmarked(raw);
+         if (t == &tail)
+            return false;
+         Node* n = node(t);
+         if (!marked(raw) && n->state.load() == LIVE &&
+             !(key < n->key) && !(n->key < key)) {
+            int live = LIVE;
+            if (n->state.compare_exchange_strong(live, REPLACED)) {
+               counter.fetch_sub(1);
+               return true;
+            }
+         }
+         x = t;
+      }
+   }
+
+   node_allocator_t alloc;
+   Tower head;
+   Tower tail;
+   link_t head_links[max_level];
+   link_t tail_links[1];
+   std::atomic<size_type> counter{0};
+   mutable pq_detail::EpochDomain<Node> epochs;
+};
+
+#endif /* __SKIPLISTQUEUE_HH__ */
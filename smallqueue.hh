@@ -0,0 +1,829 @@
+/*============================================================================*/
+/*                  JNP Grupa 7 - Zadanie 5 - Priority Queue                  */
+/*============================================================================*/
+/* Strategia SmallFlatBackend<N>: kolejka dla niewielu par (domyślnie do 64). */
+/* Dopóki kolejka ma co najwyżej N par, trzyma je w obiekcie kolejki, bez     */
+/* alokacji, w dwóch tablicach (klucze osobno, wartości osobno - układ        */
+/* structure-of-arrays) w kolejności wstawiania. Minimum i maksimum są        */
+/* wyszukiwane przeglądem tablicy wartości, dla int32_t, uint32_t, float      */
+/* i double instrukcjami wektorowymi (AVX2/AVX, a bez nich SSE4.1/SSE2).      */
+/* Wstawienie (N + 1)-szej pary przenosi kolejkę do domyślnej reprezentacji   */
+/* (PriorityQueue<K, V, Allocator>), a gdy po usunięciach zostanie w niej     */
+/* co najwyżej N / 4 par, wracają one do tablic.                              */
+/*                                                                            */
+/* Porządek remisów jest taki sam jak w domyślnej strategii: spośród równych  */
+/* wartości minimum to para wstawiona najwcześniej, a maksimum - najpóźniej;  */
+/* changeValue traktuje zmienioną parę jak nowo wstawioną.                    */
+/*                                                                            */
+/* Dostępne są insert, emplace, minValue, maxValue, minKey, maxKey,           */
+/* deleteMin, deleteMax, popMin, popMax, tryPopMin, tryPopMax, extractMin,    */
+/* extractMax, changeValue, contains, count, eraseKey, eraseAll, merge, swap, */
+/* kopiowanie oraz operatory porównania kolejek. K i V muszą być przenoszone  */
+/* bez wyjątków.                                                              */
+/*============================================================================*/
+
+#ifndef __SMALLQUEUE_HH__
+#define __SMALLQUEUE_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "priorityqueue.hh"
+
+namespace pq_detail {
+
+// Operacje wektorowe dla typu wartości T: lanes elementów w rejestrze,
+// min, max i maska bitowa równych elementów. Dla pozostałych typów
+// przegląd jest skalarny.
+template<typename T>
+struct FlatSimd {
+   static constexpr bool enabled = false;
+};
+
+#if defined(__AVX2__)
+
+template<typename T, bool Unsigned>
+struct FlatSimdInt32 {
+   static constexpr bool enabled = true;
+   static constexpr size_t lanes = 8;
+   using vec = __m256i;
+
+   static vec load(const T* p) {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+   }
+   static void store(T* p, vec x) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+   }
+   static vec min(vec a, vec b) {
+      return Unsigned ? _mm256_min_epu32(a, b) : _mm256_min_epi32(a, b);
+   }
+   static vec max(vec a, vec b) {
+      return Unsigned ? _mm256_max_epu32(a, b) : _mm256_max_epi32(a, b);
+   }
+   static vec set1(T x) {
+      return _mm256_set1_epi32(static_cast<int>(x));
+   }
+   static unsigned equal(vec a, vec b) {
+      return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+   }
+};
+
+#elif defined(__SSE4_1__)
+
+template<typename T, bool Unsigned>
+struct FlatSimdInt32 {
+   static constexpr bool enabled = true;
+   static constexpr size_t lanes = 4;
+   using vec = __m128i;
+
+   static vec load(const T* p) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+   }
+   static void store(T* p, vec x) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+   }
+   static vec min(vec a, vec b) {
+      return Unsigned ? _mm_min_epu32(a, b) : _mm_min_epi32(a, b);
+   }
+   static vec max(vec a, vec b) {
+      return Unsigned ? _mm_max_epu32(a, b) : _mm_max_epi32(a, b);
+   }
+   static vec set1(T x) {
+      return _mm_set1_epi32(static_cast<int>(x));
+   }
+   static unsigned equal(vec a, vec b) {
+      return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+   }
+};
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+
+template<>
+struct FlatSimd<int32_t>: FlatSimdInt32<int32_t, false> {};
+
+template<>
+struct FlatSimd<uint32_t>: FlatSimdInt32<uint32_t, true> {};
+
+#endif
+
+#if defined(__AVX__)
+
+template<>
+struct FlatSimd<float> {
+   static constexpr bool enabled = true;
+   static constexpr size_t lanes = 8;
+   using vec = __m256;
+
+   static vec load(const float* p) { return _mm256_loadu_ps(p); }
+   static void store(float* p, vec x) { _mm256_storeu_ps(p, x); }
+   static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+   static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+   static vec set1(float x) { return _mm256_set1_ps(x); }
+   static unsigned equal(vec a, vec b) {
+      return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+   }
+};
+
+template<>
+struct FlatSimd<double> {
+   static constexpr bool enabled = true;
+   static constexpr size_t lanes = 4;
+   using vec = __m256d;
+
+   static vec load(const double* p) { return _mm256_loadu_pd(p); }
+   static void store(double* p, vec x) { _mm256_storeu_pd(p, x); }
+   static vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+   static vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+   static vec set1(double x) { return _mm256_set1_pd(x); }
+   static unsigned equal(vec a, vec b) {
+      return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+   }
+};
+
+#elif defined(__SSE2__)
+
+template<>
+struct FlatSimd<float> {
+   static constexpr bool enabled = true;
+   static constexpr size_t lanes = 4;
+   using vec = __m128;
+
+   static vec load(const float* p) { return _mm_loadu_ps(p); }
+   static void store(float* p, vec x) { _mm_storeu_ps(p, x); }
+   static vec min(vec a, vec b) { return _mm_min_ps(a, b); }
+   static vec max(vec a, vec b) { return _mm_max_ps(a, b); }
+   static vec set1(float x) { return _mm_set1_ps(x); }
+   static unsigned equal(vec a, vec b) {
+      return _mm_movemask_ps(_mm_cmpeq_ps(a, b));
+   }
+};
+
+template<>
+struct FlatSimd<double> {
+   static constexpr bool enabled = true;
+   static constexpr size_t lanes = 2;
+   using vec = __m128d;
+
+   static vec load(const double* p) { return _mm_loadu_pd(p); }
+   static void store(double* p, vec x) { _mm_storeu_pd(p, x); }
+   static vec min(vec a, vec b) { return _mm_min_pd(a, b); }
+   static vec max(vec a, vec b) { return _mm_max_pd(a, b); }
+   static vec set1(double x) { return _mm_set1_pd(x); }
+   static unsigned equal(vec a, vec b) {
+      return _mm_movemask_pd(_mm_cmpeq_pd(a, b));
+   }
+};
+
+#endif
+
+// Wektorowe wyszukanie skrajnej wartości w v[0, n), n >= S::lanes:
+// najpierw redukcja min/max (ostatni rejestr nachodzi na poprzedni), potem
+// pierwsza (dla minimum) lub ostatnia (dla maksimum) pozycja tej wartości.
+template<typename T, bool Max>
+size_t simd_extreme_index(const T* v, size_t n) {
+   using S = FlatSimd<T>;
+   typename S::vec m = S::load(v);
+   for (size_t i = S::lanes; i + S::lanes <= n; i += S::lanes)
+      m = Max ? S::max(m, S::load(v + i)) : S::min(m, S::load(v + i));
+   m = Max ? S::max(m, S::load(v + n - S::lanes))
+           : S::min(m, S::load(v + n - S::lanes));
+   T lane[S::lanes];
+   S::store(lane, m);
+   T best = lane[0];
+   for (size_t i = 1; i < S::lanes; ++i)
+      if (Max ? best < lane[i] : lane[i] < best)
+         best = lane[i];
+
+   typename S::vec target = S::set1(best);
+   if (!Max) {
+      for (size_t i = 0; ; i += S::lanes) {
+         size_t j = i + S::lanes <= n ? i : n - S::lanes;
+         if (unsigned mask = S::equal(S::load(v + j), target))
+            return j + __builtin_ctz(mask);
+      }
+   }
+   for (size_t j = n - S::lanes; ; j = j >= S::lanes ? j - S::lanes : 0)
+      if (unsigned mask = S::equal(S::load(v + j), target))
+         return j + 31 - __builtin_clz(mask);
+}
+
+// Pierwsza pozycja najmniejszej wartości w v[0, n), n > 0.
+template<typename T>
+size_t flat_min_index(const T* v, size_t n) {
+   if constexpr (FlatSimd<T>::enabled)
+      if (n >= FlatSimd<T>::lanes)
+         return simd_extreme_index<T, false>(v, n);
+   size_t best = 0;
+   for (size_t i = 1; i < n; ++i)
+      if (v[i] < v[best])
+         best = i;
+   return best;
+}
+
+// Ostatnia pozycja największej wartości w v[0, n), n > 0.
+template<typename T>
+size_t flat_max_index(const T* v, size_t n) {
+   if constexpr (FlatSimd<T>::enabled)
+      if (n >= FlatSimd<T>::lanes)
+         return simd_extreme_index<T, true>(v, n);
+   size_t best = 0;
+   for (size_t i = 1; i < n; ++i)
+      if (!(v[i] < v[best]))
+         best = i;
+   return best;
+}
+
+} // namespace pq_detail
+
+template<size_t N = 64>
+struct SmallFlatBackend {};
+
+template<typename K, typename V, typename Allocator, size_t N>
+class PriorityQueue<K, V, Allocator, SmallFlatBackend<N>> {
+
+   static_assert(N >= 4, "SmallFlatBackend: N musi wynosić co najmniej 4");
+
+   static_assert(std::is_nothrow_move_constructible<K>::value &&
+                 std::is_nothrow_move_assignable<K>::value &&
+                 std::is_nothrow_move_constructible<V>::value &&
+                 std::is_nothrow_move_assignable<V>::value,
+                 "SmallFlatBackend: K i V muszą być przenoszone no-throw");
+
+   using tree_t = PriorityQueue<K, V, Allocator>;
+
+public:
+
+   using size_type = size_t;
+   using key_type = K;
+   using value_type = V;
+   using allocator_type = Allocator;
+
+   /**
+    * Konstruktor bezparametrowy tworzący pustą kolejkę. [O(1)]
+    */
+   PriorityQueue() {}
+
+   explicit PriorityQueue(const Allocator& alloc) : tree(alloc) {}
+
+   /**
+    * Konstruktor kopiujący [O(queue.size())], przenoszący [O(N)]
+    * i operator przypisania (kopiowanie i zamiana).
+    */
+   PriorityQueue(const PriorityQueue& queue) : tree(queue.tree) {
+      try {
+         for (size_type i = 0; i < queue.counter; ++i)
+            append(queue.keys()[i], queue.values()[i]);
+      } catch (...) {
+         clear_flat();
+         throw;
+      }
+   }
+
+   PriorityQueue(PriorityQueue&& queue) noexcept
+      : tree(std::move(queue.tree)) {
+      for (size_type i = 0; i < queue.counter; ++i)
+         append(std::move(queue.keys()[i]), std::move(queue.values()[i]));
+      queue.clear_flat();
+   }
+
+   ~PriorityQueue() {
+      clear_flat();
+   }
+
+   PriorityQueue& operator=(PriorityQueue queue) {
+      queue.swap(*this);
+      return *this;
+   }
+
+   allocator_type get_allocator() const {
+      return tree.get_allocator();
+   }
+
+   bool empty() const {
+      return counter == 0 && tree.empty();
+   }
+
+   size_type size() const {
+      return counter + tree.size();
+   }
+
+   /**
+    * Metody wstawiające parę do kolejki [O(1) w tablicach, O(N log N)
+    * przy przejściu do drzewa, potem O(log size())].
+    */
+   void insert(const K& key, const V& value) {
+      if (flat_insert())
+         append(key, value);
+      else
+         tree.insert(key, value);
+   }
+
+   void insert(K&& key, V&& value) {
+      if (flat_insert())
+         append(std::move(key), std::move(value));
+      else
+         tree.insert(std::move(key), std::move(value));
+   }
+
+   template<typename KK, typename VV>
+   void emplace(KK&& key, VV&& value) {
+      if (flat_insert())
+         append(std::forward<KK>(key), std::forward<VV>(value));
+      else
+         tree.emplace(std::forward<KK>(key), std::forward<VV>(value));
+   }
+
+   /**
+    * Najmniejsza i największa wartość oraz ich klucze [O(N) w tablicach,
+    * O(1) w drzewie]; dla pustej kolejki zgłaszają wyjątek
+    * PriorityQueueEmptyException.
+    */
+   const V& minValue() const {
+      if (!flat())
+         return tree.minValue();
+      return values()[min_index()];
+   }
+
+   const V& maxValue() const {
+      if (!flat())
+         return tree.maxValue();
+      return values()[max_index()];
+   }
+
+   const K& minKey() const {
+      if (!flat())
+         return tree.minKey();
+      return keys()[min_index()];
+   }
+
+   const K& maxKey() const {
+      if (!flat())
+         return tree.maxKey();
+      return keys()[max_index()];
+   }
+
+   /**
+    * Usunięcie pary o najmniejszej lub największej wartości.
+    * [O(N) w tablicach, O(log size()) w drzewie]
+    */
+   void deleteMin() {
+      if (!flat()) {
+         tree.deleteMin();
+         shrink();
+      } else if (counter > 0) {
+         erase_at(min_index());
+      }
+   }
+
+   void deleteMax() {
+      if (!flat()) {
+         tree.deleteMax();
+         shrink();
+      } else if (counter > 0) {
+         erase_at(max_index());
+      }
+   }
+
+   /**
+    * Usunięcie i zwrócenie pary o najmniejszej lub największej wartości;
+    * wersje try zwracają std::nullopt dla pustej kolejki.
+    * [O(N) w tablicach, O(log size()) w drzewie]
+    */
+   std::pair<K, V> popMin() {
+      if (!flat()) {
+         std::pair<K, V> result = tree.popMin();
+         shrink();
+         return result;
+      }
+      return take(min_index());
+   }
+
+   std::pair<K, V> popMax() {
+      if (!flat()) {
+         std::pair<K, V> result = tree.popMax();
+         shrink();
+         return result;
+      }
+      return take(max_index());
+   }
+
+   std::optional<std::pair<K, V>> tryPopMin() {
+      if (empty())
+         return std::nullopt;
+      return popMin();
+   }
+
+   std::optional<std::pair<K, V>> tryPopMax() {
+      if (empty())
+         return std::nullopt;
+      return popMax();
+   }
+
+   /**
+    * Usunięcie (co najwyżej) n par o najmniejszych lub największych
+    * wartościach i zapisanie ich do out w kolejności usuwania; jeśli zapis
+    * zgłosi wyjątek, zapisywana para i dalsze zostają w kolejce.
+    */
+   template<typename OutputIt>
+   OutputIt extractMin(size_type n, OutputIt out) {
+      return extract_range(n, std::move(out), false);
+   }
+
+   template<typename OutputIt>
+   OutputIt extractMax(size_type n, OutputIt out) {
+      return extract_range(n, std::move(out), true);
+   }
+
+   /**
+    * Zmiana wartości pary o kluczu key (przy kilku takich parach - pary
+    * o najmniejszej wartości) na value; gdy klucza nie ma w kolejce,
+    * zgłasza wyjątek PriorityQueueNotFoundException.
+    * [O(N) w tablicach, O(log size()) w drzewie]
+    */
+   void changeValue(const K& key, const V& value) {
+      if (!flat())
+         tree.changeValue(key, value);
+      else
+         move_to_back(find_index(key), V(value));
+   }
+
+   void changeValue(const K& key, V&& value) {
+      if (!flat())
+         tree.changeValue(key, std::move(value));
+      else
+         move_to_back(find_index(key), std::move(value));
+   }
+
+   /**
+    * Czy w kolejce jest para o kluczu key i liczba takich par.
+    * [O(N) w tablicach, O(log size()) w drzewie]
+    */
+   bool contains(const K& key) const {
+      if (!flat())
+         return tree.contains(key);
+      for (size_type i = 0; i < counter; ++i)
+         if (equal_keys(keys()[i], key))
+            return true;
+      return false;
+   }
+
+   size_type count(const K& key) const {
+      if (!flat())
+         return tree.count(key);
+      size_type result = 0;
+      for (size_type i = 0; i < counter; ++i)
+         result += equal_keys(keys()[i], key);
+      return result;
+   }
+
+   /**
+    * Usunięcie pary o kluczu key (spośród kilku - tej o najmniejszej
+    * wartości, jak changeValue); zwraca false, jeśli takiej pary nie ma.
+    * Usunięcie wszystkich par o kluczu key; zwraca ich liczbę.
+    * [O(N) w tablicach, O(log size()) i O(k log size()) w drzewie]
+    */
+   bool eraseKey(const K& key) {
+      if (!flat()) {
+         bool erased = tree.eraseKey(key);
+         shrink();
+         return erased;
+      }
+      size_type i = key_index(key);
+      if (i == counter)
+         return false;
+      erase_at(i);
+      return true;
+   }
+
+   size_type eraseAll(const K& key) {
+      if (!flat()) {
+         size_type erased = tree.eraseAll(key);
+         shrink();
+         return erased;
+      }
+      // Pozostałe pary przesuwamy w miejsce usuniętych, zachowując
+      // kolejność wstawiania.
+      size_type kept = 0;
+      for (size_type i = 0; i < counter; ++i) {
+         if (equal_keys(keys()[i], key))
+            continue;
+         if (kept != i) {
+            keys()[kept] = std::move(keys()[i]);
+            values()[kept] = std::move(values()[i]);
+         }
+         ++kept;
+      }
+      size_type erased = counter - kept;
+      for (size_type i = kept; i < counter; ++i) {
+         keys()[i].~K();
+         values()[i].~V();
+      }
+      counter = kept;
+      return erased;
+   }
+
+   /**
+    * Scalenie z kolejką queue, która zostaje opróżniona. Jeśli obie są
+    * w tablicach i razem mają co najwyżej N par, pary queue są dopisywane
+    * na koniec [O(queue.size())]; w przeciwnym razie obie kolejki
+    * przechodzą do drzew, które są scalane.
+    */
+   void merge(PriorityQueue& queue) {
+      if (this == &queue)
+         return;
+      if (flat() && queue.flat() && counter + queue.counter <= N) {
+         for (size_type i = 0; i < queue.counter; ++i)
+            append(std::move(queue.keys()[i]), std::move(queue.values()[i]));
+         queue.clear_flat();
+         return;
+      }
+      to_tree();
+      queue.to_tree();
+      tree.merge(queue.tree);
+   }
+
+   /**
+    * Zamiana zawartości z kolejką queue. [O(N)]
+    */
+   void swap(PriorityQueue& queue) noexcept {
+      using std::swap;
+      tree.swap(queue.tree);
+      PriorityQueue* longer = counter >= queue.counter ? this : &queue;
+      PriorityQueue* shorter = longer == this ? &queue : this;
+      size_type common = shorter->counter;
+      for (size_type i = 0; i < common; ++i) {
+         swap(keys()[i], queue.keys()[i]);
+         swap(values()[i], queue.values()[i]);
+      }
+      for (size_type i = common; i < longer->counter; ++i) {
+         new (shorter->keys() + i) K(std::move(longer->keys()[i]));
+         new (shorter->values() + i) V(std::move(longer->values()[i]));
+         longer->keys()[i].~K();
+         longer->values()[i].~V();
+      }
+      std::swap(counter, queue.counter);
+   }
+
+   /**
+    * Porównania kolejek jak w domyślnej strategii: == to równość zbiorów
+    * par (klucz, wartość), < porządek leksykograficzny grup par o równym
+    * kluczu. Pary kolejki w tablicach są porównywane w tymczasowym
+    * porządku (klucz, wartość). [O(size()), w tablicach O(N log N)]
+    */
+   bool operator==(const PriorityQueue& queue) const {
+      if (size() != queue.size())
+         return false;
+      if (!flat() && !queue.flat())
+         return tree == queue.tree;
+      pair_refs lhs = sorted_pairs(), rhs = queue.sorted_pairs();
+      for (size_type i = 0; i < lhs.size(); ++i)
+         if (!(*lhs[i].first == *rhs[i].first) ||
+             !(*lhs[i].second == *rhs[i].second))
+            return false;
+      return true;
+   }
+
+   bool operator<(const PriorityQueue& queue) const {
+      if (!flat() && !queue.flat())
+         return tree < queue.tree;
+      // Kolejne grupy par o równym kluczu: najpierw klucze, potem liczności
+      // grup (liczniejsza jest mniejsza), a na końcu wartości.
+      pair_refs lhs = sorted_pairs(), rhs = queue.sorted_pairs();
+      size_type i = 0, j = 0;
+      while (i < lhs.size() && j < rhs.size()) {
+         const K& lhs_key = *lhs[i].first;
+         const K& rhs_key = *rhs[j].first;
+         if (!(lhs_key == rhs_key))
+            return lhs_key < rhs_key;
+         size_type lhs_end = i, rhs_end = j;
+         while (lhs_end < lhs.size() && *lhs[lhs_end].first == lhs_key)
+            ++lhs_end;
+         while (rhs_end < rhs.size() && *rhs[rhs_end].first == rhs_key)
+            ++rhs_end;
+         if (lhs_end - i != rhs_end - j)
+            return lhs_end - i > rhs_end - j;
+         for (; i < lhs_end; ++i, ++j) {
+            const V& lhs_value = *lhs[i].second;
+            const V& rhs_value = *rhs[j].second;
+            if (!(lhs_value == rhs_value))
+               return lhs_value < rhs_value;
+         }
+      }
+      return i == lhs.size() && j < rhs.size();
+   }
+
+   bool operator!=(const PriorityQueue& queue) const {
+      return !(*this == queue);
+   }
+
+   bool operator>(const PriorityQueue& queue) const {
+      return queue < *this;
+   }
+
+   bool operator<=(const PriorityQueue& queue) const {
+      return !(queue < *this);
+   }
+
+   bool operator>=(const PriorityQueue& queue) const {
+      return !(*this < queue);
+   }
+
+private:
+
+   using pair_refs = std::vector<std::pair<const K*, const V*>>;
+
+   // Pary kolejki w porządku indeksu kluczy domyślnej strategii (klucz,
+   // wartość): z drzewa w kolejności jego indeksu, z tablic po sortowaniu.
+   pair_refs sorted_pairs() const {
+      pair_refs result;
+      result.reserve(size());
+      if (!flat()) {
+         for (auto it = tree.keyBegin(); it != tree.keyEnd(); ++it)
+            result.emplace_back(&it.key(), &it.value());
+         return result;
+      }
+      for (size_type i = 0; i < counter; ++i)
+         result.emplace_back(keys() + i, values() + i);
+      std::sort(result.begin(), result.end(),
+                [](const auto& lhs, const auto& rhs) {
+                   return *lhs.first < *rhs.first ||
+                          (!(*rhs.first < *lhs.first) &&
+                           *lhs.second < *rhs.second);
+                });
+      return result;
+   }
+
+   K* keys() noexcept {
+      return reinterpret_cast<K*>(key_storage);
+   }
+
+   const K* keys() const noexcept {
+      return reinterpret_cast<const K*>(key_storage);
+   }
+
+   V* values() noexcept {
+      return reinterpret_cast<V*>(value_storage);
+   }
+
+   const V* values() const noexcept {
+      return reinterpret_cast<const V*>(value_storage);
+   }
+
+   // Kolejka jest w tablicach, gdy drzewo jest puste.
+   bool flat() const noexcept {
+      return tree.empty();
+   }
+
+   static bool equal_keys(const K& a, const K& b) {
+      return !(a < b) && !(b < a);
+   }
+
+   size_type min_index() const {
+      if (counter == 0)
+         throw PriorityQueueEmptyException();
+      return pq_detail::flat_min_index(values(), counter);
+   }
+
+   size_type max_index() const {
+      if (counter == 0)
+         throw PriorityQueueEmptyException();
+      return pq_detail::flat_max_index(values(), counter);
+   }
+
+   // Pozycja pary o kluczu key i najmniejszej wartości (przy remisie -
+   // najwcześniejszej), jak w indeksie kluczy domyślnej strategii, lub
+   // counter, gdy takiej pary nie ma.
+   size_type key_index(const K& key) const {
+      size_type found = counter;
+      for (size_type i = 0; i < counter; ++i)
+         if (equal_keys(keys()[i], key) &&
+             (found == counter || values()[i] < values()[found]))
+            found = i;
+      return found;
+   }
+
+   size_type find_index(const K& key) const {
+      size_type found = key_index(key);
+      if (found == counter)
+         throw PriorityQueueNotFoundException();
+      return found;
+   }
+
+   // Czy nowa para trafi do tablic; przy pełnych tablicach kolejka
+   // przechodzi do drzewa.
+   bool flat_insert() {
+      if (!flat())
+         return false;
+      if (counter < N)
+         return true;
+      to_tree();
+      return false;
+   }
+
+   template<typename KK, typename VV>
+   void append(KK&& key, VV&& value) {
+      new (keys() + counter) K(std::forward<KK>(key));
+      try {
+         new (values() + counter) V(std::forward<VV>(value));
+      } catch (...) {
+         keys()[counter].~K();
+         throw;
+      }
+      ++counter;
+   }
+
+   // Usunięcie pary z pozycji i z zachowaniem kolejności pozostałych.
+   void erase_at(size_type i) noexcept {
+      for (; i + 1 < counter; ++i) {
+         keys()[i] = std::move(keys()[i + 1]);
+         values()[i] = std::move(values()[i + 1]);
+      }
+      keys()[counter - 1].~K();
+      values()[counter - 1].~V();
+      --counter;
+   }
+
+   std::pair<K, V> take(size_type i) noexcept {
+      std::pair<K, V> result(std::move(keys()[i]), std::move(values()[i]));
+      erase_at(i);
+      return result;
+   }
+
+   // Przeniesienie pary z pozycji i na koniec z nową wartością - zmieniona
+   // para jest w porządku remisów najmłodsza.
+   void move_to_back(size_type i, V&& value) noexcept {
+      K key(std::move(keys()[i]));
+      erase_at(i);
+      new (keys() + counter) K(std::move(key));
+      new (values() + counter) V(std::move(value));
+      ++counter;
+   }
+
+   void clear_flat() noexcept {
+      for (size_type i = 0; i < counter; ++i) {
+         keys()[i].~K();
+         values()[i].~V();
+      }
+      counter = 0;
+   }
+
+   // Przejście do drzewa: pary są wstawiane w kolejności tablic, więc
+   // remisy zachowują porządek. Przy wyjątku kolejka zostaje w tablicach.
+   void to_tree() {
+      if (counter == 0)
+         return;
+      tree_t tmp(tree.get_allocator());
+      for (size_type i = 0; i < counter; ++i)
+         tmp.insert(keys()[i], values()[i]);
+      tree.swap(tmp);
+      clear_flat();
+   }
+
+   // Powrót do tablic, gdy w drzewie zostało co najwyżej N / 4 par; pary
+   // są wyjmowane w porządku wartości, który zachowuje porządek remisów.
+   void shrink() noexcept {
+      if (tree.size() > N / 4)
+         return;
+      while (!tree.empty()) {
+         std::pair<K, V> p = tree.popMin();
+         append(std::move(p.first), std::move(p.second));
+      }
+   }
+
+   template<typename OutputIt>
+   OutputIt extract_range(size_type n, OutputIt out, bool max) {
+      if (!flat()) {
+         out = max ? tree.extractMax(n, std::move(out))
+                   : tree.extractMin(n, std::move(out));
+         shrink();
+         return out;
+      }
+      for (; n > 0 && counter > 0; --n) {
+         size_type i = max ? max_index() : min_index();
+         *out = std::pair<K, V>(keys()[i], values()[i]);
+         ++out;
+         erase_at(i);
+      }
+      return out;
+   }
+
+   alignas(V) alignas(32) unsigned char value_storage[N * sizeof(V)];
+   alignas(K) unsigned char key_storage[N * sizeof(K)];
+   size_type counter = 0;
+   tree_t tree;
+};
+
+#endif /* __SMALLQUEUE_HH__ */
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "externalqueue.hh"
+
+namespace fs = std::filesystem;
+
+// Katalog na przebiegi, pusty na początku i na końcu testu.
+struct ScratchDirectory {
+    ScratchDirectory() : path(fs::temp_directory_path() / "test10-runs") {
+        fs::remove_all(path);
+        fs::create_directory(path);
+    }
+    ~ScratchDirectory() {
+        fs::remove_all(path);
+    }
+    bool empty() const {
+        return fs::is_empty(path);
+    }
+    fs::path path;
+};
+
+ExternalQueueOptions smallOptions(const ScratchDirectory& dir, size_t bytes) {
+    ExternalQueueOptions options;
+    options.memory_bytes = bytes;
+    options.directory = dir.path.string();
+    options.fan_in = 3;
+    return options;
+}
+
+// Losowe operacje porównywane z PriorityQueue; bufor mieści kilkadziesiąt
+// par, więc powstaje wiele przebiegów i kilka poziomów scalania.
+void testAgainstPriorityQueue() {
+    ScratchDirectory dir;
+    {
+        ExternalPriorityQueue<int, int> E(smallOptions(dir, 4096));
+        PriorityQueue<int, int> P;
+        std::mt19937 rng(5);
+        size_t max_runs = 0;
+        for (int i = 0; i < 20000; ++i) {
+            if (rng() % 3 != 0 || P.empty()) {
+                int key = static_cast<int>(rng() % 1000);
+                int value = static_cast<int>(rng() % 500);
+                E.insert(key, value);
+                P.insert(key, value);
+            } else {
+                assert(E.minValue() == P.minValue());
+                assert(E.minKey() == P.minKey());
+                if (rng() % 2) {
+                    E.deleteMin();
+                    P.deleteMin();
+                } else {
+                    auto e = E.tryPopMin();
+                    assert(e && *e == P.popMin());
+                }
+            }
+            assert(E.size() == P.size());
+            max_runs = std::max(max_runs, E.runCount());
+        }
+        assert(max_runs > 3);
+        while (!P.empty()) {
+            assert(E.minKey() == P.minKey() && E.minValue() == P.minValue());
+            E.deleteMin();
+            P.deleteMin();
+        }
+        assert(E.empty() && E.runCount() == 0 && !E.tryPopMin());
+        assert(dir.empty());
+
+        bool thrown = false;
+        try {
+            E.minValue();
+        } catch (const PriorityQueueEmptyException&) {
+            thrown = true;
+        }
+        assert(thrown);
+        E.deleteMin();
+    }
+    assert(dir.empty());
+}
+
+// Napisy o różnych długościach (rekordy dłuższe niż blok odczytu) i pliki
+// usuwane przy zniszczeniu niepustej kolejki.
+void testStrings() {
+    ScratchDirectory dir;
+    {
+        ExternalPriorityQueue<std::string, std::string> E(
+            smallOptions(dir, 16384));
+        std::vector<std::pair<std::string, std::string>> expected;
+        for (int i = 0; i < 3000; ++i) {
+            std::string value(static_cast<size_t>((i * 37) % 5000), 'a' + i % 26);
+            E.insert(std::to_string(i), value);
+            expected.emplace_back(std::to_string(i), value);
+        }
+        assert(E.runCount() > 1);
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const auto& a, const auto& b) {
+                             return a.second < b.second;
+                         });
+        for (size_t i = 0; i < 1000; ++i) {
+            auto p = E.tryPopMin();
+            assert(p && *p == expected[i]);
+        }
+        assert(!dir.empty());
+    }
+    assert(dir.empty());
+}
+
+// Odczyt bloku przebiegu kończy się błędem (plik obcięty), a po
+// przywróceniu pliku ponowione deleteMin zwraca wszystkie pary po kolei.
+void testReadFailure() {
+    ScratchDirectory dir;
+    {
+        // Jeden przebieg z kilkoma tysiącami par (wiele bloków odczytu)
+        // i ostatnia para w buforze.
+        ExternalPriorityQueue<int, int> E(smallOptions(dir, 800000));
+        int count = 0;
+        while (E.runCount() == 0) {
+            E.insert(count, count);
+            ++count;
+        }
+        assert(count > 2000);
+        fs::path run = fs::directory_iterator(dir.path)->path();
+        std::vector<char> bytes(fs::file_size(run));
+        {
+            std::ifstream file(run, std::ios::binary);
+            file.read(bytes.data(), bytes.size());
+        }
+
+        fs::resize_file(run, 0);
+        int next = 0, failures = 0;
+        for (int retry = 0; retry < 2; ++retry) {
+            try {
+                while (next < count) {
+                    assert(E.minValue() == next);
+                    auto p = E.tryPopMin();
+                    assert(p && p->second == next);
+                    ++next;
+                }
+            } catch (const PriorityQueueIOException&) {
+                ++failures;
+                assert(E.minValue() == next);
+                assert(E.size() == size_t(count - next));
+                std::ofstream file(run, std::ios::binary);
+                file.write(bytes.data(), bytes.size());
+            }
+        }
+        assert(failures == 1 && next == count && E.empty());
+    }
+    assert(dir.empty());
+}
+
+int main() {
+    testAgainstPriorityQueue();
+    testStrings();
+    testReadFailure();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
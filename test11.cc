@@ -0,0 +1,309 @@
+#include <iostream>
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "btreequeue.hh"
+#include "poolallocator.hh"
+
+template<typename K, typename V,
+          typename A = std::allocator<std::pair<const K, V>>>
+using BTreeQueue = PriorityQueue<K, V, A, BTreeBackend>;
+
+void testBasic() {
+    BTreeQueue<int, int> P;
+    assert(P.empty() && !P.tryPopMin());
+    P.deleteMin();
+    P.deleteMax();
+
+    bool thrown = false;
+    try {
+        P.maxKey();
+    } catch (const PriorityQueueEmptyException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    P.insert(1, 42);
+    P.insert(2, 13);
+    P.insert(1, 7);
+    assert(P.size() == 3);
+    assert(P.minKey() == 1 && P.minValue() == 7);
+    assert(P.maxKey() == 1 && P.maxValue() == 42);
+    assert(P.contains(2) && !P.contains(3));
+    assert(P.count(1) == 2 && P.count(3) == 0);
+
+    // changeValue zmienia parę o najmniejszej wartości spośród par klucza.
+    P.changeValue(1, 50);
+    assert(P.maxValue() == 50 && P.minValue() == 13);
+    assert(P.count(1) == 2);
+    thrown = false;
+    try {
+        P.changeValue(3, 0);
+    } catch (const PriorityQueueNotFoundException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    BTreeQueue<int, int> Q(P);
+    assert(Q == P);
+    auto p = Q.popMax();
+    assert(p.first == 1 && p.second == 50);
+    assert(Q != P && Q.size() == 2 && P.size() == 3);
+
+    P.merge(Q);
+    assert(P.size() == 5 && Q.empty());
+    P.merge(P);
+    assert(P.size() == 5);
+}
+
+// Losowe operacje porównywane z domyślną strategią; liczba par przekracza
+// kilkakrotnie pojemność węzłów, więc drzewo ma kilka poziomów.
+template<typename A>
+void testRandom(const A& alloc) {
+    std::mt19937 rng(19);
+    BTreeQueue<int, int, A> P(alloc);
+    PriorityQueue<int, int> R;
+    for (int i = 0; i < 200000; ++i) {
+        int op = rng() % 10;
+        int key = rng() % 5000;
+        int value = rng() % 1000;
+        if (op < 4) {
+            P.insert(key, value);
+            R.insert(key, value);
+        } else if (op < 6) {
+            if (R.contains(key)) {
+                P.changeValue(key, value);
+                R.changeValue(key, value);
+            }
+        } else if (op < 7) {
+            if (key % 3 == 0)
+                assert(P.eraseKey(key) == R.eraseKey(key));
+            else if (key % 3 == 1)
+                assert(P.eraseAll(key) == R.eraseAll(key));
+            assert(P.count(key) == R.count(key));
+        } else if (op < 9) {
+            if (!R.empty())
+                assert(P.popMin() == R.popMin());
+        } else if (!R.empty()) {
+            assert(P.popMax() == R.popMax());
+        }
+        assert(P.size() == R.size());
+        if (!R.empty()) {
+            assert(P.minValue() == R.minValue() && P.minKey() == R.minKey());
+            assert(P.maxValue() == R.maxValue() && P.maxKey() == R.maxKey());
+        }
+    }
+
+    BTreeQueue<int, int, A> Q(P);
+    assert(Q == P);
+    std::vector<std::pair<int, int>> out, expected;
+    P.extractMin(P.size() / 2, std::back_inserter(out));
+    R.extractMin(R.size() / 2, std::back_inserter(expected));
+    P.extractMax(P.size(), std::back_inserter(out));
+    R.extractMax(R.size(), std::back_inserter(expected));
+    assert(out == expected && P.empty());
+    assert(Q.size() == out.size());
+}
+
+// Porównania kolejek dają te same wyniki co w domyślnej strategii (małe
+// zbiory kluczy i wartości - wiele grup i remisów).
+void testCompare() {
+    std::mt19937 rng(31);
+    for (int round = 0; round < 2000; ++round) {
+        BTreeQueue<int, int> A, B;
+        PriorityQueue<int, int> RA, RB;
+        for (int i = rng() % 200; i > 0; --i) {
+            int key = rng() % 4, value = rng() % 3;
+            A.insert(key, value);
+            RA.insert(key, value);
+            if (rng() % 8) {
+                B.insert(key, value);
+                RB.insert(key, value);
+            }
+        }
+        for (int i = rng() % 3; i > 0; --i) {
+            int key = rng() % 4, value = rng() % 3;
+            B.insert(key, value);
+            RB.insert(key, value);
+        }
+        assert((A == B) == (RA == RB) && (A != B) == (RA != RB));
+        assert((A < B) == (RA < RB) && (A > B) == (RA > RB));
+        assert((A <= B) == (RA <= RB) && (A >= B) == (RA >= RB));
+        assert(!(A < A) && A <= A);
+    }
+}
+
+// Alokator zgłaszający std::bad_alloc, gdy wyczerpie się limit alokacji.
+template<typename T>
+struct LimitedAllocator {
+    using value_type = T;
+
+    static inline long budget = -1;
+
+    LimitedAllocator() = default;
+
+    template<typename U>
+    LimitedAllocator(const LimitedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (budget == 0)
+            throw std::bad_alloc();
+        if (budget > 0)
+            --budget;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const LimitedAllocator<U>&) const { return true; }
+
+    template<typename U>
+    bool operator!=(const LimitedAllocator<U>&) const { return false; }
+};
+
+// Wyjęcia różnych części kolejki (odcinanie liści z obu końców, usuwanie
+// kluczy pojedynczo i budowa indeksu kluczy od nowa), przeplatane losowymi
+// operacjami, które sprawdzają, czy drzewa pozostały poprawne.
+void testExtract() {
+    std::mt19937 rng(29);
+    BTreeQueue<int, int> P;
+    PriorityQueue<int, int> R;
+    for (int round = 0; round < 300; ++round) {
+        for (int i = rng() % 20000; i > 0; --i) {
+            int key = rng() % 5000, value = rng() % 1000;
+            P.insert(key, value);
+            R.insert(key, value);
+        }
+        size_t n = 0;
+        switch (rng() % 4) {
+        case 0: n = rng() % 10; break;
+        case 1: n = rng() % (R.size() + 1); break;
+        case 2: n = R.size() - std::min<size_t>(R.size(), rng() % 100); break;
+        default: n = R.size() + rng() % 3; break;
+        }
+        std::vector<std::pair<int, int>> out, expected;
+        if (rng() % 2) {
+            P.extractMin(n, std::back_inserter(out));
+            R.extractMin(n, std::back_inserter(expected));
+        } else {
+            P.extractMax(n, std::back_inserter(out));
+            R.extractMax(n, std::back_inserter(expected));
+        }
+        assert(out == expected && P.size() == R.size());
+        for (int i = rng() % 2000; i > 0 && !R.empty(); --i) {
+            int key = rng() % 5000;
+            switch (rng() % 4) {
+            case 0: assert(P.popMin() == R.popMin()); break;
+            case 1: assert(P.popMax() == R.popMax()); break;
+            case 2: assert(P.eraseAll(key) == R.eraseAll(key)); break;
+            default: P.insert(key, i); R.insert(key, i); break;
+            }
+            assert(P.size() == R.size());
+        }
+        BTreeQueue<int, int> Q;
+        for (auto it = R.keyBegin(); it != R.keyEnd(); ++it)
+            Q.insert(it.key(), it.value());
+        assert(P == Q);
+    }
+
+    // Zapis zgłasza wyjątek: zapisane pary znikają, pozostałe zostają.
+    struct Failing {
+        std::vector<std::pair<int, int>>* out;
+        size_t limit;
+        Failing& operator*() { return *this; }
+        Failing& operator++() { return *this; }
+        Failing& operator=(const std::pair<int, int>& p) {
+            if (out->size() == limit)
+                throw std::runtime_error("write");
+            out->push_back(p);
+            return *this;
+        }
+    };
+    for (size_t limit : {0, 1, 100, 5000, 9999}) {
+        for (bool max : {false, true}) {
+            BTreeQueue<int, int> A;
+            PriorityQueue<int, int> B;
+            for (int i = 0; i < 10000; ++i) {
+                A.insert(i % 77, i * 7919 % 10007);
+                B.insert(i % 77, i * 7919 % 10007);
+            }
+            std::vector<std::pair<int, int>> out, expected;
+            bool thrown = false;
+            try {
+                if (max)
+                    A.extractMax(10000, Failing{&out, limit});
+                else
+                    A.extractMin(10000, Failing{&out, limit});
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            assert(thrown && out.size() == limit);
+            if (max)
+                B.extractMax(limit, std::back_inserter(expected));
+            else
+                B.extractMin(limit, std::back_inserter(expected));
+            assert(out == expected && A.size() == B.size());
+            while (!B.empty())
+                assert(A.popMin() == B.popMin());
+        }
+    }
+
+    // Brak pamięci na przebudowę indeksu kluczy: pary są usuwane
+    // pojedynczo, a wynik się nie zmienia.
+    using Limited = LimitedAllocator<std::pair<const int, int>>;
+    for (long budget : {0, 1, 5}) {
+        BTreeQueue<int, int, Limited> A;
+        PriorityQueue<int, int> B;
+        for (int i = 0; i < 10000; ++i) {
+            A.insert(i % 77, i * 7919 % 10007);
+            B.insert(i % 77, i * 7919 % 10007);
+        }
+        std::vector<std::pair<int, int>> out, expected;
+        Limited::budget = budget;
+        A.extractMax(9000, std::back_inserter(out));
+        Limited::budget = -1;
+        B.extractMax(9000, std::back_inserter(expected));
+        assert(out == expected && A.size() == B.size());
+        for (int i = 0; i < 1000; ++i) {
+            A.insert(i, i);
+            B.insert(i, i);
+        }
+        while (!B.empty())
+            assert(A.popMax() == B.popMax());
+    }
+}
+
+void testLarge() {
+    // Wstawianie rosnących i malejących wartości (podziały skrajnych
+    // liści), a potem usuwanie na przemian z obu końców (scalenia).
+    BTreeQueue<long long, long long> P;
+    const long long n = 100000;
+    for (long long i = 0; i < n; ++i) {
+        P.insert(i, i);
+        P.insert(-i, -i);
+    }
+    for (long long i = n - 1; i >= 0; --i) {
+        assert(P.maxValue() == i && P.minValue() == -i);
+        P.deleteMax();
+        P.deleteMin();
+    }
+    assert(P.empty());
+}
+
+int main() {
+    testBasic();
+    testRandom(std::allocator<std::pair<const int, int>>());
+    testRandom(PoolAllocator<int>());
+    testCompare();
+    testExtract();
+    testLarge();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "smallqueue.hh"
+
+template<typename K, typename V, size_t N = 64>
+using SmallQueue = PriorityQueue<K, V, std::allocator<std::pair<const K, V>>,
+                                 SmallFlatBackend<N>>;
+
+// Przegląd wektorowy daje te same pozycje co skalarny (pierwsze minimum,
+// ostatnie maksimum), także dla długości niepodzielnych przez szerokość
+// rejestru i wielu równych wartości.
+template<typename T>
+void testScan() {
+    std::mt19937 rng(5);
+    for (size_t n = 1; n <= 70; ++n)
+        for (int round = 0; round < 50; ++round) {
+            std::vector<T> v(n);
+            for (auto& x : v)
+                x = static_cast<T>(rng() % 8) -
+                    static_cast<T>(round % 2 ? 4 : 0);
+            size_t min = 0, max = 0;
+            for (size_t i = 1; i < n; ++i) {
+                if (v[i] < v[min])
+                    min = i;
+                if (!(v[i] < v[max]))
+                    max = i;
+            }
+            assert(pq_detail::flat_min_index(v.data(), n) == min);
+            assert(pq_detail::flat_max_index(v.data(), n) == max);
+        }
+}
+
+void testBasic() {
+    SmallQueue<int, int> P;
+    assert(P.empty() && !P.tryPopMax());
+    P.deleteMin();
+
+    bool thrown = false;
+    try {
+        P.minValue();
+    } catch (const PriorityQueueEmptyException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Równe wartości: minimum to para najstarsza, maksimum - najmłodsza.
+    P.insert(1, 5);
+    P.insert(2, 5);
+    P.insert(3, 5);
+    assert(P.minKey() == 1 && P.maxKey() == 3);
+    P.changeValue(1, 5);
+    assert(P.minKey() == 2 && P.maxKey() == 1);
+    assert(P.contains(3) && !P.contains(4) && P.count(2) == 1);
+
+    thrown = false;
+    try {
+        P.changeValue(4, 0);
+    } catch (const PriorityQueueNotFoundException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    SmallQueue<int, int> Q(P);
+    for (int i = 0; i < 100; ++i)
+        Q.insert(i, i);
+    assert(Q.size() == 103 && P.size() == 3);
+    P.merge(Q);
+    assert(P.size() == 106 && Q.empty());
+    P.swap(Q);
+    assert(P.empty() && Q.size() == 106);
+    std::vector<std::pair<int, int>> out;
+    Q.extractMin(100, std::back_inserter(out));
+    assert(out.size() == 100 && out.front().second == 0);
+    assert(Q.size() == 6 && Q.maxValue() == 99);
+}
+
+// Losowe operacje porównywane z domyślną strategią, z wielokrotnym
+// przechodzeniem między tablicami a drzewem.
+template<typename V>
+void testRandom() {
+    std::mt19937 rng(23);
+    SmallQueue<int, V, 16> P;
+    PriorityQueue<int, V> R;
+    for (int i = 0; i < 100000; ++i) {
+        int op = rng() % 10;
+        int key = rng() % 40;
+        V value = static_cast<V>(rng() % 30);
+        int phase = (i / 2000) % 2;
+        if (op < 3 + 3 * phase) {
+            P.insert(key, value);
+            R.insert(key, value);
+        } else if (op < 7) {
+            if (op == 6 && key % 3 == 0) {
+                assert(P.eraseKey(key) == R.eraseKey(key));
+            } else if (op == 6 && key % 3 == 1) {
+                assert(P.eraseAll(key) == R.eraseAll(key));
+            } else if (R.contains(key)) {
+                P.changeValue(key, value);
+                R.changeValue(key, value);
+            }
+            assert(P.count(key) == R.count(key));
+        } else if (op < 9) {
+            if (!R.empty())
+                assert(P.popMin() == R.popMin());
+        } else if (!R.empty()) {
+            assert(P.popMax() == R.popMax());
+        }
+        assert(P.size() == R.size());
+        if (!R.empty()) {
+            assert(P.minValue() == R.minValue() && P.minKey() == R.minKey());
+            assert(P.maxValue() == R.maxValue() && P.maxKey() == R.maxKey());
+        }
+        if (i % 1000 == 0) {
+            SmallQueue<int, V, 16> C(P);
+            SmallQueue<int, V, 16> M(std::move(C));
+            assert(M.size() == P.size());
+            if (!P.empty())
+                assert(M.minKey() == P.minKey());
+        }
+    }
+}
+
+// Porównania kolejek dają te same wyniki co w domyślnej strategii, także
+// gdy jedna kolejka jest w tablicach, a druga w drzewie.
+void testCompare() {
+    using Small = SmallQueue<int, int, 16>;
+    std::mt19937 rng(31);
+    for (int round = 0; round < 2000; ++round) {
+        Small A, B;
+        PriorityQueue<int, int> RA, RB;
+        for (int i = rng() % 30; i > 0; --i) {
+            int key = rng() % 4, value = rng() % 3;
+            A.insert(key, value);
+            RA.insert(key, value);
+            if (rng() % 4) {
+                B.insert(key, value);
+                RB.insert(key, value);
+            }
+        }
+        for (int i = rng() % 3; i > 0; --i) {
+            int key = rng() % 4, value = rng() % 3;
+            B.insert(key, value);
+            RB.insert(key, value);
+        }
+        assert((A == B) == (RA == RB) && (A != B) == (RA != RB));
+        assert((A < B) == (RA < RB) && (A > B) == (RA > RB));
+        assert((A <= B) == (RA <= RB) && (A >= B) == (RA >= RB));
+    }
+
+    // Te same pary w drzewie (po usunięciach) i w tablicach.
+    Small T, F;
+    for (int i = 0; i < 17; ++i)
+        T.insert(i % 5, i);
+    for (int i = 0; i < 11; ++i)
+        T.deleteMax();
+    for (int i = 5; i >= 0; --i)
+        F.insert(i % 5, i);
+    assert(T == F && !(T < F) && !(F < T) && T <= F);
+    F.changeValue(0, 7);
+    assert(T != F && T < F);
+}
+
+int main() {
+    testScan<int32_t>();
+    testScan<uint32_t>();
+    testScan<float>();
+    testScan<double>();
+    testScan<long long>();
+    testBasic();
+    testRandom<int>();
+    testRandom<unsigned>();
+    testRandom<double>();
+    testRandom<long long>();
+    testCompare();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+// Para usuwana leniwie nie powiększa węzła.
+static_assert(sizeof(pq_detail::ValueHook) == sizeof(pq_detail::TreeHook),
+              "znacznik usunięcia mieści się w wyrównaniu zaczepu");
+
+void testBasic(bool lazy) {
+    PriorityQueue<int, int> P;
+    P.setLazyErase(lazy, 0.5);
+    assert(!P.eraseKey(1) && P.eraseAll(1) == 0);
+
+    P.insert(1, 10);
+    P.insert(2, 20);
+    P.insert(1, 5);
+    P.insert(3, 30);
+    P.insert(1, 40);
+
+    // eraseKey usuwa parę o najmniejszej wartości spośród par klucza.
+    assert(P.eraseKey(1));
+    assert(P.size() == 4 && P.count(1) == 2 && P.minValue() == 10);
+    assert(P.eraseAll(1) == 2);
+    assert(P.size() == 2 && !P.contains(1) && !P.eraseKey(1));
+    assert(P.minKey() == 2 && P.maxKey() == 3);
+
+    auto h = P.insert(4, 1);
+    P.erase(h);
+    assert(P.size() == 2 && P.minValue() == 20);
+
+    // Usunięcie skrajnych par odsłania żywe pary.
+    assert(P.eraseKey(3) && P.maxValue() == 20);
+    assert(P.eraseKey(2) && P.empty());
+    P.deleteMin();
+    assert(!P.tryPopMin());
+}
+
+// Losowe operacje w trybie leniwym porównywane z usuwaniem od razu.
+void testRandom(double ratio) {
+    std::mt19937 rng(29);
+    PriorityQueue<int, int, std::allocator<std::pair<const int, int>>,
+                  InstrumentedBackend> P;
+    PriorityQueue<int, int> R;
+    P.setLazyErase(true, ratio);
+    for (int i = 0; i < 100000; ++i) {
+        int op = rng() % 12;
+        int key = rng() % 300;
+        int value = rng() % 1000;
+        if (op < 4) {
+            P.insert(key, value);
+            R.insert(key, value);
+        } else if (op < 6) {
+            assert(P.eraseKey(key) == R.eraseKey(key));
+        } else if (op < 7) {
+            assert(P.eraseAll(key) == R.eraseAll(key));
+        } else if (op < 8) {
+            if (R.contains(key)) {
+                P.changeValue(key, value);
+                R.changeValue(key, value);
+            }
+            assert(P.count(key) == R.count(key));
+        } else if (op < 9) {
+            if (!R.empty())
+                assert(P.popMin() == R.popMin());
+        } else if (op < 10) {
+            if (!R.empty())
+                assert(P.popMax() == R.popMax());
+        } else if (op < 11) {
+            std::vector<std::pair<int, int>> out, expected;
+            P.extractMin(3, std::back_inserter(out));
+            R.extractMin(3, std::back_inserter(expected));
+            assert(out == expected);
+        } else if (i % 1000 == 0) {
+            std::vector<std::pair<int, int>> batch;
+            for (int j = 0; j < 2000; ++j)
+                batch.emplace_back(rng() % 300, rng() % 1000);
+            P.insertBatch(batch.begin(), batch.end());
+            R.insertBatch(batch.begin(), batch.end());
+        }
+        assert(P.size() == R.size());
+        if (i % 100 == 0) {
+            PriorityQueueStats stats = P.stats();
+            assert(stats.tombstones <= ratio * stats.nodes);
+            assert(stats.nodes == P.size() + stats.tombstones);
+        }
+        if (!R.empty()) {
+            assert(P.minValue() == R.minValue() && P.minKey() == R.minKey());
+            assert(P.maxValue() == R.maxValue() && P.maxKey() == R.maxKey());
+        }
+        if (i % 5000 == 0) {
+            auto C = P;
+            assert(C == P && C.size() == P.size());
+            assert(C.stats().tombstones == 0);
+        }
+    }
+}
+
+void testWholeQueue() {
+    std::mt19937 rng(31);
+    PriorityQueue<int, int> P, R;
+    P.setLazyErase(true, 1.0);
+    for (int i = 0; i < 1000; ++i) {
+        int key = rng() % 100;
+        int value = rng() % 100;
+        P.insert(key, value);
+        R.insert(key, value);
+    }
+    for (int key = 0; key < 100; key += 3) {
+        assert(P.eraseKey(key) == R.eraseKey(key));
+        assert(P.eraseAll(key + 1) == R.eraseAll(key + 1));
+    }
+
+    // Kopia, porównania, scalenie i migawka pomijają oznaczone pary.
+    PriorityQueue<int, int> C(P);
+    assert(C == R && P == R && !(P < R) && !(R < P));
+    PriorityQueue<int, int> M;
+    M.merge(P);
+    assert(P.empty() && M == R);
+    M.saveSnapshot("test13.snapshot");
+    PriorityQueue<int, int> L;
+    L.loadSnapshot("test13.snapshot");
+    std::remove("test13.snapshot");
+    assert(L == R);
+
+    // Wyłączenie trybu leniwego kompaktuje od razu.
+    C.setLazyErase(false);
+    assert(C == R);
+    while (!R.empty()) {
+        assert(C.popMax() == R.popMax());
+        assert(C.size() == R.size());
+    }
+    assert(C.empty());
+}
+
+int main() {
+    testBasic(false);
+    testBasic(true);
+    testRandom(0.25);
+    testRandom(1.0);
+    testRandom(0.0);
+    testWholeQueue();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
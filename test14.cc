@@ -0,0 +1,106 @@
+#include <iostream>
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+using Queue = PriorityQueue<int, int>;
+
+static_assert(std::is_same<
+                 std::iterator_traits<Queue::value_iterator>::iterator_category,
+                 std::bidirectional_iterator_tag>::value,
+              "iterator dwukierunkowy");
+
+void testBasic() {
+    Queue P;
+    assert(P.begin() == P.end() && P.keyBegin() == P.keyEnd());
+    assert(P.keys().empty() && P.valueRange(0, 10).empty());
+
+    P.insert(3, 30);
+    P.insert(1, 20);
+    P.insert(2, 20);
+    P.insert(1, 10);
+
+    // Porządek wartości: remisy w kolejności wstawiania.
+    std::vector<std::pair<int, int>> values(P.begin(), P.end());
+    assert((values == std::vector<std::pair<int, int>>{
+        {1, 10}, {1, 20}, {2, 20}, {3, 30}}));
+    assert(P.begin()->first == P.minKey());
+    assert(std::prev(P.end()).value() == P.maxValue());
+
+    // Porządek kluczy.
+    std::vector<std::pair<int, int>> keys;
+    for (auto [key, value] : P.keys())
+        keys.emplace_back(key, value);
+    assert((keys == std::vector<std::pair<int, int>>{
+        {1, 10}, {1, 20}, {2, 20}, {3, 30}}));
+
+    // Referencje wskazują pary w węzłach.
+    auto it = P.begin();
+    assert(&(*it).second == &P.minValue());
+    assert(P.value(it.handle()) == 10 && P.key(it.handle()) == 1);
+
+    auto range = P.valueRange(15, 30);
+    assert(std::distance(range.begin(), range.end()) == 2);
+    assert(range.begin()->second == 20);
+    assert(P.valueRange(20, 20).empty() && P.valueRange(30, 10).empty());
+    assert(P.valueRange(31, 100).empty());
+    assert(std::distance(P.valueRange(0, 100).begin(),
+                         P.valueRange(0, 100).end()) == 4);
+
+    // Przejście wstecz, także od end().
+    std::vector<int> reversed;
+    for (auto i = P.end(); i != P.begin();)
+        reversed.push_back((--i).value());
+    assert((reversed == std::vector<int>{30, 20, 20, 10}));
+    auto k = P.keyEnd();
+    --k;
+    assert(k.key() == 3 && (k--)->first == 3 && k->first == 2);
+}
+
+// Zakresy porównywane z przejściem po kopii kolejki, także z parami
+// usuniętymi leniwie.
+void testRandom(bool lazy) {
+    std::mt19937 rng(37);
+    Queue P;
+    P.setLazyErase(lazy);
+    for (int i = 0; i < 20000; ++i) {
+        int key = rng() % 500;
+        if (rng() % 3 == 0)
+            P.eraseKey(key);
+        else
+            P.insert(key, rng() % 1000);
+
+        if (i % 500 != 0)
+            continue;
+        Queue C(P);
+        std::vector<std::pair<int, int>> expected, actual(P.begin(), P.end());
+        while (!C.empty())
+            expected.push_back(C.popMin());
+        assert(actual == expected);
+        assert(std::distance(P.keyBegin(), P.keyEnd()) ==
+               static_cast<std::ptrdiff_t>(P.size()));
+
+        int lo = rng() % 1000, hi = rng() % 1000;
+        size_t count = 0;
+        for (auto [key, value] : P.valueRange(lo, hi)) {
+            assert(lo <= value && value < hi);
+            ++count;
+        }
+        size_t inside = 0;
+        for (auto& p : expected)
+            inside += lo <= p.second && p.second < hi;
+        assert(count == inside);
+    }
+}
+
+int main() {
+    testBasic();
+    testRandom(false);
+    testRandom(true);
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
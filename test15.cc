@@ -0,0 +1,158 @@
+#include <iostream>
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+template<typename K, typename V>
+using RankedQueue = PriorityQueue<K, V, std::allocator<std::pair<const K, V>>,
+                                  OrderStatisticBackend>;
+
+// Wartość bez no-throw przypisania przenoszącego - changeValue zastępuje
+// wtedy węzeł nowym, zamiast zmieniać go w miejscu.
+struct Priority {
+    int x;
+
+    Priority(int x = 0) : x(x) {}
+    Priority(const Priority&) = default;
+    Priority& operator=(const Priority& p) { x = p.x; return *this; }
+
+    bool operator<(const Priority& p) const { return x < p.x; }
+    bool operator==(const Priority& p) const { return x == p.x; }
+};
+
+static_assert(sizeof(pq_detail::TreeHook) == 4 * sizeof(void*),
+              "licznik poddrzewa nie powiększa zaczepu");
+
+void testBasic() {
+    RankedQueue<int, int> P;
+    assert(P.nth(0) == P.end() && P.rankOf(5) == 0);
+    assert(P.countInRange(0, 10) == 0);
+
+    bool thrown = false;
+    try {
+        P.median();
+    } catch (const PriorityQueueEmptyException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    for (int v : {50, 10, 30, 30, 30, 20, 40})
+        P.insert(v, v);
+    // Porządek wartości: 10 20 30 30 30 40 50.
+    assert(P.kthValue(0) == 10 && P.kthValue(2) == 30 &&
+           P.kthValue(4) == 30 && P.kthValue(6) == 50);
+    assert(P.median() == 30);
+    assert(P.rankOf(30) == 2 && P.rankOf(31) == 5 && P.rankOf(0) == 0 &&
+           P.rankOf(100) == 7);
+    assert(P.countInRange(20, 40) == 4 && P.countInRange(30, 30) == 0 &&
+           P.countInRange(40, 20) == 0);
+    assert(P.nth(5).value() == 40 && std::next(P.nth(5)) == P.nth(6));
+
+    thrown = false;
+    try {
+        P.kthValue(7);
+    } catch (const PriorityQueueNotFoundException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    P.insert(0, 60);
+    assert(P.median() == 30 && P.kthValue(7) == 60);
+    P.deleteMin();
+    P.deleteMin();
+    assert(P.median() == 30 && P.kthValue(0) == 30);
+}
+
+// Statystyki porównywane z przejściem po parach po każdej rodzinie operacji.
+template<typename V>
+void check(const RankedQueue<int, V>& P, std::mt19937& rng) {
+    std::vector<V> values;
+    for (auto it = P.begin(); it != P.end(); ++it)
+        values.push_back(it.value());
+    assert(values.size() == P.size());
+    for (size_t k = 0; k < values.size(); ++k)
+        assert(P.kthValue(k) == values[k]);
+    if (!values.empty())
+        assert(P.median() == values[(values.size() - 1) / 2]);
+    for (int i = 0; i < 10; ++i) {
+        V lo = V(rng() % 120), hi = V(rng() % 120);
+        size_t below = 0, inside = 0;
+        for (const V& v : values) {
+            below += v < lo;
+            inside += !(v < lo) && v < hi;
+        }
+        assert(P.rankOf(lo) == below);
+        assert(P.countInRange(lo, hi) == inside);
+    }
+}
+
+template<typename V>
+void testRandom(bool lazy) {
+    std::mt19937 rng(41);
+    RankedQueue<int, V> P;
+    P.setLazyErase(lazy);
+    for (int i = 0; i < 20000; ++i) {
+        int op = rng() % 10;
+        int key = rng() % 200;
+        V value = V(rng() % 100);
+        if (op < 4) {
+            P.insert(key, value);
+        } else if (op < 6) {
+            if (P.contains(key))
+                P.changeValue(key, value);
+        } else if (op < 7) {
+            P.eraseKey(key);
+        } else if (op < 8) {
+            P.eraseAll(key);
+        } else if (op < 9) {
+            P.deleteMin();
+        } else if (i % 2 == 0) {
+            P.deleteMax();
+        } else {
+            std::vector<std::pair<int, V>> batch;
+            for (int j = 0; j < 20; ++j)
+                batch.emplace_back(rng() % 200, V(rng() % 100));
+            P.insertBatch(batch.begin(), batch.end());
+        }
+        if (i % 200 == 0)
+            check(P, rng);
+    }
+
+    // Kopia, scalenie, duża paczka i migawka budują indeksy od nowa.
+    RankedQueue<int, V> C(P), M;
+    check(C, rng);
+    M.insert(1000, V(50));
+    M.merge(C);
+    check(M, rng);
+    std::vector<std::pair<int, V>> batch;
+    for (int j = 0; j < 5000; ++j)
+        batch.emplace_back(rng() % 200, V(rng() % 100));
+    M.insertBatch(batch.begin(), batch.end());
+    check(M, rng);
+    std::vector<std::pair<int, V>> out;
+    M.extractMax(100, std::back_inserter(out));
+    check(M, rng);
+    if constexpr (std::is_same<V, int>::value) {
+        M.saveSnapshot("test15.snapshot");
+        RankedQueue<int, V> L;
+        L.loadSnapshot("test15.snapshot");
+        std::remove("test15.snapshot");
+        check(L, rng);
+    }
+}
+
+int main() {
+    testBasic();
+    testRandom<int>(false);
+    testRandom<int>(true);
+    testRandom<Priority>(false);
+    testRandom<Priority>(true);
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
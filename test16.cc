@@ -0,0 +1,164 @@
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "deadlinequeue.hh"
+
+using Queue = DeadlineQueue<int>;
+
+void testBasic() {
+    Queue Q(100);
+    assert(Q.empty() && Q.now() == 100);
+    assert(Q.advanceTo(1000, [](int, uint64_t) { assert(false); }) == 0);
+    assert(Q.now() == 1000);
+
+    std::vector<int> fired;
+    auto record = [&](int key, uint64_t deadline) {
+        assert(deadline <= Q.now());
+        fired.push_back(key);
+    };
+    auto a = Q.insert(1, 1500);
+    Q.insert(2, 1200);
+    auto c = Q.insert(3, 70000);
+    Q.insert(4, uint64_t(1) << 40); // poza horyzontem koła
+    Q.insert(5, 10); // termin minął
+    assert(Q.size() == 5 && Q.key(a) == 1 && Q.deadline(c) == 70000);
+
+    assert(Q.advanceTo(1000, record) == 1);
+    assert((fired == std::vector<int>{5}));
+
+    Q.cancel(a);
+    Q.reschedule(c, 1300);
+    assert(Q.deadline(c) == 1300);
+    assert(Q.advanceTo(5000, record) == 2);
+    assert((fired == std::vector<int>{5, 2, 3}));
+
+    // Czas nie cofa się.
+    Q.advanceTo(10, record);
+    assert(Q.now() == 5000 && Q.size() == 1);
+
+    assert(Q.advanceTo(uint64_t(1) << 41, record) == 1);
+    assert(fired.back() == 4 && Q.empty());
+}
+
+// Funkcja zwrotna wstawia i anuluje zegary.
+void testReentrant() {
+    Queue Q;
+    std::vector<int> fired;
+    Queue::handle_type victim = Q.insert(100, 50);
+    Q.insert(1, 10);
+    Q.advanceTo(100, [&](int key, uint64_t deadline) {
+        fired.push_back(key);
+        if (key == 1) {
+            Q.cancel(victim);
+            Q.insert(2, deadline); // ten sam termin
+            Q.insert(3, 20);
+            Q.insert(4, 1000);
+        }
+    });
+    assert((fired == std::vector<int>{1, 2, 3}) && Q.size() == 1);
+
+    // Wyjątek z funkcji zwrotnej zostawia pozostałe zegary.
+    for (int key = 10; key < 15; ++key)
+        Q.insert(key, 500);
+    size_t before = 0;
+    bool thrown = false;
+    try {
+        Q.advanceTo(2000, [&](int key, uint64_t) {
+            if (key == 12)
+                throw std::string("stop");
+            ++before;
+        });
+    } catch (const std::string&) {
+        thrown = true;
+    }
+    assert(thrown && Q.now() == 500 && Q.size() == 5 - before);
+    size_t rest = Q.advanceTo(2000, [](int key, uint64_t) {
+        assert(key != 12);
+    });
+    assert(Q.empty() && before + 1 + rest == 6);
+}
+
+// Losowe operacje porównywane z modelem (zbiór par termin, klucz).
+void testRandom(uint64_t start, unsigned span_bits) {
+    std::mt19937_64 rng(43);
+    Queue Q(start);
+    std::vector<Queue::handle_type> handles;
+    std::vector<uint64_t> deadlines;
+    std::vector<int> alive;
+    std::vector<size_t> position;
+    std::set<std::pair<uint64_t, int>> model;
+
+    auto random_deadline = [&]() {
+        unsigned bits = rng() % (span_bits + 1);
+        uint64_t delta = bits ? rng() % (uint64_t(1) << bits) : 0;
+        // Część terminów już minęła.
+        return rng() % 20 == 0 ? Q.now() - std::min(Q.now(), delta)
+                               : Q.now() + delta;
+    };
+    auto remove = [&](int key) {
+        model.erase({deadlines[key], key});
+        position[alive.back()] = position[key];
+        alive[position[key]] = alive.back();
+        alive.pop_back();
+    };
+
+    for (int i = 0; i < 200000; ++i) {
+        int op = rng() % 10;
+        if (op < 5) {
+            int key = handles.size();
+            uint64_t deadline = random_deadline();
+            handles.push_back(Q.insert(key, deadline));
+            deadlines.push_back(deadline);
+            position.push_back(alive.size());
+            alive.push_back(key);
+            model.insert({deadline, key});
+        } else if (op < 7 && !alive.empty()) {
+            int key = alive[rng() % alive.size()];
+            if (op == 5) {
+                Q.cancel(handles[key]);
+                remove(key);
+            } else {
+                model.erase({deadlines[key], key});
+                deadlines[key] = random_deadline();
+                model.insert({deadlines[key], key});
+                Q.reschedule(handles[key], deadlines[key]);
+                assert(Q.deadline(handles[key]) == deadlines[key]);
+            }
+        } else if (op >= 7) {
+            unsigned bits = rng() % 2 ? span_bits / 2 : span_bits;
+            uint64_t target = Q.now() + rng() % (uint64_t(1) << bits);
+            uint64_t before = Q.now(), last = 0;
+            size_t count = 0;
+            size_t fired = Q.advanceTo(target, [&](int key, uint64_t d) {
+                assert(model.count({d, key}) && d == deadlines[key]);
+                // Kolejność terminów (zaległe terminy w chwili startu).
+                uint64_t at = std::max(d, before);
+                assert(at >= last && Q.now() == at && at <= target);
+                last = at;
+                remove(key);
+                ++count;
+            });
+            assert(fired == count && Q.now() == target);
+            assert(model.empty() || model.begin()->first > target);
+        }
+        assert(Q.size() == model.size());
+    }
+}
+
+int main() {
+    testBasic();
+    testReentrant();
+    testRandom(0, 12);
+    testRandom(12345, 24);
+    testRandom(uint64_t(1) << 32, 40);
+    testRandom(~uint64_t(0) - (uint64_t(1) << 62), 44);
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
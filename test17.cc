@@ -0,0 +1,146 @@
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "priorityexecutor.hh"
+
+using Executor = PriorityExecutor<int>;
+
+// Zadanie blokujące jedyny wątek roboczy, dopóki test nie zleci reszty.
+struct Gate {
+    std::atomic<bool> open{false};
+
+    void block(Executor& E) {
+        std::atomic<bool> started{false};
+        E.submit(-1000, [this, &started] {
+            started = true;
+            while (!open)
+                std::this_thread::yield();
+        });
+        while (!started)
+            std::this_thread::yield();
+    }
+};
+
+void testOrder() {
+    Executor E(1);
+    assert(E.threadCount() == 1 && E.pending() == 0);
+    Gate gate;
+    gate.block(E);
+
+    std::vector<int> order;
+    std::vector<Executor::task_handle> handles;
+    for (int i : {5, 3, 8, 3, 1, 9})
+        handles.push_back(E.submit(i, [&order, i] { order.push_back(i); }));
+    auto late = E.submit(7, [&order] { order.push_back(0); });
+    assert(E.reprioritize(late, 2));
+    assert(E.reprioritize(handles[5], 4));
+    assert(E.pending() == 8);
+
+    gate.open = true;
+    E.wait();
+    assert((order == std::vector<int>{1, 0, 3, 3, 9, 5, 8}));
+    assert(E.pending() == 0 && !E.reprioritize(late, 0));
+}
+
+// Zadania zlecające kolejne zadania; destruktor czeka na wszystkie.
+void testNested() {
+    std::atomic<int> count{0};
+    std::function<void(int)> spawn;
+    {
+        Executor E(4);
+        spawn = [&](int depth) {
+            ++count;
+            if (depth == 0)
+                return;
+            for (int i = 0; i < 4; ++i)
+                E.submit(depth, [&spawn, depth] { spawn(depth - 1); });
+        };
+        E.submit(0, [&spawn] { spawn(6); });
+    }
+    assert(count == (1 << 14) / 3); // 1 + 4 + ... + 4^6
+}
+
+// Zadania zlecone z jednego wątku roboczego rozchodzą się między wątki.
+void testStealing() {
+    Executor E(4);
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+    std::atomic<int> done{0};
+    E.submit(0, [&] {
+        for (int i = 0; i < 2000; ++i)
+            E.submit(i % 10, [&] {
+                auto end = std::chrono::steady_clock::now() +
+                           std::chrono::microseconds(20);
+                while (std::chrono::steady_clock::now() < end) {}
+                std::lock_guard<std::mutex> guard(lock);
+                threads.insert(std::this_thread::get_id());
+                ++done;
+            });
+    });
+    E.wait();
+    assert(done == 2000 && threads.size() > 1);
+}
+
+// Przeniesienie zadania między kolejkami nie gubi zmiany priorytetu.
+void testConcurrentReprioritize() {
+    Executor E(4);
+    std::atomic<int> done{0};
+    std::vector<Executor::task_handle> handles;
+    for (int i = 0; i < 20000; ++i)
+        handles.push_back(E.submit(i, [&done] { ++done; }));
+    int changed = 0;
+    for (size_t i = handles.size(); i-- > 0;)
+        changed += E.reprioritize(handles[i], -int(i));
+    E.wait();
+    assert(done == 20000 && changed <= 20000);
+}
+
+#ifdef PRIORITYEXECUTOR_COROUTINES
+// Korutyna bez wyniku, uruchamiana od razu.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached step(Executor& E, int priority, std::vector<int>& order) {
+    co_await E.schedule(priority);
+    order.push_back(priority);
+}
+
+void testCoroutines() {
+    Executor E(1);
+    Gate gate;
+    gate.block(E);
+    std::vector<int> order;
+    for (int i : {4, 2, 6, 1})
+        step(E, i, order);
+    gate.open = true;
+    E.wait();
+    assert((order == std::vector<int>{1, 2, 4, 6}));
+}
+#endif
+
+int main() {
+    testOrder();
+    testNested();
+    testStealing();
+    testConcurrentReprioritize();
+#ifdef PRIORITYEXECUTOR_COROUTINES
+    testCoroutines();
+#endif
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
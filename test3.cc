@@ -39,6 +39,13 @@ struct ThrowingInt {
     value = new int(*other.value);
   }
 
+  ThrowingInt(ThrowingInt&& other) {
+    //std::cerr << "Move constructor" << std::endl;
+    check_throw();
+    value = other.value;
+    other.value = nullptr;
+  }
+
   const ThrowingInt& operator=(const ThrowingInt& other) {
     //std::cerr << "Copy assignment" << std::endl;
     check_throw();
@@ -46,6 +53,13 @@ struct ThrowingInt {
     return *this;
   }
 
+  const ThrowingInt& operator=(ThrowingInt&& other) {
+    //std::cerr << "Move assignment" << std::endl;
+    check_throw();
+    std::swap(value, other.value);
+    return *this;
+  }
+
   ~ThrowingInt() {
     delete value;
   }
@@ -284,6 +298,89 @@ bool run_test() {
   DO_OP(assert(P == C), C, expected);
   DO_OP(assert(D.size() == 0), D, VP());
 
+  /// Ścieżki przenoszące: insert(K&&, V&&), emplace, changeValue(K, V&&).
+  PQ E;
+  expected.clear();
+  {
+    ThrowingInt key(1), val(10);
+    DO_OP(E.insert(std::move(key), std::move(val)), E, expected);
+  }
+
+  expected = VP{{1,10}};
+  DO_OP(E.insert(ThrowingInt(2), ThrowingInt(20)), E, expected);
+
+  expected = VP{{1,10}, {2,20}};
+  DO_OP(E.emplace(3, 5), E, expected);
+
+  expected = VP{{3,5}, {1,10}, {2,20}};
+  DO_OP(E.emplace(std::piecewise_construct, std::forward_as_tuple(4),
+                  std::forward_as_tuple(15)), E, expected);
+
+  expected = VP{{3,5}, {1,10}, {4,15}, {2,20}};
+  DO_OP(assert(E.minKey() == 3), E, expected);
+  {
+    ThrowingInt val(30);
+    DO_OP(E.changeValue(ThrowingInt(3), std::move(val)), E, expected);
+  }
+
+  expected = VP{{1,10}, {4,15}, {2,20}, {3,30}};
+  DO_OP(assert(E.maxKey() == 3), E, expected);
+  DO_OP(E.changeValue(ThrowingInt(1), ThrowingInt(40)), E, expected);
+
+  expected = VP{{4,15}, {2,20}, {3,30}, {1,40}};
+  DO_OP(assert(E.minKey() == 4), E, expected);
+  DO_OP(assert(E.maxKey() == 1), E, expected);
+
+  /// popMin, popMax, tryPopMin.
+  DO_OP(assert(E.popMin().first == 4), E, expected);
+
+  expected = VP{{2,20}, {3,30}, {1,40}};
+  DO_OP(assert(E.popMax().second == 40), E, expected);
+
+  expected = VP{{2,20}, {3,30}};
+  DO_OP(assert(E.tryPopMin()->second == 20), E, expected);
+
+  expected = VP{{3,30}};
+  DO_OP(assert(E.tryPopMax()->first == 3), E, expected);
+  DO_OP(assert(!E.tryPopMin()), E, VP());
+
+  /// insertBatch, extractMin, extractMax.
+  std::vector<std::pair<ThrowingInt, ThrowingInt>> batch;
+  for (int i = 0; i < 8; ++i)
+    batch.emplace_back(10 + i, (i * 3) % 8 * 10 + 10);
+  DO_OP(E.insertBatch(batch.begin(), batch.end()), E, VP());
+
+  expected = VP{{10,10}, {13,20}, {16,30}, {11,40}, {14,50}, {17,60},
+                {12,70}, {15,80}};
+  batch.clear();
+  batch.emplace_back(18, 35);
+  DO_OP(E.insertBatch(batch.begin(), batch.end()), E, expected);
+
+  expected = VP{{10,10}, {13,20}, {16,30}, {18,35}, {11,40}, {14,50},
+                {17,60}, {12,70}, {15,80}};
+  VP after1(expected.begin() + 1, expected.end());
+  VP after2(expected.begin() + 2, expected.end());
+  std::vector<std::pair<ThrowingInt, ThrowingInt>> out;
+  DO_OP(E.extractMin(3, std::back_inserter(out)), E, expected, after1, after2);
+  assert(out.size() == 3);
+  assert(out[0].first == 10 && out[1].first == 13 && out[2].second == 30);
+
+  expected = VP{{18,35}, {11,40}, {14,50}, {17,60}, {12,70}, {15,80}};
+  out.clear();
+  DO_OP(E.extractMax(1, std::back_inserter(out)), E, expected);
+  assert(out.size() == 1 && out[0].first == 15);
+
+  // Większość kolejki: indeks kluczy budowany od nowa.
+  expected.pop_back();
+  VP rest1(expected.begin() + 1, expected.end());
+  VP rest2(expected.begin() + 2, expected.end());
+  VP rest3(expected.begin() + 3, expected.end());
+  out.clear();
+  DO_OP(E.extractMin(4, std::back_inserter(out)), E, expected, rest1, rest2,
+        rest3);
+  assert(out.size() == 4 && out[3].first == 17);
+  assert(E.size() == 1 && E.minKey() == 12);
+
   return false;
 }
 
@@ -0,0 +1,554 @@
+#include <iostream>
+#include <cstdio>
+#include <cassert>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <memory>
+#include <random>
+
+#include "priorityqueue.hh"
+#include "poolallocator.hh"
+
+struct NoThrowMove {
+    NoThrowMove(int v = 0) : v(v) {}
+    NoThrowMove(const NoThrowMove& other) : v(other.v) {}
+    NoThrowMove& operator=(const NoThrowMove& other) { v = other.v; return *this; }
+    bool operator<(const NoThrowMove& other) const { return v < other.v; }
+    bool operator==(const NoThrowMove& other) const { return v == other.v; }
+    int v;
+};
+
+// Klucz zliczający utworzone obiekty, porównywalny z std::string_view.
+struct Name {
+    static int created;
+    Name(const char* s) : s(s) { ++created; }
+    Name(const Name& other) : s(other.s) { ++created; }
+    std::string s;
+};
+
+int Name::created = 0;
+
+bool operator<(const Name& a, const Name& b) { return a.s < b.s; }
+bool operator<(const Name& a, std::string_view b) { return a.s < b; }
+bool operator<(std::string_view a, const Name& b) { return a < b.s; }
+
+void testHandles() {
+    PriorityQueue<int, int> P;
+    auto h1 = P.insert(1, 10);
+    auto h2 = P.insert(2, 20);
+    auto h3 = P.insert(3, 30);
+    assert(P.key(h2) == 2);
+    assert(P.value(h2) == 20);
+
+    // int ma no-throw przypisanie, więc uchwyt się nie zmienia.
+    assert(P.update(h3, 5) == h3);
+    assert(P.minKey() == 3);
+    assert(P.minValue() == 5);
+    assert(P.value(h3) == 5);
+
+    P.update(h1, 40);
+    assert(P.maxKey() == 1);
+    assert(P.maxValue() == 40);
+
+    P.erase(h2);
+    assert(P.size() == 2);
+    P.deleteMin();
+    assert(P.minKey() == 1);
+    assert(P.value(h1) == 40);
+
+    // Uchwyty przechodzą razem z węzłami przy swap.
+    PriorityQueue<int, int> Q;
+    Q.swap(P);
+    assert(Q.value(h1) == 40);
+    Q.erase(h1);
+    assert(Q.empty());
+
+    // Dla typu bez no-throw przypisania para jest zastępowana nową.
+    PriorityQueue<int, NoThrowMove> R;
+    auto h = R.insert(7, NoThrowMove(3));
+    h = R.update(h, NoThrowMove(1));
+    assert(R.value(h).v == 1);
+    assert(R.size() == 1);
+}
+
+void testUpdateOrder() {
+    PriorityQueue<int, int> P;
+    std::vector<PriorityQueue<int, int>::handle_type> handles;
+    for (int i = 0; i < 100; ++i)
+        handles.push_back(P.insert(i, (i * 37) % 100));
+    for (int i = 0; i < 100; ++i)
+        P.update(handles[i], 100 - i);
+    for (int i = 99; i >= 0; --i) {
+        assert(P.minKey() == i);
+        assert(P.minValue() == 100 - i);
+        P.deleteMin();
+    }
+    assert(P.empty());
+}
+
+void testPoolAllocator() {
+    using PQ = PriorityQueue<int, int, PoolAllocator<std::pair<const int, int>>>;
+    PoolAllocator<std::pair<const int, int>> pool;
+    PQ P(pool);
+    for (int i = 0; i < 1000; ++i)
+        P.insert(i % 17, i);
+    assert(P.get_allocator() == pool);
+
+    PQ Q(P);
+    assert(Q == P);
+    for (int i = 0; i < 500; ++i)
+        P.deleteMin();
+    // Zwolnione węzły wracają na listę wolnych i są używane ponownie.
+    for (int i = 0; i < 500; ++i)
+        P.insert(i % 17, i);
+    assert(P == Q);
+
+    PQ R;
+    R.insert(1, -1);
+    P.merge(R);
+    assert(R.empty());
+    assert(P.minValue() == -1);
+    P.swap(R);
+    assert(P.empty());
+    assert(R.size() == 1001);
+}
+
+void testBulkLoad() {
+    // Duże, nieposortowane dane (sortowanie równoległe) dają ten sam wynik
+    // co wstawianie po kolei.
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 100000; ++i)
+        pairs.emplace_back((i * 7919LL) % 1013, (i * 104729LL) % 100003);
+    PriorityQueue<int, int> P(pairs.begin(), pairs.end());
+    PriorityQueue<int, int> Q;
+    for (auto& p : pairs)
+        Q.insert(p.first, p.second);
+    assert(P == Q);
+    assert(P.size() == pairs.size());
+    while (!Q.empty()) {
+        assert(P.minKey() == Q.minKey());
+        assert(P.minValue() == Q.minValue());
+        P.deleteMin();
+        Q.deleteMin();
+    }
+    assert(P.empty());
+
+    // Dane już posortowane, przenoszone z zakresu.
+    std::vector<std::pair<std::string, int>> sorted;
+    for (int i = 0; i < 100; ++i)
+        sorted.emplace_back(std::string(40, 'a' + i % 26) + std::to_string(i), i);
+    std::sort(sorted.begin(), sorted.end());
+    PriorityQueue<std::string, int> S;
+    S.insert("x", -1);
+    S.assign(std::make_move_iterator(sorted.begin()),
+             std::make_move_iterator(sorted.end()));
+    assert(S.size() == 100);
+    assert(S.minValue() == 0);
+    assert(S.maxValue() == 99);
+    assert(S.maxKey() == std::string(40, 'a' + 99 % 26) + "99");
+}
+
+struct CompareBomb {
+    static int countdown;
+    CompareBomb(int v = 0) : v(v) {}
+    bool operator<(const CompareBomb& other) const {
+        if (countdown > 0 && --countdown == 0)
+            throw std::runtime_error("compare");
+        return v < other.v;
+    }
+    bool operator==(const CompareBomb& other) const { return v == other.v; }
+    int v;
+};
+
+int CompareBomb::countdown = 0;
+
+void testMerge() {
+    // Przepinanie węzłów zachowuje uchwyty.
+    PriorityQueue<int, int> P, Q;
+    for (int i = 0; i < 50; ++i)
+        P.insert(i, i);
+    auto h = Q.insert(100, -5);
+    P.merge(Q);
+    assert(Q.empty());
+    assert(P.size() == 51);
+    assert(P.minKey() == 100);
+    assert(P.value(h) == -5);
+    P.erase(h);
+    assert(P.minValue() == 0);
+
+    // Wyjątek z porównania w trakcie merge przywraca obie kolejki; przy
+    // porównaniach no-throw merge nie przygotowuje wycofania.
+    static_assert(pq_detail::is_nothrow_less<int>::value, "");
+    static_assert(!pq_detail::is_nothrow_less<CompareBomb>::value, "");
+    for (int bomb = 1; bomb < 200; ++bomb) {
+        PriorityQueue<int, CompareBomb> A, B;
+        for (int i = 0; i < 10; ++i) {
+            A.insert(i, CompareBomb(i * 3));
+            B.insert(i, CompareBomb(i * 5 % 7));
+        }
+        PriorityQueue<int, CompareBomb> A0(A), B0(B);
+        CompareBomb::countdown = bomb;
+        try {
+            A.merge(B);
+            CompareBomb::countdown = 0;
+            assert(A.size() == 20);
+            assert(B.empty());
+        } catch (std::runtime_error&) {
+            CompareBomb::countdown = 0;
+            assert(A == A0);
+            assert(B == B0);
+            assert(A.minValue() == A0.minValue());
+            assert(B.maxValue() == B0.maxValue());
+        }
+    }
+
+    // Różne pule - merge przez kopie.
+    using PQ = PriorityQueue<int, int, PoolAllocator<int>>;
+    PQ C, D;
+    C.insert(1, 1);
+    D.insert(2, 2);
+    C.merge(D);
+    assert(C.size() == 2);
+    assert(D.empty());
+}
+
+void testPop() {
+    PriorityQueue<std::string, std::unique_ptr<int>> P;
+    P.insert("b", std::unique_ptr<int>(new int(2)));
+    P.emplace("a", new int(1));
+    // unique_ptr porównuje adresy - sprawdzamy tylko zawartość.
+    auto lo = P.minValue().get() < P.maxValue().get() ? "b" : "a";
+    auto hi = P.minValue().get() < P.maxValue().get() ? "a" : "b";
+    auto first = P.popMin();
+    assert(first.first == lo);
+    assert(*first.second == (first.first == "a" ? 1 : 2));
+    auto second = P.tryPopMax();
+    assert(second && second->first == hi);
+    assert(P.empty());
+    assert(!P.tryPopMin());
+    assert(!P.tryPopMax());
+    try {
+        P.popMax();
+        assert(!"popMax on empty queue did not throw!");
+    } catch (PriorityQueueEmptyException&) {
+    }
+}
+
+void testBatch() {
+    // Paczki różnej wielkości dają ten sam wynik co wstawianie po kolei,
+    // a uchwyty pozostają ważne po przebudowie indeksów.
+    PriorityQueue<int, int> P, Q;
+    auto h = P.insert(-1, 500);
+    Q.insert(-1, 500);
+    for (int size : {1, 3, 1000, 2, 50000, 7}) {
+        std::vector<std::pair<int, int>> batch;
+        for (int i = 0; i < size; ++i)
+            batch.emplace_back((i * 7919LL) % 1013, (i * 104729LL) % 1009);
+        P.insertBatch(batch.begin(), batch.end());
+        for (auto& p : batch)
+            Q.insert(p.first, p.second);
+        assert(P == Q);
+    }
+    assert(P.key(h) == -1 && P.value(h) == 500);
+
+    // Wyjmowanie po n par w porządku kolejnych popMin i popMax.
+    for (size_t n : {1, 5, 10000, 3, 20000}) {
+        std::vector<std::pair<int, int>> out;
+        P.extractMin(n, std::back_inserter(out));
+        assert(out.size() == n);
+        for (auto& p : out)
+            assert(p == Q.popMin());
+        out.clear();
+        P.extractMax(n, std::back_inserter(out));
+        for (auto& p : out)
+            assert(p == Q.popMax());
+        assert(P == Q);
+    }
+    std::vector<std::pair<int, int>> rest(P.size());
+    auto end = P.extractMin(rest.size() + 10, rest.begin());
+    assert(end == rest.end() && P.empty());
+    for (auto& p : rest)
+        assert(p == Q.popMin());
+
+    // Losowe n, także obejmujące większość kolejki (przebudowa indeksu
+    // kluczy), z parami usuniętymi leniwie między wyjmowanymi.
+    std::mt19937 rng(13);
+    for (bool lazy : {false, true}) {
+        PriorityQueue<int, int> A, B;
+        A.setLazyErase(lazy);
+        for (int round = 0; round < 300; ++round) {
+            for (int i = rng() % 300; i > 0; --i) {
+                int key = rng() % 100, value = rng() % 100;
+                A.insert(key, value);
+                B.insert(key, value);
+            }
+            for (int i = rng() % 30; i > 0; --i) {
+                int key = rng() % 100;
+                assert(A.eraseKey(key) == B.eraseKey(key));
+            }
+            size_t n = rng() % (A.size() + 2);
+            std::vector<std::pair<int, int>> out;
+            if (rng() % 2) {
+                A.extractMin(n, std::back_inserter(out));
+                for (auto& p : out)
+                    assert(p == B.popMin());
+            } else {
+                A.extractMax(n, std::back_inserter(out));
+                for (auto& p : out)
+                    assert(p == B.popMax());
+            }
+            assert(out.size() == std::min(n, out.size() + B.size()));
+            assert(A == B && A.size() == B.size());
+        }
+    }
+}
+
+// Iterator wyjściowy przyjmujący pary kolejki: przenosi klucz, zanim
+// zgłosi wyjątek przy zapisie numer fail_write, albo zgłasza wyjątek przy
+// przesunięciu numer fail_step (zapisana para już jest w out).
+struct FailingOut {
+    std::vector<std::pair<std::string, int>>* out;
+    size_t fail_write, fail_step;
+    size_t steps = 0;
+    FailingOut& operator*() { return *this; }
+    FailingOut& operator=(std::pair<std::string, int>&& p) {
+        std::string key = std::move(p.first);
+        if (out->size() == fail_write)
+            throw std::runtime_error("write");
+        out->emplace_back(std::move(key), p.second);
+        return *this;
+    }
+    FailingOut& operator++() {
+        if (steps++ == fail_step)
+            throw std::runtime_error("step");
+        return *this;
+    }
+};
+
+void testExtractFailure() {
+    // Po wyjątku zapisane pary zniknęły z kolejki, a pozostałe mają
+    // nienaruszone klucze - zarówno przy wyjmowaniu po kolei, jak i przy
+    // przebudowie indeksu kluczy.
+    const size_t none = size_t(-1);
+    for (size_t n : {10, 900}) {
+        for (bool max : {false, true}) {
+            for (bool step : {false, true}) {
+                PriorityQueue<std::string, int> A, B;
+                for (int i = 0; i < 1000; ++i) {
+                    std::string key = "key number " + std::to_string(i % 97);
+                    A.insert(key, (i * 7919) % 1009);
+                    B.insert(key, (i * 7919) % 1009);
+                }
+                std::vector<std::pair<std::string, int>> out;
+                FailingOut it{&out, step ? none : n / 2, step ? n / 2 : none};
+                bool thrown = false;
+                try {
+                    if (max)
+                        A.extractMax(n, it);
+                    else
+                        A.extractMin(n, it);
+                } catch (const std::runtime_error&) {
+                    thrown = true;
+                }
+                assert(thrown && out.size() == n / 2 + step);
+                for (auto& p : out)
+                    assert(p == (max ? B.popMax() : B.popMin()));
+                assert(A == B && A.size() == B.size());
+            }
+        }
+    }
+}
+
+void testLookup() {
+    PriorityQueue<std::string, int> P;
+    P.insert("b", 2);
+    P.insert("a", 1);
+    P.insert("b", 3);
+    assert(P.contains("a") && P.contains(std::string_view("b")));
+    assert(!P.contains(std::string("c")) && !P.contains(std::string_view("")));
+    assert(P.count("b") == 2 && P.count(std::string_view("a")) == 1);
+    assert(P.count("c") == 0);
+
+    auto h = P.find(std::string_view("b"));
+    assert(h != decltype(h)() && P.value(h) == 2);
+    assert(P.find("c") == decltype(h)());
+
+    P.changeValue(std::string_view("a"), 7);
+    assert(P.minKey() == "b" && P.maxKey() == "a");
+    bool thrown = false;
+    try {
+        P.changeValue(std::string_view("z"), 0);
+    } catch (const PriorityQueueNotFoundException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Wyszukiwanie przez std::string_view nie tworzy obiektów klucza.
+    PriorityQueue<Name, int> Q;
+    Q.insert("x", 1);
+    Q.insert("y", 2);
+    int created = Name::created;
+    assert(Q.contains(std::string_view("x")));
+    assert(Q.count(std::string_view("y")) == 1);
+    Q.changeValue(std::string_view("y"), 0);
+    assert(Q.minValue() == 0 && Q.minKey().s == "y");
+    assert(Name::created == created);
+}
+
+void testStats() {
+    using Instrumented = PriorityQueue<int, int, std::allocator<std::pair<const int, int>>,
+                                       InstrumentedBackend>;
+    // Wyłączone liczniki nie zwiększają rozmiaru kolejki.
+    static_assert(sizeof(PriorityQueue<int, int>) + sizeof(PriorityQueueStats) ==
+                  sizeof(Instrumented), "liczniki w kolejce bez strategii");
+
+    Instrumented P;
+    PriorityQueueStats s = P.stats();
+    assert(s.comparisons == 0 && s.allocations == 0 && s.nodes == 0);
+
+    for (int i = 0; i < 100; ++i)
+        P.insert(i % 40, i);
+    s = P.stats();
+    assert(s.insertions == 100 && s.allocations == 100 && s.nodes == 100);
+    assert(s.duplicate_keys == 60);
+    assert(s.comparisons > 100 && s.comparisons < 100 * 2 * 3 * 8);
+    assert(s.memory_bytes > sizeof(P) + 100 * 2 * sizeof(int));
+
+    P.changeValue(5, -1);
+    P.deleteMin();
+    P.deleteMax();
+    assert(P.popMin().first == 0);
+    Instrumented Q;
+    Q.insert(1000, 1000);
+    P.merge(Q);
+    s = P.stats();
+    assert(s.value_changes == 1 && s.deletions == 3 && s.merges == 1);
+    assert(s.nodes == 98 && s.insertions == 100);
+    assert(s.deallocations == 3);
+
+    // Kopia liczy od zera (poza alokacjami własnych węzłów).
+    Instrumented R(P);
+    assert(R == P);
+    s = R.stats();
+    assert(s.insertions == 0 && s.allocations == 98 && s.nodes == 98);
+
+    // insertBatch liczy wstawione pary oraz porównania przy sortowaniu
+    // paczki, scalaniu i wstawianiu do indeksów.
+    Instrumented B;
+    std::vector<std::pair<int, int>> batch;
+    for (int i = 0; i < 1000; ++i)
+        batch.emplace_back((i * 7919) % 1000, (i * 104729) % 997);
+    B.insertBatch(batch.begin(), batch.end());
+    s = B.stats();
+    assert(s.insertions == 1000 && s.nodes == 1000);
+    assert(s.comparisons > 2 * 1000);
+    size_t compared = s.comparisons;
+    B.insertBatch(batch.begin(), batch.begin() + 10);
+    s = B.stats();
+    assert(s.insertions == 1010 && s.comparisons > compared + 2 * 10);
+}
+
+// Serializator wartości zapisujący int jako tekst - przykład własnej klasy.
+struct DecimalSerializer {
+    static void write(std::vector<char>& out, int v) {
+        std::string s = std::to_string(v);
+        out.insert(out.end(), s.begin(), s.end());
+        out.push_back(';');
+    }
+    static int read(const char*& p, const char* end) {
+        const char* stop = std::find(p, end, ';');
+        if (stop == end)
+            throw PriorityQueueSnapshotException();
+        int v = std::stoi(std::string(p, stop));
+        p = stop + 1;
+        return v;
+    }
+};
+
+void testSnapshot() {
+    const char* path = "test5.snapshot";
+    PriorityQueue<int, int> P, R;
+    for (int i = 0; i < 10000; ++i)
+        P.insert(i % 700, (i * 7919) % 1000);
+    P.saveSnapshot(path);
+    R.insert(1, 1);
+    R.loadSnapshot(path);
+    assert(R == P);
+    // Równe wartości zachowują kolejność.
+    while (!P.empty()) {
+        assert(P.minKey() == R.minKey() && P.minValue() == R.minValue());
+        P.deleteMin();
+        R.deleteMin();
+    }
+    P.saveSnapshot(path);
+    R.insert(2, 2);
+    R.loadSnapshot(path);
+    assert(R.empty());
+
+    // Napisy (format z serializatorami) i własny serializator wartości.
+    PriorityQueue<std::string, int> S, T;
+    S.insert("jeden", 1);
+    S.insert(std::string(100, 'x'), 3);
+    S.insert("", 1);
+    S.saveSnapshot(path);
+    T.loadSnapshot(path);
+    assert(S == T);
+    S.saveSnapshot<SnapshotSerializer<std::string>, DecimalSerializer>(path);
+    T = PriorityQueue<std::string, int>();
+    T.loadSnapshot<SnapshotSerializer<std::string>, DecimalSerializer>(path);
+    assert(S == T);
+
+    // Plik innego formatu albo uszkodzony: wyjątek, kolejka bez zmian.
+    bool thrown = false;
+    try {
+        R.loadSnapshot(path);
+    } catch (const PriorityQueueSnapshotException&) {
+        thrown = true;
+    }
+    assert(thrown && R.empty());
+
+    for (int i = 0; i < 100; ++i)
+        P.insert(i, i);
+    P.saveSnapshot(path);
+    std::FILE* file = std::fopen(path, "r+b");
+    std::fseek(file, 100, SEEK_SET);
+    std::fputc(0x55, file);
+    std::fclose(file);
+    R.insert(5, 5);
+    thrown = false;
+    try {
+        R.loadSnapshot(path);
+    } catch (const PriorityQueueSnapshotException&) {
+        thrown = true;
+    }
+    assert(thrown && R.size() == 1 && R.minKey() == 5);
+
+    std::remove(path);
+    thrown = false;
+    try {
+        R.loadSnapshot(path);
+    } catch (const PriorityQueueSnapshotException&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    testHandles();
+    testUpdateOrder();
+    testPoolAllocator();
+    testBulkLoad();
+    testMerge();
+    testPop();
+    testBatch();
+    testExtractFailure();
+    testLookup();
+    testStats();
+    testSnapshot();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <cassert>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "intervalheap.hh"
+
+template<typename V>
+using HeapQueue = PriorityQueue<int, V, std::allocator<std::pair<const int, V>>,
+                                IntervalHeapBackend>;
+
+void testRandom() {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 100; ++round) {
+        HeapQueue<int> P;
+        std::multiset<int> ref;
+        for (int i = 0; i < 2000; ++i) {
+            int op = rng() % 5;
+            if (op < 2 || ref.empty()) {
+                int v = rng() % 100;
+                P.insert(v + 1000, v);
+                ref.insert(v);
+            } else if (op == 2) {
+                assert(P.minValue() == *ref.begin());
+                assert(P.minKey() == P.minValue() + 1000);
+                P.deleteMin();
+                ref.erase(ref.begin());
+            } else if (op == 3) {
+                assert(P.maxValue() == *ref.rbegin());
+                auto p = P.popMax();
+                assert(p.second == *ref.rbegin());
+                assert(p.first == p.second + 1000);
+                ref.erase(std::prev(ref.end()));
+            } else {
+                HeapQueue<int> Q;
+                int v = rng() % 100;
+                Q.insert(v + 1000, v);
+                ref.insert(v);
+                P.merge(Q);
+                assert(Q.empty());
+            }
+            assert(P.size() == ref.size());
+        }
+        while (auto p = P.tryPopMin()) {
+            assert(p->second == *ref.begin());
+            ref.erase(ref.begin());
+        }
+        assert(ref.empty());
+    }
+}
+
+struct CompareBomb {
+    static int countdown;
+    CompareBomb(int v = 0) : v(v) {}
+    bool operator<(const CompareBomb& other) const {
+        if (countdown > 0 && --countdown == 0)
+            throw std::runtime_error("compare");
+        return v < other.v;
+    }
+    int v;
+};
+
+int CompareBomb::countdown = 0;
+
+// Zawartość kolejki jako posortowany ciąg wartości (kolejka jest kopiowana).
+std::multiset<int> contents(HeapQueue<CompareBomb> P) {
+    std::multiset<int> result;
+    while (!P.empty()) {
+        result.insert(P.minValue().v);
+        P.deleteMin();
+    }
+    return result;
+}
+
+void testStrongGuarantee() {
+    for (int op = 0; op < 5; ++op) {
+        for (int bomb = 1; bomb < 40; ++bomb) {
+            HeapQueue<CompareBomb> P;
+            for (int i = 0; i < 40; ++i)
+                P.insert(i, CompareBomb(i * 17 % 41));
+            HeapQueue<CompareBomb> Q;
+            for (int i = 0; i < 5; ++i)
+                Q.insert(i, CompareBomb(i * 13 % 50));
+            auto before = contents(P), other = contents(Q);
+            int min = P.minValue().v, max = P.maxValue().v;
+            CompareBomb::countdown = bomb;
+            try {
+                switch (op) {
+                    case 0: P.insert(99, CompareBomb(20)); break;
+                    case 1: P.deleteMin(); break;
+                    case 2: P.deleteMax(); break;
+                    case 3: P.popMin(); break;
+                    case 4: P.merge(Q); break;
+                }
+                CompareBomb::countdown = 0;
+                assert(P.size() == (op == 0 ? 41u : op == 4 ? 45u : 39u));
+            } catch (std::runtime_error&) {
+                CompareBomb::countdown = 0;
+                assert(contents(P) == before);
+                assert(P.minValue().v == min);
+                assert(P.maxValue().v == max);
+                assert(contents(Q) == other);
+            }
+        }
+    }
+}
+
+// Przy porównaniach bez wyjątków merge przenosi pary zamiast je kopiować,
+// więc działa też dla wartości, których nie da się skopiować.
+struct MoveOnly {
+    std::unique_ptr<int> v;
+    bool operator<(const MoveOnly& other) const noexcept {
+        return *v < *other.v;
+    }
+};
+
+void testMergeMoves() {
+    std::mt19937 rng(11);
+    PriorityQueue<int, MoveOnly,
+                  std::allocator<std::pair<const int, MoveOnly>>,
+                  IntervalHeapBackend> P, Q;
+    std::multiset<int> ref;
+    for (int round = 0; round < 50; ++round) {
+        for (int i = rng() % 40; i > 0; --i) {
+            int v = rng() % 1000;
+            Q.emplace(v, MoveOnly{std::make_unique<int>(v)});
+            ref.insert(v);
+        }
+        P.merge(Q);
+        assert(Q.empty() && P.size() == ref.size());
+        for (int i = rng() % 10; i > 0 && !ref.empty(); --i) {
+            assert(*P.minValue().v == *ref.begin());
+            assert(*P.maxValue().v == *ref.rbegin());
+            auto p = P.popMax();
+            assert(p.first == *ref.rbegin() && *p.second.v == p.first);
+            ref.erase(std::prev(ref.end()));
+        }
+    }
+    while (!ref.empty()) {
+        assert(*P.popMin().second.v == *ref.begin());
+        ref.erase(ref.begin());
+    }
+}
+
+void testEmpty() {
+    HeapQueue<std::string> P;
+    try {
+        P.minValue();
+        assert(!"minValue() on empty queue did not throw!");
+    } catch (PriorityQueueEmptyException&) {
+    }
+    P.deleteMin();
+    P.deleteMax();
+    assert(!P.tryPopMax());
+    P.emplace(1, "a");
+    P.insert(2, std::string("b"));
+    assert(P.maxKey() == 2);
+    HeapQueue<std::string> Q(P);
+    Q = std::move(P);
+    assert(P.empty());
+    assert(Q.size() == 2);
+}
+
+int main() {
+    testRandom();
+    testStrongGuarantee();
+    testMergeMoves();
+    testEmpty();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "radixheap.hh"
+#include "poolallocator.hh"
+
+template<typename V>
+using RadixQueue = PriorityQueue<int, V, std::allocator<std::pair<const int, V>>,
+                                 RadixHeapBackend>;
+
+// Dijkstra na losowym grafie: wynik porównywany z wersją na std::set.
+void testDijkstra() {
+    std::mt19937 rng(11);
+    const int n = 2000;
+    std::vector<std::vector<std::pair<int, uint32_t>>> graph(n);
+    for (int i = 0; i < 10 * n; ++i)
+        graph[rng() % n].emplace_back(rng() % n, rng() % 1000);
+
+    const uint32_t inf = UINT32_MAX;
+    std::vector<uint32_t> expected(n, inf);
+    std::set<std::pair<uint32_t, int>> S;
+    expected[0] = 0;
+    S.insert({0, 0});
+    while (!S.empty()) {
+        auto p = *S.begin();
+        S.erase(S.begin());
+        for (auto& e : graph[p.second])
+            if (p.first + e.second < expected[e.first]) {
+                S.erase({expected[e.first], e.first});
+                expected[e.first] = p.first + e.second;
+                S.insert({expected[e.first], e.first});
+            }
+    }
+
+    std::vector<uint32_t> dist(n, inf);
+    RadixQueue<uint32_t> P;
+    dist[0] = 0;
+    P.insert(0, 0);
+    uint32_t previous = 0;
+    while (!P.empty()) {
+        int u = P.minKey();
+        uint32_t d = P.minValue();
+        assert(d >= previous);
+        previous = d;
+        P.deleteMin();
+        for (auto& e : graph[u])
+            if (d + e.second < dist[e.first]) {
+                if (dist[e.first] == inf)
+                    P.insert(e.first, d + e.second);
+                else
+                    P.changeValue(e.first, d + e.second);
+                dist[e.first] = d + e.second;
+            }
+    }
+    assert(dist == expected);
+}
+
+void testMonotonicity() {
+    RadixQueue<int> P;
+    P.insert(1, -5);
+    P.insert(2, 10);
+    P.insert(3, 3);
+    assert(P.minValue() == -5);
+
+    // Wartości mniejsze od zgłoszonego minimum są odrzucane.
+    bool thrown = false;
+    try {
+        P.insert(4, -6);
+    } catch (const PriorityQueueMonotonicityException&) {
+        thrown = true;
+    }
+    assert(thrown && P.size() == 3);
+
+    P.deleteMin();
+    assert(P.minKey() == 3);
+    thrown = false;
+    try {
+        P.changeValue(2, 2);
+    } catch (const PriorityQueueMonotonicityException&) {
+        thrown = true;
+    }
+    assert(thrown && P.size() == 2);
+
+    // Zmiana na wartość nie mniejszą od minimum jest dozwolona.
+    P.changeValue(2, 3);
+    P.changeValue(3, 7);
+    assert(P.minKey() == 2 && P.minValue() == 3);
+
+    thrown = false;
+    try {
+        P.changeValue(5, 100);
+    } catch (const PriorityQueueNotFoundException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    RadixQueue<int> Q(P);
+    P.deleteMin();
+    assert(Q.size() == 2 && Q.minValue() == 3);
+    P.swap(Q);
+    assert(P.size() == 2 && Q.size() == 1 && Q.minValue() == 7);
+    P.deleteMin();
+    P.deleteMin();
+    assert(P.empty());
+
+    thrown = false;
+    try {
+        P.minValue();
+    } catch (const PriorityQueueEmptyException&) {
+        thrown = true;
+    }
+    assert(thrown);
+    P.deleteMin();
+}
+
+// Losowe operacje monotoniczne na pełnym zakresie uint64_t.
+void testRandom() {
+    std::mt19937_64 rng(5);
+    PriorityQueue<int, uint64_t, PoolAllocator<int>, RadixHeapBackend> P;
+    std::multiset<uint64_t> ref;
+    std::map<int, uint64_t> values;
+    uint64_t floor = 0;
+    int next_key = 0;
+    for (int i = 0; i < 50000; ++i) {
+        int op = rng() % 4;
+        uint64_t v = floor + (rng() >> (rng() % 64));
+        if (v < floor)
+            v = floor;
+        if (op < 2 || values.empty()) {
+            P.emplace(next_key, v);
+            values[next_key++] = v;
+            ref.insert(v);
+        } else if (op == 2) {
+            assert(P.minValue() == *ref.begin());
+            floor = P.minValue();
+            values.erase(P.minKey());
+            P.deleteMin();
+            ref.erase(ref.begin());
+        } else {
+            auto it = values.lower_bound(rng() % next_key);
+            if (it == values.end())
+                it = values.begin();
+            ref.erase(ref.find(it->second));
+            ref.insert(v);
+            it->second = v;
+            P.changeValue(it->first, v);
+        }
+        assert(P.size() == ref.size());
+    }
+}
+
+int main() {
+    testDijkstra();
+    testMonotonicity();
+    testRandom();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
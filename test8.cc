@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "multiqueue.hh"
+#include "poolallocator.hh"
+
+void testSequential() {
+    MultiQueue<int, int> Q(4);
+    assert(Q.shardCount() == 8);
+    assert(Q.empty());
+    assert(!Q.tryPopMin());
+
+    const int n = 10000;
+    for (int i = 0; i < n; ++i)
+        Q.insert(i, n - 1 - i);
+    assert(Q.size() == n);
+
+    // Porządek jest zrelaksowany, ale wyjmowane są minima shardów, więc
+    // początek ciągu składa się z małych wartości.
+    std::vector<bool> seen(n, false);
+    long long rank_sum = 0;
+    for (int i = 0; i < n; ++i) {
+        auto p = Q.tryPopMin();
+        assert(p && p->first == n - 1 - p->second);
+        assert(!seen[p->second]);
+        seen[p->second] = true;
+        if (i < 100)
+            rank_sum += p->second;
+    }
+    assert(rank_sum / 100 < n / 10);
+    assert(Q.empty() && !Q.tryPopMin());
+    Q.deleteMin();
+}
+
+void testConcurrent() {
+    const int threads = 8;
+    const int per_thread = 20000;
+    MultiQueue<int, int, PoolAllocator<int>> Q(threads);
+    std::vector<std::atomic<int>> popped(threads * per_thread);
+    for (auto& c : popped)
+        c = 0;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                int v = t * per_thread + i;
+                Q.insert(v, v);
+                if (i % 2 == 1)
+                    if (auto p = Q.tryPopMin())
+                        ++popped[p->second];
+            }
+        });
+    for (auto& w : workers)
+        w.join();
+
+    while (auto p = Q.tryPopMin())
+        ++popped[p->second];
+    for (auto& c : popped)
+        assert(c == 1);
+    assert(Q.empty());
+}
+
+int main() {
+    testSequential();
+    testConcurrent();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "skiplistqueue.hh"
+
+using SkipQueue = PriorityQueue<int, int, std::allocator<std::pair<const int, int>>,
+                                LockFreeSkipListBackend>;
+
+void testSequential() {
+    SkipQueue P;
+    assert(P.empty() && !P.tryPopMin());
+    P.deleteMin();
+
+    bool thrown = false;
+    try {
+        P.minValue();
+    } catch (const PriorityQueueEmptyException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    const int n = 5000;
+    for (int i = 0; i < n; ++i)
+        P.insert(i, (i * 7919) % n);
+    assert(P.size() == n);
+    assert(P.minValue() == 0 && P.minKey() == 0);
+
+    // Zmiana wartości: klucz 1 (wartość 7919 % n) staje się minimum.
+    P.changeValue(1, -1);
+    assert(P.size() == n);
+    assert(P.minKey() == 1 && P.minValue() == -1);
+    thrown = false;
+    try {
+        P.changeValue(n, 0);
+    } catch (const PriorityQueueNotFoundException&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    auto p = P.popMin();
+    assert(p.first == 1 && p.second == -1);
+    int previous = -1;
+    while (auto q = P.tryPopMin()) {
+        assert(q->second >= previous);
+        assert(q->second == (q->first * 7919) % n);
+        previous = q->second;
+    }
+    assert(P.empty());
+
+    // Równe wartości w kolejności wstawiania.
+    for (int i = 0; i < 100; ++i)
+        P.insert(i, 5);
+    for (int i = 0; i < 100; ++i)
+        assert(P.popMin().first == i);
+}
+
+// Wstawienia współbieżne, potem współbieżne usuwanie: każdy konsument
+// musi widzieć niemalejące wartości (linearyzowalność deleteMin).
+void testConcurrent() {
+    const int threads = 8;
+    const int per_thread = 20000;
+    SkipQueue P;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                int v = i * threads + t;
+                P.insert(v, v);
+            }
+        });
+    for (auto& w : workers)
+        w.join();
+    workers.clear();
+    assert(P.size() == threads * per_thread);
+
+    std::vector<std::atomic<int>> popped(threads * per_thread);
+    for (auto& c : popped)
+        c = 0;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&] {
+            int previous = -1;
+            while (auto p = P.tryPopMin()) {
+                assert(p->first == p->second);
+                assert(p->second > previous);
+                previous = p->second;
+                ++popped[p->second];
+            }
+        });
+    for (auto& w : workers)
+        w.join();
+    for (auto& c : popped)
+        assert(c == 1);
+    assert(P.empty());
+}
+
+// Wstawienia, usunięcia i zmiany wartości jednocześnie.
+void testMixed() {
+    const int threads = 8;
+    const int per_thread = 2000;
+    SkipQueue P;
+    std::vector<std::atomic<int>> popped(threads * per_thread);
+    for (auto& c : popped)
+        c = 0;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                int key = t * per_thread + i;
+                P.insert(key, key % 1000);
+                if (i % 3 == 0) {
+                    try {
+                        P.changeValue(key, key % 1000 + 1);
+                    } catch (const PriorityQueueNotFoundException&) {
+                        // Para została już usunięta przez inny wątek.
+                    }
+                }
+                if (i % 2 == 1)
+                    if (auto p = P.tryPopMin())
+                        ++popped[p->first];
+            }
+        });
+    for (auto& w : workers)
+        w.join();
+    while (auto p = P.tryPopMin())
+        ++popped[p->first];
+    for (auto& c : popped)
+        assert(c == 1);
+    assert(P.empty());
+}
+
+int main() {
+    testSequential();
+    testConcurrent();
+    testMixed();
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}